@@ -145,6 +145,8 @@ local flexCallIns = {
   'UnitDecloaked',
   'UnitMoveFailed',
   'UnitHarvestStorageFull',
+  'UnitMovedBatch',
+  'UnitDamagedBatch',
   'RecvLuaMsg',
   'StockpileChanged',
   'DrawGenesis',
@@ -2022,6 +2024,20 @@ function widgetHandler:UnitHarvestStorageFull(unitID, unitDefID, unitTeam)
   return
 end
 
+function widgetHandler:UnitMovedBatch(unitIDs)
+  for _,w in ipairs(self.UnitMovedBatchList) do
+    w:UnitMovedBatch(unitIDs)
+  end
+  return
+end
+
+function widgetHandler:UnitDamagedBatch(unitIDs, unitDefIDs, unitTeams, damages, paralyzers, weaponDefIDs, projectileIDs)
+  for _,w in ipairs(self.UnitDamagedBatchList) do
+    w:UnitDamagedBatch(unitIDs, unitDefIDs, unitTeams, damages, paralyzers, weaponDefIDs, projectileIDs)
+  end
+  return
+end
+
 
 function widgetHandler:RecvLuaMsg(msg, playerID)
   local retval = false
@@ -77,6 +77,8 @@ CALLIN_LIST = {
 	"UnitLeftWater",
 	"UnitCommand",
 	"UnitHarvestStorageFull",
+	"UnitMovedBatch",
+	"UnitDamagedBatch",
 
 	-- weapon callins
 	"StockpileChanged",
@@ -91,6 +93,7 @@ CALLIN_LIST = {
 	-- projectile callins
 	"ProjectileCreated",
 	"ProjectileDestroyed",
+	"ProjectileCreatedBatch",
 
 	-- shield callins
 	"ShieldPreDamaged",
@@ -1638,6 +1638,31 @@ function gadgetHandler:UnitHarvestStorageFull(unitID, unitDefID, unitTeam)
   end
 end
 
+function gadgetHandler:UnitMovedBatch(unitIDs)
+  for _,g in r_ipairs(self.UnitMovedBatchList) do
+    g:UnitMovedBatch(unitIDs)
+  end
+end
+
+function gadgetHandler:UnitDamagedBatch(
+  unitIDs,
+  unitDefIDs,
+  unitTeams,
+  damages,
+  paralyzers,
+  weaponDefIDs,
+  projectileIDs,
+  attackerIDs,
+  attackerDefIDs,
+  attackerTeams
+)
+  for _,g in r_ipairs(self.UnitDamagedBatchList) do
+    g:UnitDamagedBatch(unitIDs, unitDefIDs, unitTeams,
+                       damages, paralyzers, weaponDefIDs, projectileIDs,
+                       attackerIDs, attackerDefIDs, attackerTeams)
+  end
+end
+
 --------------------------------------------------------------------------------
 --
 --  Feature call-ins
@@ -1721,6 +1746,12 @@ function gadgetHandler:ProjectileDestroyed(proID)
   end
 end
 
+function gadgetHandler:ProjectileCreatedBatch(proIDs, proOwnerIDs, proWeaponDefIDs)
+  for _,g in r_ipairs(self.ProjectileCreatedBatchList) do
+    g:ProjectileCreatedBatch(proIDs, proOwnerIDs, proWeaponDefIDs)
+  end
+end
+
 
 --------------------------------------------------------------------------------
 --
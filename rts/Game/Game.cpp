@@ -12,6 +12,7 @@
 #include "GameSetup.h"
 #include "GlobalUnsynced.h"
 #include "LoadScreen.h"
+#include "ReplayBatch.h"
 #include "SelectedUnitsHandler.h"
 #include "WaitCommandsAI.h"
 #include "WordCompletion.h"
@@ -53,6 +54,7 @@
 #include "Lua/LuaRules.h"
 #include "Lua/LuaOpenGL.h"
 #include "Lua/LuaParser.h"
+#include "Lua/LuaProfiler.h"
 #include "Lua/LuaSyncedRead.h"
 #include "Lua/LuaUI.h"
 #include "Map/MapDamage.h"
@@ -110,8 +112,11 @@
 #include "System/SafeUtil.h"
 #include "System/SpringExitCode.h"
 #include "System/SpringMath.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Misc.h"
@@ -120,6 +125,7 @@
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/DumpState.h"
 #include "System/TimeProfiler.h"
+#include "System/TimeUtil.h"
 
 
 #undef CreateDirectory
@@ -137,10 +143,25 @@ CONFIG(int, ShowPlayerInfo).defaultValue(1).headlessValue(0);
 CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0f).description("Sets the opacity of the built-in Spring UI. Generally has no effect on LuaUI widgets. Can be set in-game using shift+, to decrease and shift+. to increase.");
 CONFIG(std::string, InputTextGeo).defaultValue("");
 
+CONFIG(int, ProfileCaptureStartFrame).defaultValue(-1).minimumValue(-1).description("First sim-frame of a capture of all profiler timers (on every thread) written to a Chrome trace-file in the write-dir; -1 disables capturing. See also /profilecapture.");
+CONFIG(int, DemoKeyFrameInterval).defaultValue(0).minimumValue(0).description("Seconds of game-time between snapshots of the game-state saved into recorded demos, which let /skip jump ahead during playback without simulating every frame. Snapshots can be large; 0 disables them.");
+CONFIG(int, ProfileCaptureNumFrames).defaultValue(GAME_SPEED * 10).minimumValue(1).description("Number of sim-frames captured, see ProfileCaptureStartFrame.");
+
 
 CGame* game = nullptr;
 
 
+// idle time (in milliseconds) left over by simulation and rendering
+// within a period of the given length, based on their running averages
+static float GetFrameIdleTime(float periodTime, float simFrameRate)
+{
+	const float drawFrameRate = 1000.0f / std::max(gu->avgFrameTime, 1.0f);
+	const float frameLoad = (gu->avgSimFrameTime * simFrameRate + gu->avgDrawFrameTime * drawFrameRate) * 0.001f;
+
+	return (periodTime * Clamp(1.0f - frameLoad, 0.0f, 1.0f));
+}
+
+
 CR_BIND(CGame, (std::string(""), std::string(""), nullptr))
 
 CR_REG_METADATA(CGame, (
@@ -199,6 +220,7 @@ CR_REG_METADATA(CGame, (
 
 	CR_MEMBER(speedControl),
 	CR_MEMBER(luaGCControl),
+	CR_IGNORED(demoKeyFrameInterval),
 
 	CR_IGNORED(jobDispatcher),
 	CR_IGNORED(curKeyChain),
@@ -241,6 +263,7 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 	showSpeed = configHandler->GetBool("ShowSpeed");
 
 	speedControl = configHandler->GetInt("SpeedControl");
+	demoKeyFrameInterval = configHandler->GetInt("DemoKeyFrameInterval") * GAME_SPEED;
 
 	playerRoster.SetSortTypeByCode((PlayerRoster::SortType)configHandler->GetInt("ShowPlayerInfo"));
 
@@ -249,6 +272,13 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 	ParseInputTextGeometry("default");
 	ParseInputTextGeometry(configHandler->GetString("InputTextGeo"));
 
+	if (configHandler->GetInt("ProfileCaptureStartFrame") >= 0) {
+		const int captureFrame = configHandler->GetInt("ProfileCaptureStartFrame");
+		const int captureCount = configHandler->GetInt("ProfileCaptureNumFrames");
+
+		profiler.SetCaptureRange(captureFrame, captureFrame + captureCount - 1, dataDirsAccess.LocateFile("profile_" + CTimeUtil::GetCurrentTimeStr() + ".json", FileQueryFlags::WRITE));
+	}
+
 	// clear left-over receivers in case we reloaded
 	gameCommandConsole.ResetState();
 
@@ -316,8 +346,12 @@ void CGame::AddTimedJobs()
 
 			// SimFrame handles gc when not paused, this all other cases
 			// do not check the global synced state, never true in demos
-			if (luaGCControl == 1 || simFrameDeltaTime > gcForcedDeltaTime)
+			if (luaGCControl == 1 || simFrameDeltaTime > gcForcedDeltaTime) {
+				const float simFrameRate = GAME_SPEED * gs->speedFactor * (simFrameDeltaTime <= gcForcedDeltaTime);
+
+				CLuaHandle::ScheduleGarbageCollection(GetFrameIdleTime(1000.0f / GAME_SPEED, simFrameRate));
 				eventHandler.CollectGarbage();
+			}
 
 			CInputReceiver::CollectGarbage();
 			return true;
@@ -1093,6 +1127,9 @@ bool CGame::Update()
 
 	LEAVE_SYNCED_CODE();
 
+	if (replayBatch.IsActive())
+		replayBatch.Update();
+
 	{
 		SLuaAllocError error = {};
 
@@ -1360,6 +1397,8 @@ bool CGame::Draw() {
 	const spring_time currentFrameDrawTime = currentTimePostDraw - currentTimePreDraw;
 	gu->avgDrawFrameTime = mix(gu->avgDrawFrameTime, currentFrameDrawTime.toMilliSecsf(), 0.05f);
 
+	luaProfiler.Update();
+
 	eventHandler.DbgTimingInfo(TIMING_VIDEO, currentTimePreDraw, currentTimePostDraw);
 	globalRendering->SetGLTimeStamp(CGlobalRendering::FRAME_END_TIME_QUERY_IDX);
 
@@ -1471,6 +1510,9 @@ void CGame::StartPlaying()
 
 	if (saveFileHandler == nullptr)
 		eventHandler.GameStart();
+
+	if (replayBatch.IsActive())
+		replayBatch.GameStart();
 }
 
 
@@ -1485,6 +1527,8 @@ void CGame::SimFrame() {
 	gs->frameNum += 1;
 	lastFrameTime = spring_gettime();
 
+	profiler.UpdateCapture(gs->frameNum);
+
 	// clear allocator statistics periodically
 	// note: allocator itself should do this (so that
 	// stats are reliable when paused) but see LuaUser
@@ -1521,8 +1565,12 @@ void CGame::SimFrame() {
 
 			// keep garbage-collection rate tied to sim-speed
 			// (fixed 30Hz gc is not enough while catching up)
-			if (luaGCControl == 0)
+			if (luaGCControl == 0) {
+				const float simFrameRate = GAME_SPEED * gs->speedFactor;
+
+				CLuaHandle::ScheduleGarbageCollection(GetFrameIdleTime(1000.0f / simFrameRate, simFrameRate));
 				eventHandler.CollectGarbage();
+			}
 
 			eventHandler.GameFrame(gs->frameNum);
 		}
@@ -1533,6 +1581,7 @@ void CGame::SimFrame() {
 		unitHandler.Update();
 		projectileHandler.Update();
 		featureHandler.Update();
+		quadField.Update();
 		{
 			SCOPED_TIMER("Sim::Script");
 			unitScriptEngine->Tick(33);
@@ -1547,6 +1596,11 @@ void CGame::SimFrame() {
 
 		teamHandler.GameFrame(gs->frameNum);
 		playerHandler.GameFrame(gs->frameNum);
+
+		{
+			SCOPED_TIMER("Sim::BatchedEvents");
+			eventHandler.DeliverBatchedEvents();
+		}
 	}
 
 	lastSimFrameTime = spring_gettime();
@@ -1562,7 +1616,8 @@ void CGame::SimFrame() {
 		// multiply by 0.5 to give unsynced code some execution time (50% of our sleep-budget)
 		const float msecSleepTime = (msecMaxSimFrameTime - msecDifSimFrameTime) * 0.5f;
 
-		if (msecSleepTime > 0.0f) {
+		// batch replays run as fast as possible
+		if (msecSleepTime > 0.0f && !replayBatch.IsActive()) {
 			spring_sleep(spring_msecs(msecSleepTime));
 		}
 	}
@@ -1571,6 +1626,9 @@ void CGame::SimFrame() {
 	// useful for desync-debugging (enter instead of -1 start & end frame of the range you want to debug)
 	DumpState(-1, -1, 1);
 
+	if (demoKeyFrameInterval > 0 && gs->frameNum > 0 && (gs->frameNum % demoKeyFrameInterval) == 0)
+		SaveDemoKeyFrame();
+
 	ASSERT_SYNCED(gsRNG.GetGenState());
 	LEAVE_SYNCED_CODE();
 }
@@ -1602,6 +1660,9 @@ void CGame::GameEnd(const std::vector<unsigned char>& winningAllyTeams, bool tim
 	gameOver = true;
 	eventHandler.GameOver(winningAllyTeams);
 
+	if (replayBatch.IsActive())
+		replayBatch.GameOver(winningAllyTeams);
+
 	CEndGameBox::Create(winningAllyTeams);
 #ifdef    HEADLESS
 	profiler.PrintProfilingInfo();
@@ -1876,6 +1937,80 @@ void CGame::SaveGame(std::string&& fileName, std::string&& saveArgs)
 	globalSaveFileData.args = std::move(saveArgs);
 }
 
+void CGame::SaveDemoKeyFrame()
+{
+	CDemoRecorder* record = clientNet->GetDemoRecorder();
+
+	if (record == nullptr)
+		return;
+	// skip snapshots while the previous one is still being written out
+	if (!record->CanSaveKeyFrame())
+		return;
+	// or while catching up, another one follows soon enough
+	if (skipping || GetNumQueuedSimFrameMessages(GAME_SPEED) >= GAME_SPEED)
+		return;
+
+	SCOPED_TIMER("Sim::DemoKeyFrame");
+
+	// called right after a frame, the recorded stream is not past it yet
+	CCregLoadSaveHandler lsh;
+	record->SaveKeyFrame(gs->frameNum, lsh.SaveGameState());
+}
+
+void CGame::LoadDemoKeyFrame(int frameNum)
+{
+	// unlike ReloadGame this replaces the state of a session that was not
+	// started from a savegame, only acceptable while watching a local demo
+	if (!gameSetup->hostDemo) {
+		LOG_L(L_WARNING, "[Game::%s] can only load demo keyframes during demo playback", __func__);
+		return;
+	}
+
+	std::string state;
+
+	if (gameServer == nullptr || !gameServer->GetDemoKeyFrameState(frameNum, state)) {
+		LOG_L(L_ERROR, "[Game::%s] no game-state available for demo keyframe %d", __func__, frameNum);
+		return;
+	}
+
+	// keyframes were saved by the recording client, whose identity must
+	// not replace ours (gu serializes it along with the game-time)
+	const int myPlayerNum = gu->myPlayerNum;
+	const int myTeam = gu->myTeam;
+	const int myAllyTeam = gu->myAllyTeam;
+	const int myPlayingTeam = gu->myPlayingTeam;
+	const int myPlayingAllyTeam = gu->myPlayingAllyTeam;
+	const bool spectating = gu->spectating;
+	const bool spectatingFullView = gu->spectatingFullView;
+	const bool spectatingFullSelect = gu->spectatingFullSelect;
+
+	// selected units do not survive the state being replaced
+	selectedUnitsHandler.ClearSelected();
+
+	CCregLoadSaveHandler lsh;
+	lsh.LoadGameState(std::move(state));
+
+	gu->myPlayerNum = myPlayerNum;
+	gu->myTeam = myTeam;
+	gu->myAllyTeam = myAllyTeam;
+	gu->myPlayingTeam = myPlayingTeam;
+	gu->myPlayingAllyTeam = myPlayingAllyTeam;
+	gu->spectating = spectating;
+	gu->spectatingFullView = spectatingFullView;
+	gu->spectatingFullSelect = spectatingFullSelect;
+
+	// as after loading a savegame, the unsynced Lua states are rebuilt on
+	// top of the loaded synced ones (they still refer to the old objects)
+	if (luaRules != nullptr)
+		luaRules->ReloadUnsynced();
+	if (luaGaia != nullptr)
+		luaGaia->ReloadUnsynced();
+	if (guihandler != nullptr)
+		guihandler->EnableLuaUI(false);
+
+	LOG("[Game::%s] loaded demo keyframe %d (frame %d)", __func__, frameNum, gs->frameNum);
+}
+
 
 
 
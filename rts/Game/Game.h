@@ -92,6 +92,9 @@ public:
 	void ReloadGame();
 	void SaveGame(std::string&& fileName, std::string&& saveArgs);
 
+	void SaveDemoKeyFrame();
+	void LoadDemoKeyFrame(int frameNum);
+
 	void ResizeEvent() override;
 
 	void SetDrawMode(Game::DrawMode mode) { gameDrawMode = mode; }
@@ -200,6 +203,9 @@ public:
 	// 0 := 1/f rate, 1 := 30/s rate
 	int luaGCControl = 0;
 
+	// sim-frames between game-state keyframes added to our demo, 0 := none
+	int demoKeyFrameInterval = 0;
+
 private:
 	JobDispatcher jobDispatcher;
 
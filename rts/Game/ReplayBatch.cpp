@@ -0,0 +1,171 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "ReplayBatch.h"
+#include "CommandMessage.h"
+#include "GameSetup.h"
+#include "GlobalUnsynced.h"
+#include "Net/GameServer.h"
+#include "Net/Protocol/NetProtocol.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/Team.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/LoadSave/DemoReader.h"
+#include "System/Log/ILog.h"
+
+CReplayBatch replayBatch;
+
+
+bool CReplayBatch::Init(const std::string& listFileName, const std::string& workerSpec)
+{
+	unsigned int workerNum = 0;
+	unsigned int numWorkers = 1;
+
+	if (!workerSpec.empty() && (sscanf(workerSpec.c_str(), "%u/%u", &workerNum, &numWorkers) != 2 || workerNum >= numWorkers)) {
+		LOG_L(L_ERROR, "[ReplayBatch::%s] invalid worker \"%s\" (expected K/N with K < N)", __func__, workerSpec.c_str());
+		return false;
+	}
+
+	CFileHandler listFile(listFileName, SPRING_VFS_PWD_ALL);
+	std::string listData;
+
+	if (!listFile.FileExists() || !listFile.LoadStringData(listData)) {
+		LOG_L(L_ERROR, "[ReplayBatch::%s] could not read demo-list \"%s\"", __func__, listFileName.c_str());
+		return false;
+	}
+
+	std::istringstream listStream(listData);
+	std::string line;
+
+	// one demo per line, empty lines and #comments are skipped
+	for (unsigned int lineNum = 0; std::getline(listStream, line); ) {
+		StringTrimInPlace(line);
+
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		if (((lineNum++) % numWorkers) != workerNum)
+			continue;
+
+		demoFiles.push_back(line);
+	}
+
+	if (demoFiles.empty()) {
+		LOG_L(L_ERROR, "[ReplayBatch::%s] no demos to replay in \"%s\"", __func__, listFileName.c_str());
+		return false;
+	}
+
+	std::string statsName = "replaybatch_" + FileSystem::GetBasename(listFileName);
+
+	if (numWorkers > 1)
+		statsName += "_" + IntToString(workerNum);
+
+	statsFileName = dataDirsAccess.LocateFile(statsName + ".csv", FileQueryFlags::WRITE);
+	demoIndex = 0;
+
+	LOG("[ReplayBatch::%s] replaying %u demos (worker %u of %u), writing statistics to \"%s\"", __func__, unsigned(demoFiles.size()), workerNum, numWorkers, statsFileName.c_str());
+	return true;
+}
+
+
+void CReplayBatch::GameStart()
+{
+	winningAllyTeams.clear();
+
+	demoStartTime = spring_gettime();
+	demoStartFrame = gs->frameNum;
+	haveStarted = true;
+
+	// let the server push out the entire demo right away, frames are then
+	// simulated as fast as they can be taken from the (local) connection;
+	// keyframes would skip most of the simulation the batch is timing
+	clientNet->Send(CommandMessage("skip f2147483647 nokeyframes", gu->myPlayerNum).Pack());
+}
+
+void CReplayBatch::GameOver(const std::vector<unsigned char>& winners)
+{
+	winningAllyTeams = winners;
+}
+
+
+void CReplayBatch::Update()
+{
+	if (!haveStarted)
+		return;
+	if (gameServer == nullptr || !gameServer->HasDemoEnded())
+		return;
+	if (clientNet->Peek(0) != nullptr)
+		return;
+
+	const int numFrames = gs->frameNum - demoStartFrame;
+	const float wallTime = std::max((spring_gettime() - demoStartTime).toSecsf(), 0.001f);
+
+	numBatchFrames += numFrames;
+	batchWallTime += wallTime;
+
+	LOG("[ReplayBatch::%s] replayed \"%s\" (%u/%u): %d frames in %.2fs (%.1f frames/s)", __func__, GetDemoFile().c_str(), unsigned(demoIndex + 1), unsigned(demoFiles.size()), numFrames, wallTime, numFrames / wallTime);
+
+	WriteDemoStats(numFrames, wallTime);
+
+	haveStarted = false;
+
+	if ((++demoIndex) < demoFiles.size()) {
+		gameSetup->reloadScript = "[GAME]\n{\n";
+		gameSetup->reloadScript += "\tDemoFile=" + GetDemoFile() + ";\n";
+		gameSetup->reloadScript += "\tMyPlayerName=" + configHandler->GetString("name") + ";\n";
+		gameSetup->reloadScript += "\tIsHost=1;\n";
+		gameSetup->reloadScript += "}\n";
+
+		gu->globalReload = true;
+		return;
+	}
+
+	LOG("[ReplayBatch::%s] replayed %u demos: %d frames in %.2fs (%.1f frames/s)", __func__, unsigned(demoFiles.size()), int(numBatchFrames), batchWallTime, numBatchFrames / std::max(batchWallTime, 0.001f));
+
+	gu->globalQuit = true;
+}
+
+
+void CReplayBatch::WriteDemoStats(int numFrames, float wallTime)
+{
+	// first demo of the batch truncates
+	std::ofstream file(statsFileName, std::ios::out | ((demoIndex == 0)? std::ios::trunc: std::ios::app));
+
+	if (!file.good()) {
+		LOG_L(L_ERROR, "[ReplayBatch::%s] could not write to \"%s\"", __func__, statsFileName.c_str());
+		return;
+	}
+
+	if (demoIndex == 0) {
+		file << "demo,frames,wallTime,framesPerSecond,team,allyTeam,won,dead,units,metal,energy";
+		file << ",metalUsed,energyUsed,metalProduced,energyProduced,metalExcess,energyExcess";
+		file << ",metalReceived,energyReceived,metalSent,energySent,damageDealt,damageReceived";
+		file << ",unitsProduced,unitsDied,unitsReceived,unitsSent,unitsCaptured,unitsOutCaptured,unitsKilled\n";
+	}
+
+	for (int teamNum = 0; teamNum < teamHandler.ActiveTeams(); teamNum++) {
+		const CTeam* team = teamHandler.Team(teamNum);
+		const TeamStatistics& stats = team->GetCurrentStats();
+
+		const bool won = (std::find(winningAllyTeams.begin(), winningAllyTeams.end(), team->teamAllyteam) != winningAllyTeams.end());
+
+		file << '"' << GetDemoFile() << '"' << ',' << numFrames << ',' << wallTime << ',' << (numFrames / wallTime);
+		file << ',' << teamNum << ',' << team->teamAllyteam << ',' << won << ',' << team->isDead << ',' << team->GetNumUnits();
+		file << ',' << team->res.metal << ',' << team->res.energy;
+		file << ',' << stats.metalUsed << ',' << stats.energyUsed << ',' << stats.metalProduced << ',' << stats.energyProduced;
+		file << ',' << stats.metalExcess << ',' << stats.energyExcess << ',' << stats.metalReceived << ',' << stats.energyReceived;
+		file << ',' << stats.metalSent << ',' << stats.energySent << ',' << stats.damageDealt << ',' << stats.damageReceived;
+		file << ',' << stats.unitsProduced << ',' << stats.unitsDied << ',' << stats.unitsReceived << ',' << stats.unitsSent;
+		file << ',' << stats.unitsCaptured << ',' << stats.unitsOutCaptured << ',' << stats.unitsKilled << '\n';
+	}
+}
@@ -0,0 +1,55 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef REPLAY_BATCH_H
+#define REPLAY_BATCH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+
+// replays a list of demos back-to-back (see --replay-batch) as fast as
+// the server can read them and the client can simulate, appending the
+// final TeamStatistics and end-state of every team to a CSV file in the
+// write-dir; several processes can share one list by each taking every
+// N-th demo (see --replay-worker)
+class CReplayBatch {
+public:
+	bool Init(const std::string& listFileName, const std::string& workerSpec);
+
+	bool IsActive() const { return (demoIndex < demoFiles.size()); }
+
+	const std::string& GetDemoFile() const { return demoFiles[demoIndex]; }
+
+	void GameStart();
+	void GameOver(const std::vector<unsigned char>& winningAllyTeams);
+	// called every game update; reloads with the next demo (or quits)
+	// once the server has read all of the current one and every frame
+	// it sent has been simulated
+	void Update();
+
+private:
+	void WriteDemoStats(int numFrames, float wallTime);
+
+private:
+	std::vector<std::string> demoFiles;
+	std::vector<unsigned char> winningAllyTeams;
+
+	std::string statsFileName;
+
+	size_t demoIndex = -1lu;
+
+	spring_time demoStartTime;
+
+	int demoStartFrame = 0;
+	bool haveStarted = false;
+
+	// totals over all demos replayed so far
+	std::int64_t numBatchFrames = 0;
+	float batchWallTime = 0.0f;
+};
+
+extern CReplayBatch replayBatch;
+
+#endif
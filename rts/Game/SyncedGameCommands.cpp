@@ -524,7 +524,11 @@ public:
 	}
 
 	bool Execute(const SyncedAction& action) const final {
-		if (action.GetArgs().find_first_of("start") == 0) {
+		if (action.GetArgs().find("keyframe ") == 0) {
+			// sent by a demo server which has skipped ahead to a keyframe
+			game->LoadDemoKeyFrame(atoi(action.GetArgs().c_str() + 9));
+		}
+		else if (action.GetArgs().find_first_of("start") == 0) {
 			std::istringstream buf(action.GetArgs().substr(6));
 			int targetFrame;
 			buf >> targetFrame;
@@ -44,7 +44,9 @@
 #include "Game/UI/Groups/GroupHandler.h"
 #include "Game/UI/PlayerRoster.h"
 
+#include "Lua/LuaHandle.h"
 #include "Lua/LuaOpenGL.h"
+#include "Lua/LuaProfiler.h"
 #include "Lua/LuaUI.h"
 
 #include "Map/Ground.h"
@@ -81,8 +83,11 @@
 #include "Rendering/Shaders/ShaderHandler.h"
 
 #include "Sim/MoveTypes/MoveDefHandler.h"
+#include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/ModInfo.h"
+#include "Sim/Misc/QuadField.h"
+#include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitDefHandler.h"
@@ -93,8 +98,11 @@
 #include "System/GlobalConfig.h"
 #include "System/SafeUtil.h"
 #include "System/TimeProfiler.h"
+#include "System/TimeUtil.h"
 #include "System/Log/ILog.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
@@ -1437,6 +1445,74 @@ public:
 
 
 
+class LuaProfilerActionExecutor: public IUnsyncedActionExecutor {
+public:
+	LuaProfilerActionExecutor() : IUnsyncedActionExecutor(
+		"LuaProfiler",
+		"Start or stop recording the time and allocations of every Lua call-in and function call, written as collapsed stacks (for flamegraph tools) when stopped"
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		bool enable = luaProfiler.IsEnabled();
+
+		InverseOrSetBool(enable, action.GetArgs());
+
+		if (enable == luaProfiler.IsEnabled())
+			return true;
+
+		luaProfiler.SetEnabled(enable);
+
+		if (enable) {
+			LOG("Lua profiling enabled");
+			return true;
+		}
+
+		luaProfiler.PrintStats();
+
+		const std::string baseName = "luaprofile_" + CTimeUtil::GetCurrentTimeStr();
+
+		for (const bool allocCounts: {false, true}) {
+			const std::string fileName = baseName + (allocCounts? "_allocs.folded": "_time.folded");
+			const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE);
+
+			if (luaProfiler.WriteCollapsedStacks(filePath, allocCounts)) {
+				LOG("Lua profile written to \"%s\"", filePath.c_str());
+			} else {
+				LOG_L(L_WARNING, "Lua profile could not be written to \"%s\"", filePath.c_str());
+			}
+		}
+
+		return true;
+	}
+};
+
+
+class ProfileCaptureActionExecutor: public IUnsyncedActionExecutor {
+public:
+	ProfileCaptureActionExecutor() : IUnsyncedActionExecutor(
+		"ProfileCapture",
+		"Capture all profiler timers (with their threads) for the given number of sim-frames [default 300], optionally starting at a given frame, to a Chrome trace-file"
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		const std::vector<std::string>& args = _local_strSpaceTokenize(action.GetArgs());
+
+		const int numFrames = std::max((args.size() > 0)? atoi(args[0].c_str()): GAME_SPEED * 10, 1);
+		const int firstFrame = std::max((args.size() > 1)? atoi(args[1].c_str()): gs->frameNum + 1, 0);
+
+		const std::string fileName = "profile_" + CTimeUtil::GetCurrentTimeStr() + ".json";
+		const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE);
+
+		profiler.SetCaptureRange(firstFrame, firstFrame + numFrames - 1, filePath);
+
+		LOG("[%s] capturing sim-frames %d to %d into \"%s\"", __func__, firstFrame, firstFrame + numFrames - 1, filePath.c_str());
+		return true;
+	}
+};
+
+
 class GameInfoActionExecutor : public IUnsyncedActionExecutor {
 public:
 	GameInfoActionExecutor() : IUnsyncedActionExecutor("GameInfo", "Enables/Disables game-info panel rendering") {
@@ -2789,6 +2865,20 @@ public:
 };
 
 
+class MTMoveTypesActionExecutor : public IUnsyncedActionExecutor {
+public:
+	MTMoveTypesActionExecutor(): IUnsyncedActionExecutor("MTMoveTypes", "Enable/Disable sampling the terrain under moving units on worker threads (sync-neutral)") {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		bool enable = unitHandler.GetMTMoveTypeUpdates();
+		InverseOrSetBool(enable, action.GetArgs());
+		LogSystemStatus("multi-threaded MoveType terrain sampling", unitHandler.SetMTMoveTypeUpdates(enable));
+		return true;
+	}
+};
+
+
 
 class CrashActionExecutor : public IUnsyncedActionExecutor {
 public:
@@ -3011,7 +3101,7 @@ class DebugInfoActionExecutor : public IUnsyncedActionExecutor {
 public:
 	DebugInfoActionExecutor() : IUnsyncedActionExecutor(
 		"DebugInfo",
-		"Print debug info to the chat/log-file about either sound, profiling, or command-descriptions"
+		"Print debug info to the chat/log-file about either sound, profiling, command-descriptions, LOS updates, QuadField occupancy, the path-cache, QTPFS layer-updates, or Lua garbage-collection"
 	) {
 	}
 
@@ -3028,8 +3118,40 @@ public:
 			case hashString("cmddescrs"): {
 				commandDescriptionCache.Dump(true);
 			} break;
+			case hashString("los"): {
+				losHandler->PrintUpdateStats();
+			} break;
+			case hashString("quadfield"): {
+				const CQuadField::OccupancyStats& stats = quadField.GetOccupancyStats();
+
+				LOG("[DbgInfoAction::%s] quad-size=%d quads={%d,%d} occupied=%d objects-per-quad={avg=%.2f,peak=%d} resizes=%d",
+					__func__, quadField.GetQuadSizeX(), quadField.GetNumQuadsX(), quadField.GetNumQuadsZ(), stats.numOccupiedQuads,
+					stats.avgObjectsPerQuad, stats.peakObjectsPerQuad, stats.numResizes
+				);
+			} break;
+			case hashString("pathcache"): {
+				for (const bool synced: {true, false}) {
+					const IPathManager::PathCacheStats stats = pathManager->GetPathCacheStats(synced);
+					const unsigned int numRequests = stats.numHits + stats.numMisses;
+
+					LOG("[DbgInfoAction::%s] %s path-cache: size=%u hits=%u (near=%u, %.0f%%) misses=%u evictions=%u expirations=%u",
+						__func__, (synced? "synced": "unsynced"), stats.numCachedPaths, stats.numHits, stats.numNearHits,
+						(numRequests == 0)? 0.0f: (stats.numHits * 100.0f / numRequests), stats.numMisses, stats.numEvictions, stats.numExpirations
+					);
+				}
+			} break;
+			case hashString("pathlayers"): {
+				const IPathManager::LayerUpdateStats stats = pathManager->GetLayerUpdateStats();
+
+				LOG("[DbgInfoAction::%s] layer-updates: queued=%u merged=%u executed=%u tesselated=%u pending=%u",
+					__func__, stats.numQueuedRects, stats.numMergedRects, stats.numExecutedRects, stats.numTesselatedRects, stats.numPendingRects
+				);
+			} break;
+			case hashString("luagc"): {
+				CLuaHandle::LogGarbageCollectStats();
+			} break;
 			default: {
-				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", or \"cmddescrs\")", __func__, args.c_str());
+				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", \"cmddescrs\", \"los\", \"quadfield\", \"pathcache\", \"pathlayers\", or \"luagc\")", __func__, args.c_str());
 			} break;
 		}
 
@@ -3288,6 +3410,7 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<DebugColVolDrawerActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DebugPathDrawerActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DebugTraceRayDrawerActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<MTMoveTypesActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<MuteActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<SoundActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<SoundChannelEnableActionExecutor>());
@@ -3354,6 +3477,8 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<NoLuaDrawActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<LuaUIActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<LuaGarbageCollectControlExecutor>());
+	AddActionExecutor(AllocActionExecutor<LuaProfilerActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<ProfileCaptureActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<MiniMapActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<GroundDecalsActionExecutor>());
 
@@ -41,6 +41,7 @@ void CWordCompletion::Init()
 	AddWordRaw("/kick ", true, false, false);
 	AddWordRaw("/kickbynum ", true, false, false);
 	AddWordRaw("/mutebynum ", true, false, false);
+	AddWordRaw("/relaylatency ", true, false, false);
 }
 
 
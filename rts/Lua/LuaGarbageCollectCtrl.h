@@ -3,6 +3,7 @@
 #ifndef SPRING_LUA_GARBAGE_COLLECT_CTRL_H
 #define SPRING_LUA_GARBAGE_COLLECT_CTRL_H
 
+#include <cstdint>
 #include <limits>
 
 struct SLuaGarbageCollectCtrl {
@@ -20,6 +21,21 @@ struct SLuaGarbageCollectCtrl {
 
 	float baseRunTimeMult = 0.0f;
 	float baseMemLoadMult = 0.0f;
+	float baseIdleTimeMult = 0.0f;
+
+	// share (in milliseconds) of the current frame's idle time handed
+	// to this handle by CLuaHandle::ScheduleGarbageCollection, added to
+	// the runtime of the next CollectGarbage call
+	float frameRunTime = 0.0f;
+	// smoothed number of allocations made between two scheduling passes
+	float avgAllocRate = 0.0f;
+
+	std::uint64_t prevNumLuaAllocs = 0;
+
+	// time spent in CollectGarbage, in milliseconds
+	float lastRunTime = 0.0f;
+	float avgRunTime = 0.0f;
+	double sumRunTime = 0.0;
 };
 
 #endif
@@ -10,6 +10,7 @@
 #include "LuaConfig.h"
 #include "LuaHashString.h"
 #include "LuaOpenGL.h"
+#include "LuaProfiler.h"
 #include "LuaBitOps.h"
 #include "LuaMathExtra.h"
 #include "LuaUtils.h"
@@ -54,6 +55,7 @@
 
 CONFIG(float, LuaGarbageCollectionMemLoadMult).defaultValue(1.33f).minimumValue(1.0f).maximumValue(100.0f);
 CONFIG(float, LuaGarbageCollectionRunTimeMult).defaultValue(5.0f).minimumValue(1.0f).description("in milliseconds");
+CONFIG(float, LuaGarbageCollectionIdleTimeMult).defaultValue(0.5f).minimumValue(0.0f).maximumValue(1.0f).description("Fraction of each frame's idle time that is shared out among Lua handles for garbage collection, by allocation rate. 0 restores the fixed footprint-based runtime.");
 
 
 static spring::unsynced_set<const luaContextData*>    SYNCED_LUAHANDLE_CONTEXTS;
@@ -107,6 +109,7 @@ CLuaHandle::CLuaHandle(const string& _name, int _order, bool _userMode, bool _sy
 
 	D.gcCtrl.baseMemLoadMult = configHandler->GetFloat("LuaGarbageCollectionMemLoadMult");
 	D.gcCtrl.baseRunTimeMult = configHandler->GetFloat("LuaGarbageCollectionRunTimeMult");
+	D.gcCtrl.baseIdleTimeMult = configHandler->GetFloat("LuaGarbageCollectionIdleTimeMult");
 
 	L = LUA_OPEN(&D);
 	L_GC = lua_newthread(L);
@@ -323,7 +326,12 @@ int CLuaHandle::RunCallInTraceback(
 			// note1: disable GC outside of this scope to prevent sync errors and similar
 			// note2: we collect garbage now in its own callin "CollectGarbage"
 			// lua_gc(L, LUA_GCRESTART, 0);
+			const bool profiled = luaProfiler.EnterCallIn(state, handle, luaFunc);
 			error = lua_pcall(state, nInArgs, nOutArgs, errFuncIdx);
+
+			if (profiled)
+				luaProfiler.LeaveCallIn(state);
+
 			// only run GC inside of "SetHandleRunning(L, true) ... SetHandleRunning(L, false)"!
 			lua_gc(state, LUA_GCSTOP, 0);
 
@@ -1008,6 +1016,61 @@ void CLuaHandle::UnitDamaged(
 	RunCallInTraceback(L, cmdStr, argCount, 0, traceBack.GetErrFuncIdx(), false);
 }
 
+void CLuaHandle::UnitDamagedBatch(const std::vector<SUnitDamagedEvent>& events)
+{
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 13, __func__);
+
+	static const LuaHashString cmdStr(__func__);
+	const LuaUtils::ScopedDebugTraceBack traceBack(L);
+
+	if (!cmdStr.GetGlobalFunc(L))
+		return;
+
+	// one array per UnitDamaged argument, indexed by event
+	#define PUSH_EVENT_ARRAY(pushFunc, member) \
+		lua_createtable(L, events.size(), 0); \
+		for (size_t i = 0; i < events.size(); i++) { \
+			pushFunc(L, events[i].member); \
+			lua_rawseti(L, -2, i + 1); \
+		}
+
+	int argCount = 7;
+
+	PUSH_EVENT_ARRAY(lua_pushnumber, unitID)
+	PUSH_EVENT_ARRAY(lua_pushnumber, unitDefID)
+	PUSH_EVENT_ARRAY(lua_pushnumber, unitTeam)
+	PUSH_EVENT_ARRAY(lua_pushnumber, damage)
+	PUSH_EVENT_ARRAY(lua_pushboolean, paralyzer)
+	// these two do not count as information leaks
+	PUSH_EVENT_ARRAY(lua_pushnumber, weaponDefID)
+	PUSH_EVENT_ARRAY(lua_pushnumber, projectileID)
+
+	if (GetHandleFullRead(L)) {
+		// false where there was no attacker
+		for (const int SUnitDamagedEvent::*member: {&SUnitDamagedEvent::attackerID, &SUnitDamagedEvent::attackerDefID, &SUnitDamagedEvent::attackerTeam}) {
+			lua_createtable(L, events.size(), 0);
+
+			for (size_t i = 0; i < events.size(); i++) {
+				if (events[i].attackerID != -1) {
+					lua_pushnumber(L, events[i].*member);
+				} else {
+					lua_pushboolean(L, false);
+				}
+
+				lua_rawseti(L, -2, i + 1);
+			}
+		}
+
+		argCount += 3;
+	}
+
+	#undef PUSH_EVENT_ARRAY
+
+	// call the routine
+	RunCallInTraceback(L, cmdStr, argCount, 0, traceBack.GetErrFuncIdx(), false);
+}
+
 void CLuaHandle::UnitStunned(
 	const CUnit* unit,
 	bool stunned)
@@ -1307,6 +1370,28 @@ void CLuaHandle::UnitMoveFailed(const CUnit* unit)
 	UnitCallIn(cmdStr, unit);
 }
 
+void CLuaHandle::UnitMovedBatch(const std::vector<SUnitMovedEvent>& events)
+{
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 4, __func__);
+
+	static const LuaHashString cmdStr(__func__);
+	const LuaUtils::ScopedDebugTraceBack traceBack(L);
+
+	if (!cmdStr.GetGlobalFunc(L))
+		return;
+
+	lua_createtable(L, events.size(), 0);
+
+	for (size_t i = 0; i < events.size(); i++) {
+		lua_pushnumber(L, events[i].unitID);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	// call the routine
+	RunCallInTraceback(L, cmdStr, 1, 0, traceBack.GetErrFuncIdx(), false);
+}
+
 
 void CLuaHandle::RenderUnitDestroyed(const CUnit* unit)
 {
@@ -1448,6 +1533,51 @@ void CLuaHandle::ProjectileCreated(const CProjectile* p)
 }
 
 
+void CLuaHandle::ProjectileCreatedBatch(const std::vector<SProjectileCreatedEvent>& events)
+{
+	// if empty, we are not a LuaHandleSynced
+	if (watchProjectileDefs.empty())
+		return;
+
+	// only pass the projectiles ProjectileCreated would be called for
+	std::vector<const SProjectileCreatedEvent*> watchedEvents;
+	watchedEvents.reserve(events.size());
+
+	for (const SProjectileCreatedEvent& e: events) {
+		if (!e.piece && (e.weaponDefID < 0 || !watchProjectileDefs[e.weaponDefID]))
+			continue;
+		if (e.piece && !watchProjectileDefs[watchProjectileDefs.size() - 1])
+			continue;
+
+		watchedEvents.push_back(&e);
+	}
+
+	if (watchedEvents.empty())
+		return;
+
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 6, __func__);
+
+	static const LuaHashString cmdStr(__func__);
+	const LuaUtils::ScopedDebugTraceBack traceBack(L);
+
+	if (!cmdStr.GetGlobalFunc(L))
+		return;
+
+	for (const int SProjectileCreatedEvent::*member: {&SProjectileCreatedEvent::projectileID, &SProjectileCreatedEvent::ownerID, &SProjectileCreatedEvent::weaponDefID}) {
+		lua_createtable(L, watchedEvents.size(), 0);
+
+		for (size_t i = 0; i < watchedEvents.size(); i++) {
+			lua_pushnumber(L, watchedEvents[i]->*member);
+			lua_rawseti(L, -2, i + 1);
+		}
+	}
+
+	// call the routine
+	RunCallInTraceback(L, cmdStr, 3, 0, traceBack.GetErrFuncIdx(), false);
+}
+
+
 void CLuaHandle::ProjectileDestroyed(const CProjectile* p)
 {
 	// if empty, we are not a LuaHandleSynced
@@ -2504,6 +2634,10 @@ void CLuaHandle::CollectGarbage()
 {
 	const float gcMemLoadMult = D.gcCtrl.baseMemLoadMult;
 	const float gcRunTimeMult = D.gcCtrl.baseRunTimeMult;
+	const float gcSchedRunTime = D.gcCtrl.frameRunTime;
+
+	// a schedule only applies to the call it was made for
+	D.gcCtrl.frameRunTime = 0.0f;
 
 	if (spring_lua_alloc_skip_gc(gcMemLoadMult))
 		return;
@@ -2523,7 +2657,9 @@ void CLuaHandle::CollectGarbage()
 	// mean too much time is spent on it, must weigh the per-call period
 	const float gcSpeedFactor = Clamp(gs->speedFactor * (1 - gs->PreSimFrame()) * (1 - gs->paused), 1.0f, 50.0f);
 	const float gcBaseRunTime = smoothstep(10.0f, 100.0f, gcMemFootPrint / 1024);
-	const float gcLoopRunTime = Clamp((gcBaseRunTime * gcRunTimeMult) / gcSpeedFactor, D.gcCtrl.minLoopRunTime, D.gcCtrl.maxLoopRunTime);
+	// the footprint heuristic is a floor that applies even in frames
+	// without any slack, the scheduled idle-time share comes on top
+	const float gcLoopRunTime = Clamp((gcBaseRunTime * gcRunTimeMult) / gcSpeedFactor + gcSchedRunTime, D.gcCtrl.minLoopRunTime, D.gcCtrl.maxLoopRunTime);
 
 	const spring_time startTime = spring_gettime();
 	const spring_time   endTime = startTime + spring_msecs(gcLoopRunTime);
@@ -2554,6 +2690,10 @@ void CLuaHandle::CollectGarbage()
 
 	const spring_time finishTime = spring_gettime();
 
+	D.gcCtrl.lastRunTime = (finishTime - startTime).toMilliSecsf();
+	D.gcCtrl.avgRunTime = mix(D.gcCtrl.avgRunTime, D.gcCtrl.lastRunTime, 0.05f);
+	D.gcCtrl.sumRunTime += D.gcCtrl.lastRunTime;
+
 	if (gcStepsPerIter > 1 && gcItersInBatch > 0) {
 		// runtime optimize number of steps to process in a batch
 		const float avgLoopIterTime = (finishTime - startTime).toMilliSecsf() / gcItersInBatch;
@@ -2569,6 +2709,57 @@ void CLuaHandle::CollectGarbage()
 /******************************************************************************/
 /******************************************************************************/
 
+void CLuaHandle::ScheduleGarbageCollection(float frameIdleTime)
+{
+	// hand out the idle part of a frame proportionally to how much
+	// each handle allocated since the previous pass; handles that
+	// churn through memory need more collection time than quiet ones
+	float sumAllocRate = 0.0f;
+
+	for (const auto* contexts: LUAHANDLE_CONTEXTS) {
+		for (const luaContextData* lcd: *contexts) {
+			SLuaGarbageCollectCtrl& gcCtrl = const_cast<luaContextData*>(lcd)->gcCtrl;
+
+			const std::uint64_t numLuaAllocs = lcd->allocState.numLuaAllocs.load();
+			const std::uint64_t numNewAllocs = numLuaAllocs - gcCtrl.prevNumLuaAllocs;
+
+			gcCtrl.avgAllocRate = mix(gcCtrl.avgAllocRate, numNewAllocs * 1.0f, 0.25f);
+			gcCtrl.prevNumLuaAllocs = numLuaAllocs;
+
+			sumAllocRate += gcCtrl.avgAllocRate;
+		}
+	}
+
+	for (const auto* contexts: LUAHANDLE_CONTEXTS) {
+		for (const luaContextData* lcd: *contexts) {
+			SLuaGarbageCollectCtrl& gcCtrl = const_cast<luaContextData*>(lcd)->gcCtrl;
+
+			gcCtrl.frameRunTime = frameIdleTime * gcCtrl.baseIdleTimeMult * (gcCtrl.avgAllocRate / std::max(sumAllocRate, 1.0f));
+		}
+	}
+}
+
+void CLuaHandle::LogGarbageCollectStats()
+{
+	LOG("[LuaHandle::%s] {last,avg,sum}RunTime (ms) and allocation-rate per handle", __func__);
+
+	for (const auto* contexts: LUAHANDLE_CONTEXTS) {
+		for (const luaContextData* lcd: *contexts) {
+			const SLuaGarbageCollectCtrl& gcCtrl = lcd->gcCtrl;
+
+			LOG(
+				"\t%s (%s) {%.3f, %.3f, %.1f} allocs=%.1f steps=%d",
+				(lcd->owner->GetName()).c_str(), lcd->synced? "synced": "unsynced",
+				gcCtrl.lastRunTime, gcCtrl.avgRunTime, gcCtrl.sumRunTime,
+				gcCtrl.avgAllocRate, gcCtrl.numStepsPerIter
+			);
+		}
+	}
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
 bool CLuaHandle::AddBasicCalls(lua_State* L)
 {
 	HSTR_PUSH(L, "Script");
@@ -136,6 +136,7 @@ class CLuaHandle : public CEventClient
 			int projectileID,
 			bool paralyzer
 		) override;
+		void UnitDamagedBatch(const std::vector<SUnitDamagedEvent>& events) override;
 		void UnitStunned(const CUnit* unit, bool stunned) override;
 		void UnitExperience(const CUnit* unit, float oldExperience) override;
 		void UnitHarvestStorageFull(const CUnit* unit) override;
@@ -161,6 +162,7 @@ class CLuaHandle : public CEventClient
 		bool UnitUnitCollision(const CUnit* collider, const CUnit* collidee) override;
 		bool UnitFeatureCollision(const CUnit* collider, const CFeature* collidee) override;
 		void UnitMoveFailed(const CUnit* unit) override;
+		void UnitMovedBatch(const std::vector<SUnitMovedEvent>& events) override;
 
 		void RenderUnitDestroyed(const CUnit* unit) override;
 
@@ -176,6 +178,7 @@ class CLuaHandle : public CEventClient
 
 		void ProjectileCreated(const CProjectile* p) override;
 		void ProjectileDestroyed(const CProjectile* p) override;
+		void ProjectileCreatedBatch(const std::vector<SProjectileCreatedEvent>& events) override;
 
 		bool Explosion(int weaponID, int projectileID, const float3& pos, const CUnit* owner) override;
 
@@ -349,6 +352,9 @@ class CLuaHandle : public CEventClient
 
 		static void HandleLuaMsg(int playerID, int script, int mode, const std::vector<std::uint8_t>& msg);
 
+		static void ScheduleGarbageCollection(float frameIdleTime);
+		static void LogGarbageCollectStats();
+
 	protected: // static
 		static bool devMode; // allows real file access
 
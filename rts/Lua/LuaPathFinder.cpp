@@ -70,6 +70,8 @@ bool LuaPathFinder::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(SetPathNodeCost);
 	REGISTER_LUA_CFUNC(GetPathNodeCost);
 
+	REGISTER_LUA_CFUNC(GetPathCacheStats);
+
 	return true;
 }
 
@@ -410,5 +412,20 @@ int LuaPathFinder::GetPathNodeCost(lua_State* L)
 	return 1;
 }
 
+int LuaPathFinder::GetPathCacheStats(lua_State* L)
+{
+	// synced handles see the cache used by unit paths, unsynced the other
+	const IPathManager::PathCacheStats stats = pathManager->GetPathCacheStats(CLuaHandle::GetHandleSynced(L));
+
+	lua_createtable(L, 0, 6);
+	LuaPushNamedNumber(L, "hits", stats.numHits);
+	LuaPushNamedNumber(L, "nearHits", stats.numNearHits);
+	LuaPushNamedNumber(L, "misses", stats.numMisses);
+	LuaPushNamedNumber(L, "evictions", stats.numEvictions);
+	LuaPushNamedNumber(L, "expirations", stats.numExpirations);
+	LuaPushNamedNumber(L, "size", stats.numCachedPaths);
+	return 1;
+}
+
 /******************************************************************************/
 /******************************************************************************/
@@ -0,0 +1,240 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <fstream>
+
+#include "LuaProfiler.h"
+#include "LuaHandle.h"
+#include "LuaInclude.h"
+#include "System/MainDefines.h"
+#include "System/Log/ILog.h"
+#include "System/Platform/Threading.h"
+
+CLuaProfiler luaProfiler;
+
+
+static std::int64_t GetNumLuaAllocs()
+{
+	SLuaAllocState state = {{0}, {0}, {0}, {0}};
+	spring_lua_alloc_get_stats(&state);
+	return (state.numLuaAllocs.load());
+}
+
+
+void CLuaProfiler::SetEnabled(bool b)
+{
+	if (b == enabled)
+		return;
+
+	// records are kept after disabling so they can still be exported
+	if ((enabled = b)) {
+		stackRecords.clear();
+		callInRecords.clear();
+
+		numFrames = 0;
+	}
+
+	// hooks installed on Lua states stay dormant until their next call-in
+	callStack.clear();
+	callInFrames.clear();
+}
+
+
+bool CLuaProfiler::EnterCallIn(lua_State* L, const CLuaHandle* handle, const char* callInName)
+{
+	if (!enabled) {
+		// left over from a previous profiling session
+		if (lua_gethook(L) == FunctionHook)
+			lua_sethook(L, nullptr, 0, 0);
+
+		return false;
+	}
+
+	// LuaIntro can run on the loading thread
+	if (!Threading::IsMainThread())
+		return false;
+
+	if (lua_gethook(L) != FunctionHook)
+		lua_sethook(L, FunctionHook, LUA_MASKCALL | LUA_MASKRET, 0);
+
+	std::string callInKey = handle->GetName() + "::" + callInName;
+	std::string frameName = callInKey;
+
+	callInFrames.push_back(callStack.size());
+	PushFrame(L, std::move(frameName), std::move(callInKey));
+	return true;
+}
+
+void CLuaProfiler::LeaveCallIn(lua_State* L)
+{
+	// profiling was toggled while the call-in was running
+	if (callInFrames.empty())
+		return;
+
+	// unwind frames whose return went unseen (errors, yielded coroutines)
+	while (callStack.size() > callInFrames.back())
+		PopFrame();
+
+	callInFrames.pop_back();
+}
+
+
+void CLuaProfiler::Update()
+{
+	if (!enabled)
+		return;
+
+	for (auto& p: callInRecords) {
+		CallInRecord& r = p.second;
+
+		r.totalTime += r.frameTime;
+		r.totalAllocs += r.frameAllocs;
+		r.peakTime = std::max(r.peakTime, r.frameTime);
+
+		r.frameTime = 0;
+		r.frameAllocs = 0;
+	}
+
+	numFrames += 1;
+}
+
+
+void CLuaProfiler::PrintStats() const
+{
+	std::vector<std::pair<std::string, CallInRecord>> sortedRecords(callInRecords.begin(), callInRecords.end());
+
+	std::sort(sortedRecords.begin(), sortedRecords.end(), [](const auto& a, const auto& b) { return (a.second.totalTime > b.second.totalTime); });
+
+	const float invNumFrames = 1.0f / std::max(numFrames, 1u);
+
+	LOG("[LuaProfiler::%s] %u frames, %u call-ins, %u call-stacks (enabled=%d)", __func__, numFrames, unsigned(callInRecords.size()), unsigned(stackRecords.size()), enabled);
+
+	for (const auto& p: sortedRecords) {
+		const CallInRecord& r = p.second;
+
+		LOG("\t%-48s time/frame=%.3fms (peak=%.3fms) allocs/frame=%.1f calls=%d",
+			p.first.c_str(), r.totalTime * 1e-6f * invNumFrames, r.peakTime * 1e-6f,
+			r.totalAllocs * invNumFrames, int(r.numCalls)
+		);
+	}
+}
+
+bool CLuaProfiler::WriteCollapsedStacks(const std::string& fileName, bool allocCounts) const
+{
+	std::ofstream file(fileName, std::ios::out | std::ios::trunc);
+
+	if (!file.good())
+		return false;
+
+	// one "frame;frame;...;frame value" line per stack; values are
+	// self-times in microseconds or self-allocation counts so tools
+	// can sum callees into their callers
+	for (const auto& p: stackRecords) {
+		const StackRecord& r = p.second;
+		const std::int64_t v = allocCounts? r.selfAllocs: (r.selfTime / 1000);
+
+		if (v <= 0)
+			continue;
+
+		file << p.first << ' ' << v << '\n';
+	}
+
+	return file.good();
+}
+
+
+void CLuaProfiler::FunctionHook(lua_State* L, lua_Debug* ar)
+{
+	CLuaProfiler& p = luaProfiler;
+
+	if (p.callInFrames.empty() || !Threading::IsMainThread())
+		return;
+
+	switch (ar->event) {
+		case LUA_HOOKCALL: {
+			char frameName[512];
+
+			lua_getinfo(L, "Sn", ar);
+
+			if (ar->what[0] == 'C') {
+				SNPRINTF(frameName, sizeof(frameName), "%s [C]", (ar->name != nullptr)? ar->name: "?");
+			} else {
+				SNPRINTF(frameName, sizeof(frameName), "%s@%s:%d", (ar->name != nullptr)? ar->name: "?", ar->short_src, ar->linedefined);
+			}
+
+			// ';' separates frames in collapsed stacks
+			std::replace(frameName, frameName + sizeof(frameName), ';', ',');
+
+			p.PushFrame(L, frameName, "");
+		} break;
+		case LUA_HOOKRET:
+		case LUA_HOOKTAILRET: {
+			p.PopFrames(L);
+		} break;
+		default: {
+		} break;
+	}
+}
+
+
+void CLuaProfiler::PushFrame(lua_State* L, std::string&& name, std::string&& callInKey)
+{
+	StackFrame f;
+	f.state = L;
+	f.path = callStack.empty()? std::move(name): (callStack.back().path + ";" + name);
+	f.callInKey = std::move(callInKey);
+	f.startTime = spring_gettime();
+	f.startAllocs = GetNumLuaAllocs();
+	f.childTime = 0;
+	f.childAllocs = 0;
+
+	callStack.emplace_back(std::move(f));
+}
+
+void CLuaProfiler::PopFrame()
+{
+	const StackFrame& f = callStack.back();
+
+	const std::int64_t totalTime = (spring_gettime() - f.startTime).toNanoSecsi();
+	// the global allocation counter is periodically reset
+	const std::int64_t totalAllocs = std::max(GetNumLuaAllocs() - f.startAllocs, std::int64_t(0));
+
+	StackRecord& sr = stackRecords[f.path];
+
+	sr.selfTime += std::max(totalTime - f.childTime, std::int64_t(0));
+	sr.selfAllocs += std::max(totalAllocs - f.childAllocs, std::int64_t(0));
+	sr.numCalls += 1;
+
+	if (!f.callInKey.empty()) {
+		CallInRecord& cr = callInRecords[f.callInKey];
+
+		cr.frameTime += totalTime;
+		cr.frameAllocs += totalAllocs;
+		cr.numCalls += 1;
+	}
+
+	callStack.pop_back();
+
+	if (callStack.empty())
+		return;
+
+	callStack.back().childTime += totalTime;
+	callStack.back().childAllocs += totalAllocs;
+}
+
+void CLuaProfiler::PopFrames(lua_State* L)
+{
+	const size_t minIndex = callInFrames.back() + 1;
+
+	// pop up to and including the innermost frame called on L; returns
+	// from a resumed coroutine whose call was not seen are ignored
+	for (size_t i = callStack.size(); i > minIndex; i--) {
+		if (callStack[i - 1].state != L)
+			continue;
+
+		while (callStack.size() >= i)
+			PopFrame();
+
+		return;
+	}
+}
@@ -0,0 +1,91 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_PROFILER_H
+#define LUA_PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+#include "System/UnorderedMap.hpp"
+
+struct lua_State;
+struct lua_Debug;
+class CLuaHandle;
+
+// while enabled, records the wall-time and number of allocations of
+// every call-in run by a CLuaHandle and of every Lua (or C) function
+// called from it, keyed by collapsed call-stack ("LuaUI::DrawScreen;
+// DrawScreen@LuaUI/widgets.lua:1234;...") so the results can be fed
+// to flamegraph tools; call-in totals are additionally tracked per frame
+class CLuaProfiler {
+public:
+	struct StackRecord {
+		std::int64_t selfTime = 0; // ns, excluding callees
+		std::int64_t selfAllocs = 0;
+		std::int64_t numCalls = 0;
+	};
+
+	struct CallInRecord {
+		std::int64_t frameTime = 0; // ns, accumulated during the current frame
+		std::int64_t totalTime = 0;
+		std::int64_t peakTime = 0; // largest per-frame time
+
+		std::int64_t frameAllocs = 0;
+		std::int64_t totalAllocs = 0;
+		std::int64_t numCalls = 0;
+	};
+
+public:
+	void SetEnabled(bool b);
+	bool IsEnabled() const { return enabled; }
+
+	// called around the lua_pcall of each call-in; also (un)installs
+	// the function-hook on L depending on whether profiling is enabled
+	// LeaveCallIn must only be called if EnterCallIn returned true
+	bool EnterCallIn(lua_State* L, const CLuaHandle* handle, const char* callInName);
+	void LeaveCallIn(lua_State* L);
+
+	// closes the current frame, once per draw-frame
+	void Update();
+
+	void PrintStats() const;
+	bool WriteCollapsedStacks(const std::string& fileName, bool allocCounts) const;
+
+private:
+	static void FunctionHook(lua_State* L, lua_Debug* ar);
+
+	void PushFrame(lua_State* L, std::string&& name, std::string&& callInKey);
+	void PopFrame();
+	void PopFrames(lua_State* L);
+
+private:
+	struct StackFrame {
+		lua_State* state;
+
+		std::string path;
+		std::string callInKey; // empty for function frames
+
+		spring_time startTime;
+
+		std::int64_t startAllocs;
+		std::int64_t childTime;
+		std::int64_t childAllocs;
+	};
+
+	spring::unordered_map<std::string, StackRecord> stackRecords;
+	spring::unordered_map<std::string, CallInRecord> callInRecords;
+
+	std::vector<StackFrame> callStack;
+	// stack-index of each active (possibly nested) call-in frame
+	std::vector<size_t> callInFrames;
+
+	unsigned int numFrames = 0;
+
+	bool enabled = false;
+};
+
+extern CLuaProfiler luaProfiler;
+
+#endif
@@ -208,6 +208,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitRadius);
 	REGISTER_LUA_CFUNC(GetUnitMass);
 	REGISTER_LUA_CFUNC(GetUnitPosition);
+	REGISTER_LUA_CFUNC(GetUnitPositions);
 	REGISTER_LUA_CFUNC(GetUnitBasePosition);
 	REGISTER_LUA_CFUNC(GetUnitVectors);
 	REGISTER_LUA_CFUNC(GetUnitRotation);
@@ -1669,9 +1670,29 @@ int LuaSyncedRead::ArePlayersAllied(lua_State* L)
 //  Grouped Unit Queries
 //
 
+// pushes the table at <index> (emptied, to be refilled in place) if the caller
+// passed one, otherwise a new table; reusing a result-table between calls does
+// not allocate unless it has to grow, which keeps the Lua GC out of the loop
+static void PushResultTable(lua_State* L, int index, int numArrayElems)
+{
+	if (!lua_istable(L, index)) {
+		lua_createtable(L, numArrayElems, 0);
+		return;
+	}
+
+	lua_pushvalue(L, index);
+
+	// clear the array-part; setting existing slots to nil never shrinks it
+	for (int i = lua_objlen(L, -1); i > 0; i--) {
+		lua_pushnil(L);
+		lua_rawseti(L, -2, i);
+	}
+}
+
+
 int LuaSyncedRead::GetAllUnits(lua_State* L)
 {
-	lua_createtable(L, (unitHandler.GetActiveUnits()).size(), 0);
+	PushResultTable(L, 1, (unitHandler.GetActiveUnits()).size());
 
 	unsigned int unitCount = 1;
 	if (CLuaHandle::GetHandleFullRead(L)) {
@@ -2204,25 +2225,27 @@ int LuaSyncedRead::GetUnitsInRectangle(lua_State* L)
 	quadField.GetUnitsExact(qfQuery, mins, maxs);
 	const auto& units = (*qfQuery.units);
 
+	PushResultTable(L, 6, units.size());
+
 	if (allegiance >= 0) {
 		if (IsAlliedTeam(L, allegiance)) {
-			LOOP_UNIT_CONTAINER(SIMPLE_TEAM_TEST, RECTANGLE_TEST, true);
+			LOOP_UNIT_CONTAINER(SIMPLE_TEAM_TEST, RECTANGLE_TEST, false);
 		} else {
-			LOOP_UNIT_CONTAINER(VISIBLE_TEAM_TEST, RECTANGLE_TEST, true);
+			LOOP_UNIT_CONTAINER(VISIBLE_TEAM_TEST, RECTANGLE_TEST, false);
 		}
 	}
 	else if (allegiance == MyUnits) {
 		const int readTeam = CLuaHandle::GetHandleReadTeam(L);
-		LOOP_UNIT_CONTAINER(MY_UNIT_TEST, RECTANGLE_TEST, true);
+		LOOP_UNIT_CONTAINER(MY_UNIT_TEST, RECTANGLE_TEST, false);
 	}
 	else if (allegiance == AllyUnits) {
-		LOOP_UNIT_CONTAINER(ALLY_UNIT_TEST, RECTANGLE_TEST, true);
+		LOOP_UNIT_CONTAINER(ALLY_UNIT_TEST, RECTANGLE_TEST, false);
 	}
 	else if (allegiance == EnemyUnits) {
-		LOOP_UNIT_CONTAINER(ENEMY_UNIT_TEST, RECTANGLE_TEST, true);
+		LOOP_UNIT_CONTAINER(ENEMY_UNIT_TEST, RECTANGLE_TEST, false);
 	}
 	else { // AllUnits
-		LOOP_UNIT_CONTAINER(VISIBLE_TEST, RECTANGLE_TEST, true);
+		LOOP_UNIT_CONTAINER(VISIBLE_TEST, RECTANGLE_TEST, false);
 	}
 
 	return 1;
@@ -2303,25 +2326,27 @@ int LuaSyncedRead::GetUnitsInCylinder(lua_State* L)
 	quadField.GetUnitsExact(qfQuery, mins, maxs);
 	const auto& units = (*qfQuery.units);
 
+	PushResultTable(L, 5, units.size());
+
 	if (allegiance >= 0) {
 		if (IsAlliedTeam(L, allegiance)) {
-			LOOP_UNIT_CONTAINER(SIMPLE_TEAM_TEST, CYLINDER_TEST, true);
+			LOOP_UNIT_CONTAINER(SIMPLE_TEAM_TEST, CYLINDER_TEST, false);
 		} else {
-			LOOP_UNIT_CONTAINER(VISIBLE_TEAM_TEST, CYLINDER_TEST, true);
+			LOOP_UNIT_CONTAINER(VISIBLE_TEAM_TEST, CYLINDER_TEST, false);
 		}
 	}
 	else if (allegiance == MyUnits) {
 		const int readTeam = CLuaHandle::GetHandleReadTeam(L);
-		LOOP_UNIT_CONTAINER(MY_UNIT_TEST, CYLINDER_TEST, true);
+		LOOP_UNIT_CONTAINER(MY_UNIT_TEST, CYLINDER_TEST, false);
 	}
 	else if (allegiance == AllyUnits) {
-		LOOP_UNIT_CONTAINER(ALLY_UNIT_TEST, CYLINDER_TEST, true);
+		LOOP_UNIT_CONTAINER(ALLY_UNIT_TEST, CYLINDER_TEST, false);
 	}
 	else if (allegiance == EnemyUnits) {
-		LOOP_UNIT_CONTAINER(ENEMY_UNIT_TEST, CYLINDER_TEST, true);
+		LOOP_UNIT_CONTAINER(ENEMY_UNIT_TEST, CYLINDER_TEST, false);
 	}
 	else { // AllUnits
-		LOOP_UNIT_CONTAINER(VISIBLE_TEST, CYLINDER_TEST, true);
+		LOOP_UNIT_CONTAINER(VISIBLE_TEST, CYLINDER_TEST, false);
 	}
 
 	return 1;
@@ -3094,6 +3119,47 @@ int LuaSyncedRead::GetUnitPosition(lua_State* L)
 	return (GetSolidObjectPosition(L, ParseUnit(L, __func__, 1), false));
 }
 
+// bulk variant of GetUnitPosition: returns the base-positions of unitIDs[i]
+// as a flat array {x1, y1, z1, x2, y2, z2, ...}, with false entries for units
+// that do not exist or are not visible (so the array never has holes); fills
+// the optional table in place
+int LuaSyncedRead::GetUnitPositions(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	const int numUnitIDs = lua_objlen(L, 1);
+	const int readAllyTeam = CLuaHandle::GetHandleReadAllyTeam(L);
+	const bool fullRead = CLuaHandle::GetHandleFullRead(L);
+
+	PushResultTable(L, 2, numUnitIDs * 3);
+
+	for (int i = 1; i <= numUnitIDs; i++) {
+		lua_rawgeti(L, 1, i);
+
+		const CUnit* unit = lua_isnumber(L, -1)? unitHandler.GetUnit(lua_toint(L, -1)): nullptr;
+
+		lua_pop(L, 1);
+
+		if (unit == nullptr || !IsUnitVisible(L, unit)) {
+			lua_pushboolean(L, false); lua_rawseti(L, -2, i * 3 - 2);
+			lua_pushboolean(L, false); lua_rawseti(L, -2, i * 3 - 1);
+			lua_pushboolean(L, false); lua_rawseti(L, -2, i * 3    );
+			continue;
+		}
+
+		float3 errorVec;
+
+		if (!IsAllyUnit(L, unit))
+			errorVec = unit->GetLuaErrorVector(readAllyTeam, fullRead);
+
+		lua_pushnumber(L, unit->pos.x + errorVec.x); lua_rawseti(L, -2, i * 3 - 2);
+		lua_pushnumber(L, unit->pos.y + errorVec.y); lua_rawseti(L, -2, i * 3 - 1);
+		lua_pushnumber(L, unit->pos.z + errorVec.z); lua_rawseti(L, -2, i * 3    );
+	}
+
+	return 1;
+}
+
 int LuaSyncedRead::GetUnitBasePosition(lua_State* L)
 {
 	return (GetUnitPosition(L));
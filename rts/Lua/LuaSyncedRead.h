@@ -117,6 +117,7 @@ class LuaSyncedRead {
 		static int GetUnitRadius(lua_State* L);
 		static int GetUnitMass(lua_State* L);
 		static int GetUnitPosition(lua_State* L);
+		static int GetUnitPositions(lua_State* L);
 		static int GetUnitBasePosition(lua_State* L);
 		static int GetUnitVectors(lua_State* L);
 		static int GetUnitRotation(lua_State* L);
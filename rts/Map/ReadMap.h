@@ -196,6 +196,10 @@ public:
 	float GetCurrAvgHeight() const { return ((GetCurrMinHeight() + GetCurrMaxHeight()) * 0.5f); }
 	float GetBoundingRadius() const { return boundingRadius; }
 
+	/// incremented whenever the synced heightmap or anything derived from it
+	/// changes, so that cached terrain samples can be validated cheaply
+	unsigned int GetNumHeightMapChanges() const { return numHeightMapChanges; }
+
 	bool IsUnderWater() const { return (currHeightBounds.y <  0.0f); }
 	bool IsAboveWater() const { return (currHeightBounds.x >= 0.0f); }
 
@@ -272,6 +276,7 @@ private:
 #endif
 
 	unsigned int mapChecksum = 0;
+	unsigned int numHeightMapChanges = 0;
 
 	float2 initHeightBounds; //< initial minimum- and maximum-height (before any deformations)
 	float2 currHeightBounds; //< current minimum- and maximum-height
@@ -292,6 +297,8 @@ inline float CReadMap::SetHeight(const int idx, const float h, const int add) {
 	// add=1 <--> x = x*1 + h = x+h
 	x = x * add + h;
 
+	numHeightMapChanges += 1;
+
 	currHeightBounds.x = std::min(x, currHeightBounds.x);
 	currHeightBounds.y = std::max(x, currHeightBounds.y);
 
@@ -99,7 +99,10 @@ void SelectionWidget::ShowDemoList(const std::function<void(const std::string&)>
 	const std::string cwd = std::move(FileSystem::EnsurePathSepAtEnd(FileSystemAbstraction::GetCwd()));
 	const std::string dir = std::move(FileSystem::EnsurePathSepAtEnd("demos"));
 
-	const std::vector<std::string> demos(dataDirsAccess.FindFiles(cwd + dir, "*.sdfz", 0));
+	std::vector<std::string> demos(dataDirsAccess.FindFiles(cwd + dir, "*.sdfz", 0));
+	const std::vector<std::string> blockDemos(dataDirsAccess.FindFiles(cwd + dir, "*.sdfb", 0));
+
+	demos.insert(demos.end(), blockDemos.begin(), blockDemos.end());
 
 	// FIXME: names overflow the box
 	for (const std::string& demo: demos) {
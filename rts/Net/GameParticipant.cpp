@@ -18,6 +18,12 @@ void GameParticipant::SendData(std::shared_ptr<const netcode::RawPacket> packet)
 		clientLink->SendData(packet);
 }
 
+void GameParticipant::RelayData(std::shared_ptr<const netcode::RawPacket> packet, spring_time recvTime)
+{
+	if (clientLink != nullptr)
+		clientLink->RelayData(packet, recvTime);
+}
+
 void GameParticipant::Connected(std::shared_ptr<netcode::CConnection> _link, bool local)
 {
 	clientLink = _link;
@@ -22,6 +22,7 @@ public:
 	GameParticipant();
 
 	void SendData(std::shared_ptr<const netcode::RawPacket> packet);
+	void RelayData(std::shared_ptr<const netcode::RawPacket> packet, spring_time recvTime);
 	void Connected(std::shared_ptr<netcode::CConnection> link, bool local);
 	void Kill(const std::string& reason, const bool flush = false);
 
@@ -4,6 +4,7 @@
 #include "System/Net/UDPConnection.h"
 
 #include <functional>
+#include <limits>
 
 #if defined DEDICATED || defined DEBUG
 	#include <iostream>
@@ -67,6 +68,7 @@ using netcode::RawPacket;
 
 CONFIG(int, AutohostPort).defaultValue(0);
 CONFIG(int, ServerSleepTime).defaultValue(5).description("number of milliseconds to sleep per tick");
+CONFIG(bool, ServerWaitForNetData).defaultValue(true).description("Wake up as soon as network data arrives or the next frame is due rather than always sleeping ServerSleepTime milliseconds per tick.");
 CONFIG(int, SpeedControl).defaultValue(1).minimumValue(1).maximumValue(2)
 	.description("Sets how server adjusts speed according to player's load (CPU), 1: use average, 2: use highest");
 CONFIG(bool, AllowSpectatorJoin).defaultValue(true).description("allow any unauthenticated clients to join as spectator with any name, name will be prefixed with ~");
@@ -111,17 +113,17 @@ static constexpr unsigned syncResponseEchoInterval = GAME_SPEED * 2;
 
 
 //FIXME remodularize server commands, so they get registered in word completion etc.
-static const std::array<std::string, 23> SERVER_COMMANDS = {
+static const std::array<std::string, 24> SERVER_COMMANDS = {
 	"kick", "kickbynum",
 	"mute", "mutebynum",
 	"setminspeed", "setmaxspeed",
 	"nopause", "nohelp", "cheat", "godmode", "globallos",
 	"nocost", "forcestart", "nospectatorchat", "nospecdraw",
 	"skip", "reloadcob", "reloadcegs", "devlua", "editdefs",
-	"singlestep", "spec", "specbynum"
+	"singlestep", "spec", "specbynum", "relaylatency"
 };
 
-std::array<std::string, 23> CGameServer::commandBlacklist = SERVER_COMMANDS;
+std::array<std::string, 24> CGameServer::commandBlacklist = SERVER_COMMANDS;
 
 
 
@@ -168,6 +170,7 @@ CGameServer::CGameServer(
 , generatedGameID(false)
 , reloadingServer(false)
 , quitServer(false)
+, demoEnded(false)
 {
 	myClientSetup = newClientSetup;
 	myGameData = newGameData;
@@ -288,6 +291,7 @@ void CGameServer::Initialize()
 	}
 
 	loopSleepTime = configHandler->GetInt("ServerSleepTime");
+	waitForNetData = configHandler->GetBool("ServerWaitForNetData");
 	lastNewFrameTick = spring_gettime();
 	linkMinPacketSize = globalConfig.linkIncomingMaxPacketRate > 0 ? (globalConfig.linkIncomingSustainedBandwidth / globalConfig.linkIncomingMaxPacketRate) : 1;
 	lastBandwidthUpdate = spring_gettime();
@@ -430,7 +434,7 @@ void CGameServer::AddAutohostInterface(const std::string& autohostIP, const int
 }
 
 
-void CGameServer::SkipTo(int targetFrameNum)
+void CGameServer::SkipTo(int targetFrameNum, bool useKeyFrames)
 {
 	const bool wasPaused = isPaused;
 
@@ -442,7 +446,12 @@ void CGameServer::SkipTo(int targetFrameNum)
 	CommandMessage endMsg("skip end", SERVER_PLAYER);
 	Broadcast(std::shared_ptr<const netcode::RawPacket>(startMsg.Pack()));
 
-	// fast-read and send demo data
+	if (useKeyFrames && SkipToKeyFrame(targetFrameNum)) {
+		gameTime = GetDemoTime();
+		modGameTime = demoReader->GetModGameTime() + 0.001f;
+	}
+
+	// fast-read and send the remaining demo data
 	//
 	// note that we must maintain <modGameTime> ourselves
 	// since we do we NOT go through ::Update when skipping
@@ -467,6 +476,69 @@ void CGameServer::SkipTo(int targetFrameNum)
 	isPaused = wasPaused;
 }
 
+bool CGameServer::SkipToKeyFrame(int targetFrameNum)
+{
+	// keyframe states are only passed to an in-process client, any
+	// remote spectators would have nothing to continue simulating from
+	if (!HasLocalClient())
+		return false;
+
+	for (const GameParticipant& p: players) {
+		if (p.clientLink != nullptr && !p.isLocal)
+			return false;
+	}
+
+	const int keyFrameIdx = demoReader->FindKeyFrame(serverFrameNum, targetFrameNum);
+
+	if (keyFrameIdx < 0)
+		return false;
+
+	std::string keyFrameState;
+
+	if (!demoReader->GetKeyFrameState(keyFrameIdx, keyFrameState)) {
+		Message("Warning: Discarding unreadable keyframe in demo");
+		return false;
+	}
+
+	const int keyFrameNum = demoReader->GetKeyFrameNum(keyFrameIdx);
+	const int keyFrameOffset = demoReader->GetKeyFrameStreamOffset(keyFrameIdx);
+
+	netcode::RawPacket* buf = nullptr;
+
+	// everything up to the keyframe is contained in its state
+	while (demoReader->GetStreamOffset() < keyFrameOffset && (buf = demoReader->GetData(std::numeric_limits<float>::max())) != nullptr) {
+		ProcessDemoPacket(std::shared_ptr<const RawPacket>(buf), targetFrameNum, false);
+	}
+
+	if (serverFrameNum != keyFrameNum)
+		Message(spring::format("Warning: demo keyframe %d was read at frame %d", keyFrameNum, serverFrameNum));
+
+	serverFrameNum = keyFrameNum;
+
+	{
+		std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
+
+		demoKeyFrameState = std::move(keyFrameState);
+		demoKeyFrameNum = keyFrameNum;
+	}
+
+	CommandMessage keyFrameMsg(spring::format("skip keyframe %d", keyFrameNum), SERVER_PLAYER);
+	Broadcast(std::shared_ptr<const netcode::RawPacket>(keyFrameMsg.Pack()));
+	return true;
+}
+
+bool CGameServer::GetDemoKeyFrameState(int frameNum, std::string& state)
+{
+	std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
+
+	if (frameNum != demoKeyFrameNum)
+		return false;
+
+	state = std::move(demoKeyFrameState);
+	demoKeyFrameNum = -1;
+	return true;
+}
+
 std::string CGameServer::GetPlayerNames(const std::vector<int>& indices) const
 {
 	std::string playerstring;
@@ -479,90 +551,100 @@ std::string CGameServer::GetPlayerNames(const std::vector<int>& indices) const
 }
 
 
-bool CGameServer::SendDemoData(int targetFrameNum)
+void CGameServer::ProcessDemoPacket(std::shared_ptr<const RawPacket> rpkt, int targetFrameNum, bool sendFrames)
 {
-	bool ret = false;
-	netcode::RawPacket* buf = nullptr;
-
-	// if we reached EOS before, demoReader has become NULL
-	if (demoReader == nullptr)
-		return ret;
-
-	// get all packets from the stream up to <modGameTime>
-	while ((buf = demoReader->GetData(modGameTime))) {
-		std::shared_ptr<const RawPacket> rpkt(buf);
+	if (rpkt->length <= 0) {
+		Message("Warning: Discarding zero size packet in demo");
+		return;
+	}
 
-		if (buf->length <= 0) {
-			Message("Warning: Discarding zero size packet in demo");
-			continue;
-		}
+	const unsigned msgCode = rpkt->data[0];
 
-		const unsigned msgCode = buf->data[0];
+	switch (msgCode) {
+		case NETMSG_NEWFRAME:
+		case NETMSG_KEYFRAME: {
+			// we can't use CreateNewFrame() here
+			lastNewFrameTick = spring_gettime();
+			serverFrameNum++;
 
-		switch (msgCode) {
-			case NETMSG_NEWFRAME:
-			case NETMSG_KEYFRAME: {
-				// we can't use CreateNewFrame() here
-				lastNewFrameTick = spring_gettime();
-				serverFrameNum++;
+			if (!sendFrames)
+				break;
 
 #ifdef SYNCCHECK
-				if (targetFrameNum == -1) {
-					// not skipping
-					outstandingSyncFrames.insert(serverFrameNum);
-				}
-				CheckSync();
+			if (targetFrameNum == -1) {
+				// not skipping
+				outstandingSyncFrames.insert(serverFrameNum);
+			}
+			CheckSync();
 #endif
 
-				Broadcast(rpkt);
-				break;
+			Broadcast(rpkt);
+			break;
+		}
+
+		case NETMSG_CREATE_NEWPLAYER: {
+			try {
+				netcode::UnpackPacket pckt(rpkt, 3);
+				unsigned char spectator, team, playerNum;
+				std::string name;
+				pckt >> playerNum;
+				pckt >> spectator;
+				pckt >> team;
+				pckt >> name;
+				AddAdditionalUser(name, "", true, (bool)spectator, (int)team, playerNum); // even though this is a demo, keep the players vector properly updated
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Warning: Discarding invalid new player packet in demo: %s", ex.what()));
+				return;
 			}
 
-			case NETMSG_CREATE_NEWPLAYER: {
-				try {
-					netcode::UnpackPacket pckt(rpkt, 3);
-					unsigned char spectator, team, playerNum;
-					std::string name;
-					pckt >> playerNum;
-					pckt >> spectator;
-					pckt >> team;
-					pckt >> name;
-					AddAdditionalUser(name, "", true, (bool)spectator, (int)team, playerNum); // even though this is a demo, keep the players vector properly updated
-				} catch (const netcode::UnpackPacketException& ex) {
-					Message(spring::format("Warning: Discarding invalid new player packet in demo: %s", ex.what()));
-					continue;
-				}
+			Broadcast(rpkt);
+			break;
+		}
 
-				Broadcast(rpkt);
-				break;
+		case NETMSG_GAMEDATA:
+		case NETMSG_SETPLAYERNUM:
+		case NETMSG_USER_SPEED:
+		case NETMSG_INTERNAL_SPEED: {
+			// never send these from demos
+			break;
+		}
+		case NETMSG_CCOMMAND: {
+			try {
+				CommandMessage msg(rpkt);
+				const Action& action = msg.GetAction();
+				if (msg.GetPlayerID() == SERVER_PLAYER && action.command == "cheat")
+					InverseOrSetBool(cheating, action.extra);
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Warning: Discarding invalid command message packet in demo: %s", ex.what()));
+				return;
 			}
 
-			case NETMSG_GAMEDATA:
-			case NETMSG_SETPLAYERNUM:
-			case NETMSG_USER_SPEED:
-			case NETMSG_INTERNAL_SPEED: {
-				// never send these from demos
-				break;
-			}
-			case NETMSG_CCOMMAND: {
-				try {
-					CommandMessage msg(rpkt);
-					const Action& action = msg.GetAction();
-					if (msg.GetPlayerID() == SERVER_PLAYER && action.command == "cheat")
-						InverseOrSetBool(cheating, action.extra);
-				} catch (const netcode::UnpackPacketException& ex) {
-					Message(spring::format("Warning: Discarding invalid command message packet in demo: %s", ex.what()));
-					continue;
-				}
+			if (sendFrames)
 				Broadcast(rpkt);
-				break;
-			}
-			default: {
+			break;
+		}
+		default: {
+			// when reading up to a keyframe, their effects are part of its state
+			if (sendFrames)
 				Broadcast(rpkt);
-				break;
-			}
+			break;
 		}
 	}
+}
+
+bool CGameServer::SendDemoData(int targetFrameNum)
+{
+	bool ret = false;
+	netcode::RawPacket* buf = nullptr;
+
+	// if we reached EOS before, demoReader has become NULL
+	if (demoReader == nullptr)
+		return ret;
+
+	// get all packets from the stream up to <modGameTime>
+	while ((buf = demoReader->GetData(modGameTime))) {
+		ProcessDemoPacket(std::shared_ptr<const RawPacket>(buf), targetFrameNum, true);
+	}
 
 	if (targetFrameNum > 0) {
 		// skipping
@@ -571,6 +653,7 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 
 	if (demoReader->ReachedEnd()) {
 		demoReader.reset();
+		demoEnded = true;
 		Message(DemoEnd);
 		gameEndTime = spring_gettime();
 		ret = false;
@@ -582,7 +665,11 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 void CGameServer::Broadcast(std::shared_ptr<const netcode::RawPacket> packet)
 {
 	for (GameParticipant& p: players) {
-		p.SendData(packet);
+		if (spring_istime(relayRecvTime)) {
+			p.RelayData(packet, relayRecvTime);
+		} else {
+			p.SendData(packet);
+		}
 	}
 
 	if (canReconnect || allowSpecJoin || !gameHasStarted)
@@ -1894,6 +1981,7 @@ void CGameServer::HandleConnectionAttempts()
 			std::string platform;
 			uint8_t reconnect;
 			uint8_t netloss;
+			uint8_t frameBatching = 0;
 			uint16_t netversion;
 			msg >> netversion;
 			msg >> name;
@@ -1903,10 +1991,14 @@ void CGameServer::HandleConnectionAttempts()
 			msg >> reconnect;
 			msg >> netloss;
 
+			// absent in packets from clients predating it (same netversion)
+			if (msg.GetRemainingSize() > 0)
+				msg >> frameBatching;
+
 			if (netversion != NETWORK_VERSION)
 				throw netcode::UnpackPacketException(spring::format("Wrong network version: received %d, required %d", (int)netversion, (int)NETWORK_VERSION));
 
-			BindConnection(UDPNet->AcceptConnection(), name, passwd, version, platform, false, reconnect, netloss);
+			BindConnection(UDPNet->AcceptConnection(), name, passwd, version, platform, false, reconnect, netloss, frameBatching);
 		} catch (const netcode::UnpackPacketException& ex) {
 			const asio::ip::udp::endpoint endp = prev->GetEndpoint();
 			const asio::ip::address addr = endp.address();
@@ -2035,9 +2127,15 @@ void CGameServer::ServerReadNet()
 				if (bwLimitIsReached && droppablePacket)
 					continue;
 
+				// anything broadcast while handling a remote player's packet
+				// is relayed for it, see /relaylatency
+				relayRecvTime = player.isLocal? spring_notime: netReadTime;
+
 				// non-droppable packets may be processed more than once, but this does no harm
 				ProcessPacket(player.id, aiPacket);
 
+				relayRecvTime = spring_notime;
+
 				if (globalConfig.linkIncomingPeakBandwidth > 0 && droppablePacket) {
 					bandwidthUsage += std::max((unsigned)linkMinPacketSize, aiPacket->length);
 
@@ -2338,6 +2436,21 @@ void CGameServer::PushAction(const Action& action, bool fromAutoHost)
 	else if (action.command == "nopause") {
 		InverseOrSetBool(gamePausable, action.extra);
 	}
+	else if (action.command == "relaylatency") {
+		// report and reset the statistics gathered since the last call
+		for (GameParticipant& p: players) {
+			if (p.clientLink == nullptr)
+				continue;
+
+			const netcode::CConnection::RelayLatency& rl = p.clientLink->GetRelayLatency();
+
+			if (rl.numSamples == 0)
+				continue;
+
+			Message(spring::format("Relay latency to %s: avg=%.2fms max=%.2fms (%u samples)", p.name.c_str(), rl.sumTime / rl.numSamples, rl.maxTime, rl.numSamples), false);
+			p.clientLink->ResetRelayLatency();
+		}
+	}
 	else if (action.command == "nohelp") {
 		InverseOrSetBool(noHelperAIs, action.extra);
 		// sent it because clients have to do stuff when this changes
@@ -2389,6 +2502,8 @@ void CGameServer::PushAction(const Action& action, bool fromAutoHost)
 
 			// amount of frames/seconds to skip (to)
 			const int amount = atoi(timeStr.c_str());
+			// simulate every frame even when the demo has keyframes
+			const bool useKeyFrames = (timeStr.find(" nokeyframes") == std::string::npos);
 
 			// the absolute frame to skip to
 			int endFrame;
@@ -2401,7 +2516,7 @@ void CGameServer::PushAction(const Action& action, bool fromAutoHost)
 			if (skipRelative)
 				endFrame += serverFrameNum;
 
-			SkipTo(endFrame);
+			SkipTo(endFrame, useKeyFrames);
 		}
 	}
 	else if (action.command == "cheat") {
@@ -2637,8 +2752,18 @@ void CGameServer::UpdateLoop()
 		Threading::SetThreadName("netcode");
 		Threading::SetAffinity(~0);
 
+		spring_time netWaitTime = spring_msecs(loopSleepTime);
+
 		while (!quitServer) {
-			spring_msecs(loopSleepTime).sleep(true);
+			// with a socket to wait on, wake up as soon as data arrives or
+			// the next frame is due instead of sleeping for the full tick
+			if (UDPNet != nullptr && waitForNetData) {
+				UDPNet->WaitForData(netWaitTime);
+			} else {
+				spring_msecs(loopSleepTime).sleep(true);
+			}
+
+			netReadTime = spring_gettime();
 
 			if (UDPNet != nullptr)
 				UDPNet->Update();
@@ -2646,6 +2771,12 @@ void CGameServer::UpdateLoop()
 			std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
 			ServerReadNet();
 			Update();
+
+			// send out what was relayed now, not after the next wait
+			if (UDPNet != nullptr)
+				UDPNet->FlushConnections();
+
+			netWaitTime = GetNetWaitTime();
 		}
 
 		if (hostif != nullptr)
@@ -2672,6 +2803,23 @@ void CGameServer::UpdateLoop()
 }
 
 
+spring_time CGameServer::GetNetWaitTime() const
+{
+	const spring_time maxWaitTime = spring_msecs(loopSleepTime);
+
+	// frames are only created on a timer while the game runs
+	if (!gameHasStarted || isPaused || PreSimFrame() || demoReader != nullptr)
+		return maxWaitTime;
+
+	// CreateNewFrame leaves frameTimeLeft in (-1, 0] and
+	// adds a new frame as soon as it becomes positive again
+	const float frameTime = 1000.0f / (GAME_SPEED * internalSpeed);
+	const spring_time nextFrameTime = lastNewFrameTick + spring_msecs(-frameTimeLeft * frameTime);
+
+	return (std::max(spring_notime, std::min(nextFrameTime - spring_gettime(), maxWaitTime)));
+}
+
+
 void CGameServer::KickPlayer(const int playerNum)
 {
 	// only kick connected players
@@ -2797,7 +2945,8 @@ unsigned CGameServer::BindConnection(
 	const std::string& clientPlatform,
 	bool isLocal,
 	bool reconnect,
-	int netloss
+	int netloss,
+	bool frameBatching
 ) {
 	Message(spring::format("%s attempt from %s", (reconnect ? "Reconnection" : "Connection"), clientName.c_str()));
 	Message(spring::format(" -> Version: %s [%s]", clientVersion.c_str(), clientPlatform.c_str()));
@@ -2932,6 +3081,7 @@ unsigned CGameServer::BindConnection(
 
 		Message(spring::format(" -> Connection reestablished (id %i)", newPlayerNumber));
 		newPlayer.clientLink->SetLossFactor(netloss);
+		newPlayer.clientLink->SetFrameBatching(frameBatching);
 		newPlayer.clientLink->Flush(!gameHasStarted);
 		return newPlayerNumber;
 	}
@@ -2963,6 +3113,7 @@ unsigned CGameServer::BindConnection(
 	// new connection established
 	Message(spring::format(" -> Connection established (given id %i)", newPlayerNumber));
 	clientLink->SetLossFactor(netloss);
+	clientLink->SetFrameBatching(frameBatching);
 	clientLink->Flush(!gameHasStarted);
 	return newPlayerNumber;
 }
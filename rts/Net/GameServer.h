@@ -115,8 +115,13 @@ public:
 	const std::shared_ptr<const  CGameSetup> GetGameSetup() const { return myGameSetup; }
 
 	const std::unique_ptr<CDemoReader>& GetDemoReader() const { return demoReader; }
+	/// safe to call from any thread, unlike checking GetDemoReader() for null
+	bool HasDemoEnded() const { return demoEnded; }
 	const std::unique_ptr<CDemoRecorder>& GetDemoRecorder() const { return demoRecorder; }
 
+	/// hands the keyframe state announced by "skip keyframe <frameNum>" to the local client
+	bool GetDemoKeyFrameState(int frameNum, std::string& state);
+
 private:
 	/**
 	 * @brief relay chat messages to players / autohost
@@ -126,6 +131,9 @@ private:
 	/// Execute textual messages received from clients
 	void PushAction(const Action& action, bool fromAutoHost);
 
+	/// how long the server thread may wait for network data before it has to run Update again
+	spring_time GetNetWaitTime() const;
+
 	void StripGameSetupText(const GameData* const newGameData);
 
 	/**
@@ -152,7 +160,8 @@ private:
 		const std::string& clientPlatform,
 		bool isLocal,
 		bool reconnect = false,
-		int netloss = 0
+		int netloss = 0,
+		bool frameBatching = false
 	);
 
 	void CheckForGameStart(bool forced = false);
@@ -172,6 +181,7 @@ private:
 	void WriteDemoData();
 	/// read data from demo and send it to clients
 	bool SendDemoData(int targetFrameNum);
+	void ProcessDemoPacket(std::shared_ptr<const netcode::RawPacket> packet, int targetFrameNum, bool sendFrames);
 
 	void Broadcast(std::shared_ptr<const netcode::RawPacket> packet);
 
@@ -179,9 +189,17 @@ private:
 	 * @brief skip frames
 	 *
 	 * If you are watching a demo, this will push out all data until
-	 * targetFrame to all clients
+	 * targetFrame to all clients; frames before the last keyframe are
+	 * not sent (and not simulated) unless useKeyFrames is false
+	 */
+	void SkipTo(int targetFrameNum, bool useKeyFrames);
+	/**
+	 * @brief jump to the last demo keyframe before targetFrame
+	 *
+	 * Reads past all demo data up to the keyframe without sending its
+	 * frames, then tells the (local) client to load the keyframe state.
 	 */
-	void SkipTo(int targetFrameNum);
+	bool SkipToKeyFrame(int targetFrameNum);
 
 	void Message(const std::string& message, bool broadcast = true, bool internal = false);
 	void PrivateMessage(int playerNum, const std::string& message);
@@ -206,6 +224,11 @@ private:
 	spring_time lastUpdate;
 	spring_time lastBandwidthUpdate;
 
+	/// when the server thread last read the socket
+	spring_time netReadTime;
+	/// set while handling a remote player's packet, see Broadcast
+	spring_time relayRecvTime;
+
 	float modGameTime;
 	float gameTime;
 	float startTime;
@@ -240,6 +263,8 @@ private:
 	int curSpeedCtrl;
 	int loopSleepTime;
 
+	bool waitForNetData;
+
 	/// The maximum speed users are allowed to set
 	float maxUserSpeed;
 	/// The minimum speed users are allowed to set (actual speed can be lower due to high cpu usage)
@@ -264,6 +289,10 @@ private:
 	int syncErrorFrame;
 	int syncWarningFrame;
 
+	// state of the keyframe the local client was told to load
+	std::string demoKeyFrameState;
+	int demoKeyFrameNum = -1;
+
 	///////////////// internal stuff //////////////////
 	void InternalSpeedChange(float newSpeed);
 	void UserSpeedChange(float newSpeed, int player);
@@ -275,7 +304,7 @@ private:
 	unsigned localClientNumber;
 
 	/// If the server receives a command, it will forward it to clients if it is not in this set
-	static std::array<std::string, 23> commandBlacklist;
+	static std::array<std::string, 24> commandBlacklist;
 
 	std::unique_ptr<netcode::UDPListener> UDPNet;
 	std::unique_ptr<CDemoReader> demoReader;
@@ -291,6 +320,7 @@ private:
 	std::atomic<bool> generatedGameID;
 	std::atomic<bool> reloadingServer;
 	std::atomic<bool> quitServer;
+	std::atomic<bool> demoEnded;
 
 	int linkMinPacketSize;
 
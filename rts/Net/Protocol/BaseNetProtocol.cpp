@@ -239,12 +239,14 @@ PacketType CBaseNetProtocol::SendAttemptConnect(
 	const std::string& version,
 	const std::string& platform,
 	int32_t netloss,
-	bool reconnect
+	bool reconnect,
+	bool frameBatching
 ) {
 	const uint32_t payloadSize =
 		sizeof(NETWORK_VERSION) +
 		sizeof(static_cast<uint8_t>(netloss)) +
 		sizeof(static_cast<uint8_t>(reconnect)) +
+		sizeof(static_cast<uint8_t>(frameBatching)) +
 		(name.size() + 1) +
 		(passwd.size() + 1) +
 		(version.size() + 1) +
@@ -261,6 +263,7 @@ PacketType CBaseNetProtocol::SendAttemptConnect(
 	*packet << platform;
 	*packet << uint8_t(reconnect);
 	*packet << uint8_t(netloss);
+	*packet << uint8_t(frameBatching);
 
 	return PacketType(packet);
 }
@@ -542,6 +545,39 @@ PacketType CBaseNetProtocol::SendPing(uint8_t playerNum, uint8_t pingTag, float
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendFrameBatch(uint32_t numFrames, int32_t firstKeyFrameNum, const std::vector<uint32_t>& keyFrameIndices)
+{
+	uint32_t payloadSize = PackPacket::GetVarIntSize(numFrames) + PackPacket::GetVarIntSize(keyFrameIndices.size());
+
+	if (!keyFrameIndices.empty())
+		payloadSize += PackPacket::GetVarIntSize(firstKeyFrameNum);
+
+	// keyframe positions are delta-coded, usually one byte each
+	for (size_t i = 0, n = keyFrameIndices.size(); i < n; i++) {
+		payloadSize += PackPacket::GetVarIntSize(keyFrameIndices[i] - ((i > 0)? keyFrameIndices[i - 1]: 0));
+	}
+
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint8_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	assert(packetSize <= 0xFF);
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_FRAMEBATCH);
+	*packet << static_cast<uint8_t>(packetSize);
+
+	packet->PackVarInt(numFrames);
+	packet->PackVarInt(keyFrameIndices.size());
+
+	if (!keyFrameIndices.empty())
+		packet->PackVarInt(firstKeyFrameNum);
+
+	for (size_t i = 0, n = keyFrameIndices.size(); i < n; i++) {
+		packet->PackVarInt(keyFrameIndices[i] - ((i > 0)? keyFrameIndices[i - 1]: 0));
+	}
+
+	return PacketType(packet);
+}
+
 
 PacketType CBaseNetProtocol::SendClientData(uint8_t playerNum, const std::vector<uint8_t>& data)
 {
@@ -665,6 +701,7 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_AI_STATE_CHANGED, 4);
 	proto->AddType(NETMSG_GAME_FRAME_PROGRESS, 5);
 	proto->AddType(NETMSG_PING, 1 + (1 + 1 + 4));
+	proto->AddType(NETMSG_FRAMEBATCH, -1);
 
 #ifdef SYNCDEBUG
 	proto->AddType(NETMSG_SD_CHKREQUEST, 5);
@@ -77,7 +77,7 @@ enum NETMSG {
 	NETMSG_TEAMSTAT         = 60, // uint8_t teamNum, struct TeamStatistics statistics      # used by LadderBot #
 	NETMSG_CLIENTDATA       = 61, // uint16_t messageSize, std::string setupText
 
-	NETMSG_ATTEMPTCONNECT   = 65, // uint16_t msgsize, uint16_t netversion, string playername, string passwd, string VERSION_STRING_DETAILED
+	NETMSG_ATTEMPTCONNECT   = 65, // uint16_t msgsize, uint16_t netversion, string playername, string passwd, string VERSION_STRING_DETAILED, string platform, uint8_t reconnect, netloss, [frameBatching]
 	NETMSG_REJECT_CONNECT   = 66, // string reason
 
 	NETMSG_AI_CREATED       = 70, // /* uint8_t messageSize */, uint8_t playerNum, uint8_t whichSkirmishAI, uint8_t team, std::string name (ends with \0)
@@ -93,6 +93,9 @@ enum NETMSG {
 
 	NETMSG_PING = 78, // uint8_t playerNum, uint8_t pingTag, float localTime
 
+	NETMSG_FRAMEBATCH = 79, // uint8_t messageSize; varint numFrames, numKeyFrames; if numKeyFrames > 0: varint firstKeyFrameNum, varint keyFrameIndexDeltas[numKeyFrames]
+	                        // # consecutive NETMSG_{NEW,KEY}FRAME's coalesced by the sending UDPConnection (if negotiated via NETMSG_ATTEMPTCONNECT), expanded again by the receiving one #
+
 	NETMSG_LAST //max types of netmessages, internal only
 };
 
@@ -46,9 +46,14 @@ void CNetProtocol::InitClient(std::shared_ptr<ClientSetup> clientSetup, const st
 	userName = clientSetup->myPlayerName;
 	userPasswd = clientSetup->myPasswd;
 
-	serverConn.reset(new netcode::UDPConnection(configHandler->GetInt("SourcePort"), clientSetup->hostIP, clientSetup->hostPort));
+	netcode::UDPConnection* udpConn = new netcode::UDPConnection(configHandler->GetInt("SourcePort"), clientSetup->hostIP, clientSetup->hostPort);
+
+	// the server only sends frame-batches if asked to below
+	udpConn->SetFrameBatchExpansion(globalConfig.useNetFrameBatching);
+
+	serverConn.reset(udpConn);
 	serverConn->Unmute();
-	serverConn->SendData(CBaseNetProtocol::Get().SendAttemptConnect(userName, userPasswd, clientVersion, clientPlatform, globalConfig.networkLossFactor));
+	serverConn->SendData(CBaseNetProtocol::Get().SendAttemptConnect(userName, userPasswd, clientVersion, clientPlatform, globalConfig.networkLossFactor, false, globalConfig.useNetFrameBatching));
 	serverConn->Flush(true);
 
 	LOG("[NetProto::%s] connecting to IP %s on port %i using name %s", __func__, clientSetup->hostIP.c_str(), clientSetup->hostPort, userName.c_str());
@@ -68,7 +73,7 @@ void CNetProtocol::AttemptReconnect(const std::string& myVersion, const std::str
 	netcode::UDPConnection conn(*serverConn);
 
 	conn.Unmute();
-	conn.SendData(CBaseNetProtocol::Get().SendAttemptConnect(userName, userPasswd, myVersion, myPlatform, globalConfig.networkLossFactor, true));
+	conn.SendData(CBaseNetProtocol::Get().SendAttemptConnect(userName, userPasswd, myVersion, myPlatform, globalConfig.networkLossFactor, true, globalConfig.useNetFrameBatching));
 	conn.Flush(true);
 
 	LOG("[NetProto::%s] reconnecting to server... %ds", __func__, dynamic_cast<netcode::UDPConnection&>(*serverConn).GetReconnectSecs());
@@ -958,7 +958,19 @@ void CGroundDecalHandler::ForceRemoveSolidObject(CSolidObject* object)
 
 
 
-void CGroundDecalHandler::UnitMoved(const CUnit* unit) { AddDecal(const_cast<CUnit*>(unit), unit->pos); }
+void CGroundDecalHandler::UnitMovedBatch(const std::vector<SUnitMovedEvent>& events)
+{
+	for (const SUnitMovedEvent& e: events) {
+		CUnit* unit = unitHandler.GetUnit(e.unitID);
+
+		// killed later during the frame the batch was collected in; not
+		// yet deleted though, that would have dropped the unit's events
+		if (unit == nullptr || unit->isDead)
+			continue;
+
+		AddDecal(unit, e.pos);
+	}
+}
 
 void CGroundDecalHandler::GhostDestroyed(GhostSolidObject* gb) {
 	if (gb->decal == nullptr)
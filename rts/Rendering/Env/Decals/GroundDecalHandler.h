@@ -114,7 +114,7 @@ public:
 			(eventName == "SunChanged") ||
 			(eventName == "RenderUnitCreated") ||
 			(eventName == "RenderUnitDestroyed") ||
-			(eventName == "UnitMoved") ||
+			(eventName == "UnitMovedBatch") ||
 			(eventName == "RenderFeatureCreated") ||
 			(eventName == "RenderFeatureDestroyed") ||
 			(eventName == "FeatureMoved") ||
@@ -130,7 +130,7 @@ public:
 	void RenderFeatureCreated(const CFeature* feature) override;
 	void RenderFeatureDestroyed(const CFeature* feature) override;
 	void FeatureMoved(const CFeature* feature, const float3& oldpos) override;
-	void UnitMoved(const CUnit* unit) override;
+	void UnitMovedBatch(const std::vector<SUnitMovedEvent>& events) override;
 	void UnitLoaded(const CUnit* unit, const CUnit* transport) override;
 	void UnitUnloaded(const CUnit* unit, const CUnit* transport) override;
 
@@ -7,6 +7,7 @@
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/ModInfo.h"
+#include "Game/GlobalUnsynced.h"
 #include "Map/ReadMap.h"
 #include "System/Log/ILog.h"
 #include "System/Sync/HsiehHash.h"
@@ -16,6 +17,8 @@
 #include "System/TimeProfiler.h"
 #include "System/Threading/ThreadPool.h"
 
+#include <limits>
+
 #define USE_STAGGERED_UPDATES 0
 
 
@@ -41,7 +44,8 @@ CR_REG_METADATA(CLosHandler,(
 	CR_MEMBER(baseRadarErrorSize),
 	CR_MEMBER(baseRadarErrorMult),
 	CR_MEMBER(radarErrorSizes),
-	CR_IGNORED(losTypes)
+	CR_IGNORED(losTypes),
+	CR_IGNORED(updateStats)
 ))
 
 
@@ -122,6 +126,13 @@ void ILosType::Kill()
 	losAdd.clear();
 	losDeleted.clear();
 	losRecalc.clear();
+	losNew.clear();
+	losDiff.clear();
+
+	removedInstances.clear();
+
+	numDiffUpdates = 0;
+	numFullUpdates = 0;
 
 	// mark as invalid
 	size = {0, 0};
@@ -474,6 +485,70 @@ inline int ILosType::GetHashNum(const int allyteam, const int2 baseLos, const fl
 }
 
 
+void ILosType::PairMovedInstances()
+{
+	losDiff.clear();
+	removedInstances.clear();
+
+	// losDeleted holds exactly the instances whose sight is removed for good
+	for (SLosInstance* li: losDeleted) {
+		removedInstances.emplace(GetHashNum(li->allyteam, li->basePos, li->radius), li);
+	}
+
+	if (removedInstances.empty())
+		return;
+
+	// a unit that moved into a neighbouring square drops its old instance and
+	// gets a new one with the same radius and allyteam; the sight-areas of
+	// both mostly overlap so only the squares they differ in need updating
+	for (SLosInstance* li: losNew) {
+		for (int dz = -1; dz <= 1; dz++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				const int2 pos = li->basePos + int2(dx, dz);
+				const auto it = removedInstances.find(GetHashNum(li->allyteam, pos, li->radius));
+
+				if (it == removedInstances.end())
+					continue;
+
+				SLosInstance* ri = it->second;
+
+				if (ri->allyteam != li->allyteam || ri->radius != li->radius || ri->basePos != pos)
+					continue;
+
+				removedInstances.erase(it);
+
+				ri->isDiffUpdated = true;
+				li->isDiffUpdated = true;
+
+				losDiff.emplace_back(ri, li);
+				dz = 2;
+				break;
+			}
+		}
+	}
+}
+
+
+template<typename F>
+void ILosType::ForEachAllyTeam(F&& func)
+{
+	// allyteams have independent maps, so their updates can run in parallel
+	// unless ReadMap has to be notified about squares entering LOS for more
+	// than one allyteam (which happens on the caller's thread only)
+	if (type == LOS_TYPE_LOS && gu->spectatingFullView) {
+		for (size_t allyTeam = 0; allyTeam < losMaps.size(); allyTeam++) {
+			func(allyTeam);
+		}
+
+		return;
+	}
+
+	for_mt(0, losMaps.size(), [&](const int allyTeam) {
+		func(allyTeam);
+	});
+}
+
+
 void ILosType::Update()
 {
 	// delayed delete
@@ -507,6 +582,8 @@ void ILosType::Update()
 	if (algoType == LOS_ALGO_RAYCAST) {
 		losRecalc.clear();
 		losRecalc.reserve(losUpdate.size());
+		losNew.clear();
+		losNew.reserve(losUpdate.size());
 	}
 
 	// filter the updates into their subparts
@@ -517,6 +594,7 @@ void ILosType::Update()
 		switch (status) {
 			case SLosInstance::TLosStatus::NEW: {
 				if (algoType == LOS_ALGO_RAYCAST) losRecalc.push_back(li);
+				if (algoType == LOS_ALGO_RAYCAST) losNew.push_back(li);
 				losAdd.push_back(li);
 			} break;
 			case SLosInstance::TLosStatus::REACTIVATE: {
@@ -545,11 +623,23 @@ void ILosType::Update()
 		}
 	}
 
-	// remove sight
-	//FIXME multithread?
-	for (SLosInstance* li: losRemove) {
-		LosRemove(li);
-	}
+	// pair instances left behind by moving units with the ones they entered;
+	// these are not removed here but diff-updated after raycasting instead
+	if (algoType == LOS_ALGO_RAYCAST)
+		PairMovedInstances();
+
+	// remove sight; must happen before raycasting (which clears the squares
+	// of RECALC instances)
+	ForEachAllyTeam([&](const int allyTeam) {
+		for (SLosInstance* li: losRemove) {
+			if (li->allyteam != allyTeam)
+				continue;
+			if (li->isDiffUpdated)
+				continue;
+
+			LosRemove(li);
+		}
+	});
 
 	// raycast terrain
 	if (algoType == LOS_ALGO_RAYCAST)  {
@@ -562,11 +652,34 @@ void ILosType::Update()
 	}
 
 	// add sight
-	for (SLosInstance* li: losAdd) {
-		assert(li->refCount > 0);
-		LosAdd(li);
+	ForEachAllyTeam([&](const int allyTeam) {
+		for (SLosInstance* li: losAdd) {
+			assert(li->refCount > 0);
+
+			if (li->allyteam != allyTeam)
+				continue;
+			if (li->isDiffUpdated)
+				continue;
+
+			LosAdd(li);
+		}
+
+		for (const auto& p: losDiff) {
+			if (p.second->allyteam != allyTeam)
+				continue;
+
+			losMaps[allyTeam].AddRaycastDiff(p.first, p.second);
+		}
+	});
+
+	for (const auto& p: losDiff) {
+		p.first->isDiffUpdated = false;
+		p.second->isDiffUpdated = false;
 	}
 
+	numDiffUpdates += losDiff.size();
+	numFullUpdates += (losAdd.size() - losDiff.size());
+
 	// delete / move to cache unused instances
 	if (algoType == LOS_ALGO_RAYCAST) {
 		while (!losCache.empty() && ((losCache.size() + losDeleted.size()) > CACHE_SIZE)) {
@@ -705,11 +818,15 @@ void CLosHandler::Init()
 	losTypes[5] = &jammer;
 	losTypes[6] = &sonarJammer;
 
+	updateStats.fill({0.0f, 0u});
+
 	eventHandler.AddClient(this);
 }
 
 void CLosHandler::Kill()
 {
+	PrintUpdateStats();
+
 	los.Kill();
 	airLos.Kill();
 	radar.Kill();
@@ -781,6 +898,7 @@ void CLosHandler::Update()
 	SCOPED_TIMER("Sim::Los");
 
 	const std::vector<CUnit*>& activeUnits = unitHandler.GetActiveUnits();
+	const spring_time t0 = spring_gettime();
 
 	#if (USE_STAGGERED_UPDATES == 1)
 	const size_t losBatchRate = UNIT_SLOWUPDATE_RATE;
@@ -807,6 +925,39 @@ void CLosHandler::Update()
 
 		lt->Update();
 	});
+
+	auto& bucket = updateStats[std::min(activeUnits.size() / UPDATE_STATS_BUCKET_SIZE, updateStats.size() - 1)];
+	bucket.first += (spring_gettime() - t0).toMilliSecsf();
+	bucket.second += 1;
+}
+
+
+void CLosHandler::PrintUpdateStats() const
+{
+	const ILosType* lts[] = {&los, &airLos, &radar, &sonar, &seismic, &jammer, &sonarJammer};
+	const char* names[] = {"los", "airLos", "radar", "sonar", "seismic", "jammer", "sonarJammer"};
+
+	for (size_t n = 0; n < updateStats.size(); n++) {
+		if (updateStats[n].second == 0)
+			continue;
+
+		const size_t minUnits = n * UPDATE_STATS_BUCKET_SIZE;
+		const size_t maxUnits = (n == (updateStats.size() - 1))? std::numeric_limits<int>::max(): (minUnits + UPDATE_STATS_BUCKET_SIZE - 1);
+
+		LOG("[LosHandler::%s] units=[%u,%u] frames=%u avgUpdateTime=%.3fms",
+			__func__, unsigned(minUnits), unsigned(maxUnits), updateStats[n].second,
+			updateStats[n].first / updateStats[n].second
+		);
+	}
+
+	for (size_t n = 0; n < (sizeof(lts) / sizeof(lts[0])); n++) {
+		if ((lts[n]->numDiffUpdates + lts[n]->numFullUpdates) == 0)
+			continue;
+
+		LOG("[LosHandler::%s] %s instance-updates={diff,full}={%u,%u}",
+			__func__, names[n], unsigned(lts[n]->numDiffUpdates), unsigned(lts[n]->numFullUpdates)
+		);
+	}
 }
 
 
@@ -48,6 +48,7 @@ struct SLosInstance
 		, isCached(false)
 		, isQueuedForUpdate(false)
 		, isQueuedForTerraform(false)
+		, isDiffUpdated(false)
 	{}
 	void Init(int radius, int allyteam, int2 basePos, float baseHeight, int hashNum);
 
@@ -79,6 +80,7 @@ public:
 	bool isCached;
 	bool isQueuedForUpdate;
 	bool isQueuedForTerraform;
+	bool isDiffUpdated;
 };
 
 
@@ -150,6 +152,10 @@ private:
 	SLosInstance* CreateInstance();
 	void DeleteInstance(SLosInstance* instance);
 
+	void PairMovedInstances();
+
+	template<typename F> void ForEachAllyTeam(F&& func);
+
 private:
 	int GetHashNum(const int allyteam, const int2 baseLos, const float radius) const;
 
@@ -170,6 +176,10 @@ public:
 	static size_t cacheHits;
 	static size_t cacheRefs;
 
+	// number of instances {diff-updated against a removed instance, fully added}
+	size_t numDiffUpdates = 0;
+	size_t numFullUpdates = 0;
+
 	spring::unordered_map<int, std::vector<SLosInstance*> > instanceHashes;
 
 	std::vector<CLosMap> losMaps;
@@ -191,6 +201,11 @@ private:
 	std::vector<SLosInstance*> losAdd;
 	std::vector<SLosInstance*> losDeleted;
 	std::vector<SLosInstance*> losRecalc;
+	std::vector<SLosInstance*> losNew;
+
+	// instances left behind by moving units, paired with the ones they entered
+	std::vector< std::pair<SLosInstance*, SLosInstance*> > losDiff;
+	spring::unordered_map<int, SLosInstance*> removedInstances;
 
 	static constexpr int CACHE_SIZE = 4096;
 };
@@ -294,6 +309,9 @@ public:
 	void Update() override;
 	void UpdateHeightMapSynced(SRectangle rect);
 
+	// prints average Update cost per frame as a function of unit-count
+	void PrintUpdateStats() const;
+
 public:
 	/**
 	* @brief global line-of-sight
@@ -320,6 +338,11 @@ private:
 
 	std::vector<float> radarErrorSizes;
 	std::array<ILosType*, 7> losTypes;
+
+	static constexpr size_t UPDATE_STATS_BUCKET_SIZE = 250;
+
+	// {accumulated time (ms), number of frames} per unit-count bucket
+	std::array<std::pair<float, unsigned int>, 32> updateStats;
 };
 
 
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <array>
+#include <limits>
 
 #include "LosMap.h"
 #include "LosHandler.h"
@@ -467,6 +468,90 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 }
 
 
+size_t CLosMap::AddRaycastDiff(const SLosInstance* remInstance, const SLosInstance* addInstance)
+{
+	const auto& remSquares = remInstance->squares;
+	const auto& addSquares = addInstance->squares;
+
+#ifdef USE_UNSYNCED_HEIGHTMAP
+	const bool visibleInstanceSquares = (addInstance->allyteam >= 0 && (addInstance->allyteam == gu->myAllyTeam || gu->spectatingFullView));
+	const bool updateUnsyncedHeightMap = sendReadmapEvents && visibleInstanceSquares;
+#endif
+
+	const auto AddRange = [&](int idx, int end, int amount) {
+		for (; idx < end; ++idx) {
+			losmap[idx] += amount;
+
+		#ifdef USE_UNSYNCED_HEIGHTMAP
+			// inform ReadMap when squares enter LoS
+			if (amount < 0 || !updateUnsyncedHeightMap || losmap[idx] != amount)
+				continue;
+
+			const int2 lm = IdxToCoord(idx, size.x);
+			const int2 p1 = (lm             ) * LOS2HEIGHT;
+			const int2 p2 = (lm + int2(1, 1)) * LOS2HEIGHT;
+			const int2 p3 = {std::min(p2.x, mapDims.mapxm1), std::min(p2.y, mapDims.mapym1)};
+
+			readMap->UpdateLOS(SRectangle(p1.x, p1.y,  p3.x, p3.y));
+		#endif
+		}
+	};
+
+	constexpr int END = std::numeric_limits<int>::max();
+
+	// both RLE lists are sorted by start and non-overlapping, so a
+	// single merge-pass finds the squares covered by only one of them
+	size_t remIdx = 0, addIdx = 0;
+	size_t numChanged = 0;
+
+	int remBeg = END, remEnd = END;
+	int addBeg = END, addEnd = END;
+
+	const auto NextRLE = [](const std::vector<SLosInstance::RLE>& rles, size_t& idx, int& beg, int& end) {
+		while (idx < rles.size() && rles[idx].length == 0)
+			idx++;
+
+		if (idx < rles.size()) {
+			beg = rles[idx].start;
+			end = rles[idx].start + rles[idx].length;
+			idx++;
+			return;
+		}
+
+		beg = END;
+		end = END;
+	};
+
+	NextRLE(remSquares, remIdx, remBeg, remEnd);
+	NextRLE(addSquares, addIdx, addBeg, addEnd);
+
+	while (remBeg != END || addBeg != END) {
+		if (remBeg < addBeg) {
+			const int end = std::min(remEnd, addBeg);
+			AddRange(remBeg, end, -1);
+			numChanged += (end - remBeg);
+			remBeg = end;
+		} else if (addBeg < remBeg) {
+			const int end = std::min(addEnd, remBeg);
+			AddRange(addBeg, end, 1);
+			numChanged += (end - addBeg);
+			addBeg = end;
+		} else {
+			// overlap, count stays unchanged
+			remBeg = std::min(remEnd, addEnd);
+			addBeg = remBeg;
+		}
+
+		if (remBeg == remEnd)
+			NextRLE(remSquares, remIdx, remBeg, remEnd);
+		if (addBeg == addEnd)
+			NextRLE(addSquares, addIdx, addBeg, addEnd);
+	}
+
+	return numChanged;
+}
+
+
 void CLosMap::PrepareRaycast(SLosInstance* instance) const
 {
 	if (!instance->squares.empty())
@@ -43,6 +43,11 @@ public:
 	/// arbitrary area, for losMap, non-circular radar maps, ...
 	void PrepareRaycast(SLosInstance* instance) const;
 
+	/// equivalent to AddRaycast(remInstance, -1) + AddRaycast(addInstance, 1)
+	/// but only touches the squares in which both instances differ; returns
+	/// the number of squares that were changed
+	size_t AddRaycastDiff(const SLosInstance* remInstance, const SLosInstance* addInstance);
+
 public:
 	int At(int2 p) const {
 		p.x = Clamp(p.x, 0, size.x - 1);
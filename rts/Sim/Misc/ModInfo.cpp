@@ -94,6 +94,9 @@ void CModInfo::ResetState()
 		pathFinderSystem = NOPFS_TYPE;
 		pfRawDistMult    = 1.25f;
 		pfUpdateRate     = 0.007f;
+		pfAsyncRequests  = false;
+
+		quadFieldMaxOccupancy = 0;
 
 		allowTake = true;
 	}
@@ -133,6 +136,9 @@ void CModInfo::Init(const std::string& modFileName)
 		pathFinderSystem = Clamp(system.GetInt("pathFinderSystem", HAPFS_TYPE), int(NOPFS_TYPE), int(QTPFS_TYPE));
 		pfRawDistMult = system.GetFloat("pathFinderRawDistMult", pfRawDistMult);
 		pfUpdateRate = system.GetFloat("pathFinderUpdateRate", pfUpdateRate);
+		pfAsyncRequests = system.GetBool("pathFinderAsyncRequests", pfAsyncRequests);
+
+		quadFieldMaxOccupancy = std::max(0, system.GetInt("quadFieldMaxOccupancy", quadFieldMaxOccupancy));
 
 		allowTake = system.GetBool("allowTake", allowTake);
 	}
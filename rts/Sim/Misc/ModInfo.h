@@ -159,6 +159,13 @@ public:
 
 	float pfRawDistMult;
 	float pfUpdateRate;
+	/// if true, synced unit path-requests (default PFS) are queued and
+	/// resolved as a batch at the start of the next PathManager update
+	bool pfAsyncRequests;
+
+	/// average number of objects per (non-empty) QuadField quad above which
+	/// the quad size is decreased during the game; 0 keeps it fixed
+	int quadFieldMaxOccupancy;
 
 	bool allowTake;
 };
@@ -7,8 +7,11 @@
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "System/ContainerUtil.h"
+#include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 
 #ifndef UNIT_TEST
 	#include "Sim/Features/Feature.h"
@@ -29,7 +32,9 @@ CR_REG_METADATA(CQuadField, (
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
 	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(tempQuads),
+	CR_IGNORED(tempProjectileQuads),
+	CR_IGNORED(occupancyStats)
 ))
 
 CR_BIND(CQuadField::Quad, )
@@ -48,49 +53,215 @@ CQuadField quadField;
 
 
 #ifndef UNIT_TEST
+// per-thread scratch space for RemoveQueryDuplicates
+static std::array<std::vector< std::pair<const void*, size_t> >, ThreadPool::MAX_THREADS> QUERY_DEDUP_TABLES;
+
+
 /*
-void CQuadField::Resize(int quad_size)
+ * objects' tempNum (and the counter in gs) may only be written by the main
+ * thread, queries issued from ThreadPool workers skip the tempNum check and
+ * remove duplicates (objects overlapping multiple quads) once they are done
+ */
+static int GetQueryTempNum() {
+	if (ThreadPool::GetThreadNum() != 0)
+		return -1;
+
+	return gs->GetTempNum();
+}
+
+template<typename T>
+static bool VisitedByQuery(T* object, const int tempNum) {
+	if (tempNum < 0)
+		return false;
+
+	if (object->tempNum == tempNum)
+		return true;
+
+	object->tempNum = tempNum;
+	return false;
+}
+
+template<typename T>
+static void RemoveQueryDuplicates(std::vector<T*>& objects, const size_t first, const int tempNum) {
+	if (tempNum >= 0)
+		return;
+	if ((objects.size() - first) < 2)
+		return;
+
+	auto& table = QUERY_DEDUP_TABLES[ThreadPool::GetThreadNum()];
+
+	table.clear();
+	table.reserve(objects.size() - first);
+
+	for (size_t i = first; i < objects.size(); i++) {
+		table.emplace_back(objects[i], i);
+	}
+
+	// sorting by {object, index} keeps the first occurrence of each object
+	// at the front of its run, so the result is ordered the same as it is
+	// with tempNum-based filtering
+	std::sort(table.begin(), table.end());
+
+	for (size_t i = 1; i < table.size(); i++) {
+		if (table[i].first != table[i - 1].first)
+			continue;
+
+		objects[table[i].second] = nullptr;
+	}
+
+	objects.erase(std::remove(objects.begin() + first, objects.end(), nullptr), objects.end());
+}
+#endif
+
+
+#ifndef UNIT_TEST
+void CQuadField::Resize(int quadSize)
 {
-	CQuadField* oldQuadField = &quadField;
-	CQuadField newQuadField;
-
-	newQuadField.Init(int2(mapDims.mapx, mapDims.mapy), quad_size);
-
-	for (int zq = 0; zq < oldQuadField->GetNumQuadsZ(); zq++) {
-		for (int xq = 0; xq < oldQuadField->GetNumQuadsX(); xq++) {
-			const CQuadField::Quad& quad = oldQuadField->GetQuadAt(xq, zq);
-
-			// COPY the object lists because the Remove* functions modify them
-			// NOTE:
-			//   teamUnits is updated internally by RemoveUnit and MovedUnit
-			//
-			//   if a unit exists in multiple quads in the old field, it will
-			//   be removed from all of them and there is no danger of double
-			//   re-insertion (important if new grid has higher resolution)
-			const std::vector<CUnit*      > units       = quad.units;
-			const std::vector<CFeature*   > features    = quad.features;
-			const std::vector<CProjectile*> projectiles = quad.projectiles;
-
-			for (auto it = units.cbegin(); it != units.cend(); ++it) {
-				oldQuadField->RemoveUnit(*it);
-				newQuadField->MovedUnit(*it); // handles addition
-			}
+	const int2 mapSize = {numQuadsX * quadSizeX, numQuadsZ * quadSizeZ};
 
-			for (auto it = features.cbegin(); it != features.cend(); ++it) {
-				oldQuadField->RemoveFeature(*it);
-				newQuadField->AddFeature(*it);
-			}
+	if (quadSize == quadSizeX && quadSize == quadSizeZ)
+		return;
 
-			for (auto it = projectiles.cbegin(); it != projectiles.cend(); ++it) {
-				oldQuadField->RemoveProjectile(*it);
-				newQuadField->AddProjectile(*it);
-			}
+	assert((mapSize.x % quadSize) == 0);
+	assert((mapSize.y % quadSize) == 0);
+
+	// gather every object in quad order so they are relinked deterministically
+	std::vector<CUnit*> units;
+	std::vector<CFeature*> features;
+	std::vector<CProjectile*> projectiles;
+	std::vector<CPlasmaRepulser*> repulsers;
+
+	const int tempNum = gs->GetTempNum();
+
+	for (const Quad& quad: baseQuads) {
+		for (CUnit* u: quad.units) {
+			if (VisitedByQuery(u, tempNum))
+				continue;
+
+			units.push_back(u);
 		}
+		for (CFeature* f: quad.features) {
+			if (VisitedByQuery(f, tempNum))
+				continue;
+
+			features.push_back(f);
+		}
+		for (CProjectile* p: quad.projectiles) {
+			if (VisitedByQuery(p, tempNum))
+				continue;
+
+			projectiles.push_back(p);
+		}
+		for (CPlasmaRepulser* r: quad.repulsers) {
+			if (VisitedByQuery(r, tempNum))
+				continue;
+
+			repulsers.push_back(r);
+		}
+	}
+
+	for (Quad& quad: baseQuads) {
+		quad.Clear();
+	}
+
+	// objects still reference quads of the old grid; drop every cached
+	// index (including the per-batch projectile quads) before rebuilding
+	tempProjectileQuads.clear();
+
+	for (CUnit* u: units) {
+		u->quads.clear();
+	}
+	for (CProjectile* p: projectiles) {
+		p->quads.clear();
+	}
+	for (CPlasmaRepulser* r: repulsers) {
+		r->ClearQuads();
+	}
+
+	Init(mapSize / SQUARE_SIZE, quadSize);
+
+	for (CUnit* u: units) {
+		MovedUnit(u);
+	}
+	for (CFeature* f: features) {
+		AddFeature(f);
+	}
+	for (CProjectile* p: projectiles) {
+		AddProjectile(p);
+	}
+	for (CPlasmaRepulser* r: repulsers) {
+		MovedRepulser(r);
+	}
+
+	occupancyStats.numResizes += 1;
+}
+
+
+void CQuadField::Update()
+{
+	if ((gs->frameNum % UNIT_SLOWUPDATE_RATE) != 0)
+		return;
+
+	UpdateOccupancyStats();
+
+	const int maxOccupancy = modInfo.quadFieldMaxOccupancy;
+
+	if (maxOccupancy <= 0)
+		return;
+
+	const int2 mapSize = {numQuadsX * quadSizeX, numQuadsZ * quadSizeZ};
+	const int smallerSize = quadSizeX >> 1;
+	const int largerSize = quadSizeX << 1;
+
+	// halving the quad size roughly quarters the number of objects per quad
+	// (less for objects larger than a quad), so only grow back once doing so
+	// stays well below the limit to avoid flip-flopping between two sizes
+	if (occupancyStats.avgObjectsPerQuad > maxOccupancy) {
+		if (smallerSize < int(MIN_QUAD_SIZE))
+			return;
+		if ((mapSize.x % smallerSize) != 0 || (mapSize.y % smallerSize) != 0)
+			return;
+
+		LOG("[QuadField::%s][frame=%d] avgObjectsPerQuad=%.2f > %d, decreasing quad-size to %d",
+			__func__, gs->frameNum, occupancyStats.avgObjectsPerQuad, maxOccupancy, smallerSize);
+
+		Resize(smallerSize);
+		return;
+	}
+
+	if ((occupancyStats.avgObjectsPerQuad * 4.0f) < (maxOccupancy * 0.5f)) {
+		if (largerSize > int(BASE_QUAD_SIZE))
+			return;
+
+		LOG("[QuadField::%s][frame=%d] avgObjectsPerQuad=%.2f, increasing quad-size to %d",
+			__func__, gs->frameNum, occupancyStats.avgObjectsPerQuad, largerSize);
+
+		Resize(largerSize);
+	}
+}
+
+
+void CQuadField::UpdateOccupancyStats()
+{
+	size_t numObjects = 0;
+
+	occupancyStats.peakObjectsPerQuad = 0;
+	occupancyStats.numOccupiedQuads = 0;
+
+	for (const Quad& quad: baseQuads) {
+		const int n = quad.units.size() + quad.features.size();
+
+		if (n == 0)
+			continue;
+
+		numObjects += n;
+
+		occupancyStats.peakObjectsPerQuad = std::max(occupancyStats.peakObjectsPerQuad, n);
+		occupancyStats.numOccupiedQuads += 1;
 	}
 
-	quadField = std::move(newQuadField);
+	occupancyStats.avgObjectsPerQuad = numObjects / std::max(1.0f, occupancyStats.numOccupiedQuads * 1.0f);
 }
-*/
 #endif
 
 
@@ -426,6 +597,33 @@ void CQuadField::MovedProjectile(CProjectile* p)
 	}
 }
 
+void CQuadField::MovedProjectiles(const std::vector<CProjectile*>& projectiles)
+{
+	tempProjectileQuads.clear();
+	tempProjectileQuads.resize(projectiles.size());
+
+	// first pass only maps positions to quad indices, second pass
+	// relinks the (usually few) projectiles that crossed a border
+	for (size_t i = 0, n = projectiles.size(); i < n; i++) {
+		tempProjectileQuads[i] = WorldPosToQuadFieldIdx(projectiles[i]->pos);
+	}
+
+	for (size_t i = 0, n = projectiles.size(); i < n; i++) {
+		CProjectile* p = projectiles[i];
+
+		if (!p->synced)
+			continue;
+		// hit-scan projectiles do NOT move!
+		if (p->hitscan)
+			continue;
+		if (tempProjectileQuads[i] == p->quads.back())
+			continue;
+
+		RemoveProjectile(p);
+		AddProjectile(p);
+	}
+}
+
 void CQuadField::AddProjectile(CProjectile* p)
 {
 	assert(p->synced);
@@ -466,19 +664,19 @@ void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
 	qfq.units = tempUnits.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (VisitedByQuery(u, tempNum))
 				continue;
-
-			u->tempNum = tempNum;
 			qfq.units->push_back(u);
 		}
 	}
 
+	RemoveQueryDuplicates(*qfq.units, 0, tempNum);
+
 	return;
 }
 
@@ -486,16 +684,14 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float rad
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
 	qfq.units = tempUnits.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (VisitedByQuery(u, tempNum))
 				continue;
 
-			u->tempNum = tempNum;
-
 			const float totRad       = radius + u->radius;
 			const float totRadSq     = totRad * totRad;
 			const float posUnitDstSq = spherical?
@@ -509,6 +705,8 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float rad
 		}
 	}
 
+	RemoveQueryDuplicates(*qfq.units, 0, tempNum);
+
 	return;
 }
 
@@ -516,17 +714,15 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const fl
 {
 	QuadFieldQuery qfQuery;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
 	qfq.units = tempUnits.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* unit: baseQuads[qi].units) {
 
-			if (unit->tempNum == tempNum)
+			if (VisitedByQuery(unit, tempNum))
 				continue;
 
-			unit->tempNum = tempNum;
-
 			const float3& pos = unit->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
 				continue;
@@ -537,6 +733,8 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const fl
 		}
 	}
 
+	RemoveQueryDuplicates(*qfq.units, 0, tempNum);
+
 	return;
 }
 
@@ -545,16 +743,14 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& pos, float
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
 	qfq.features = tempFeatures.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+			if (VisitedByQuery(f, tempNum))
 				continue;
 
-			f->tempNum = tempNum;
-
 			const float totRad       = radius + f->radius;
 			const float totRadSq     = totRad * totRad;
 			const float posDstSq = spherical?
@@ -568,6 +764,8 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& pos, float
 		}
 	}
 
+	RemoveQueryDuplicates(*qfq.features, 0, tempNum);
+
 	return;
 }
 
@@ -575,16 +773,14 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& mins, const
 {
 	QuadFieldQuery qfQuery;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
 	qfq.features = tempFeatures.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CFeature* feature: baseQuads[qi].features) {
-			if (feature->tempNum == tempNum)
+			if (VisitedByQuery(feature, tempNum))
 				continue;
 
-			feature->tempNum = tempNum;
-
 			const float3& pos = feature->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
 				continue;
@@ -595,6 +791,8 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& mins, const
 		}
 	}
 
+	RemoveQueryDuplicates(*qfq.features, 0, tempNum);
+
 	return;
 }
 
@@ -604,16 +802,14 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, flo
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
 	qfq.projectiles = tempProjectiles.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			if (VisitedByQuery(p, tempNum))
 				continue;
 
-			p->tempNum = tempNum;
-
 			if (pos.SqDistance(p->pos) >= Square(radius + p->radius))
 				continue;
 
@@ -621,6 +817,8 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, flo
 		}
 	}
 
+	RemoveQueryDuplicates(*qfq.projectiles, 0, tempNum);
+
 	return;
 }
 
@@ -628,16 +826,14 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& mins, co
 {
 	QuadFieldQuery qfQuery;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
 	qfq.projectiles = tempProjectiles.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			if (VisitedByQuery(p, tempNum))
 				continue;
 
-			p->tempNum = tempNum;
-
 			const float3& pos = p->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
 				continue;
@@ -648,6 +844,8 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& mins, co
 		}
 	}
 
+	RemoveQueryDuplicates(*qfq.projectiles, 0, tempNum);
+
 	return;
 }
 
@@ -662,16 +860,14 @@ void CQuadField::GetSolidsExact(
 ) {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
 	qfq.solids = tempSolids.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (VisitedByQuery(u, tempNum))
 				continue;
 
-			u->tempNum = tempNum;
-
 			if (!u->HasPhysicalStateBit(physicalStateBits))
 				continue;
 			if (!u->HasCollidableStateBit(collisionStateBits))
@@ -683,11 +879,9 @@ void CQuadField::GetSolidsExact(
 		}
 
 		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+			if (VisitedByQuery(f, tempNum))
 				continue;
 
-			f->tempNum = tempNum;
-
 			if (!f->HasPhysicalStateBit(physicalStateBits))
 				continue;
 			if (!f->HasCollidableStateBit(collisionStateBits))
@@ -699,6 +893,8 @@ void CQuadField::GetSolidsExact(
 		}
 	}
 
+	RemoveQueryDuplicates(*qfq.solids, 0, tempNum);
+
 	return;
 }
 
@@ -711,15 +907,13 @@ bool CQuadField::NoSolidsExact(
 ) {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (VisitedByQuery(u, tempNum))
 				continue;
 
-			u->tempNum = tempNum;
-
 			if (!u->HasPhysicalStateBit(physicalStateBits))
 				continue;
 			if (!u->HasCollidableStateBit(collisionStateBits))
@@ -731,11 +925,9 @@ bool CQuadField::NoSolidsExact(
 		}
 
 		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+			if (VisitedByQuery(f, tempNum))
 				continue;
 
-			f->tempNum = tempNum;
-
 			if (!f->HasPhysicalStateBit(physicalStateBits))
 				continue;
 			if (!f->HasCollidableStateBit(collisionStateBits))
@@ -759,7 +951,11 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 	std::vector<CFeature*>& features,
 	std::vector<CPlasmaRepulser*>* repulsers
 ) {
-	const int tempNum = gs->GetTempNum();
+	const int tempNum = GetQueryTempNum();
+
+	const size_t numUnits = units.size();
+	const size_t numFeatures = features.size();
+	const size_t numRepulsers = (repulsers != nullptr)? repulsers->size(): 0;
 
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
@@ -770,11 +966,9 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 
 		for (CUnit* u: quad.units) {
 			// prevent double adding
-			if (u->tempNum == tempNum)
+			if (VisitedByQuery(u, tempNum))
 				continue;
 
-			u->tempNum = tempNum;
-
 			const auto* colvol = &u->collisionVolume;
 			const float totRad = radius + colvol->GetBoundingRadius();
 
@@ -786,11 +980,9 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 
 		for (CFeature* f: quad.features) {
 			// prevent double adding
-			if (f->tempNum == tempNum)
+			if (VisitedByQuery(f, tempNum))
 				continue;
 
-			f->tempNum = tempNum;
-
 			const auto* colvol = &f->collisionVolume;
 			const float totRad = radius + colvol->GetBoundingRadius();
 
@@ -802,11 +994,9 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		if (repulsers != nullptr) {
 			for (CPlasmaRepulser* r: quad.repulsers) {
 				// prevent double adding
-				if (r->tempNum == tempNum)
+				if (VisitedByQuery(r, tempNum))
 					continue;
 
-				r->tempNum = tempNum;
-
 				const auto* colvol = &r->collisionVolume;
 				const float totRad = radius + colvol->GetBoundingRadius();
 
@@ -817,5 +1007,12 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 			}
 		}
 	}
+
+	RemoveQueryDuplicates(units, numUnits, tempNum);
+	RemoveQueryDuplicates(features, numFeatures, tempNum);
+
+	if (repulsers != nullptr)
+		RemoveQueryDuplicates(*repulsers, numRepulsers, tempNum);
 }
+
 #endif // UNIT_TEST
@@ -5,9 +5,11 @@
 
 #include <algorithm>
 #include <array>
+#include <deque>
 #include <vector>
 
 #include "System/Misc/NonCopyable.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
 #include "System/type2.h"
@@ -19,29 +21,48 @@ class CSolidObject;
 class CPlasmaRepulser;
 struct QuadFieldQuery;
 
+/**
+ * Scratch vectors for QuadField queries. Every ThreadPool thread owns its
+ * own set, so queries issued concurrently from different threads never
+ * share (or need to lock) a vector; a vector must be released by the same
+ * thread that reserved it.
+ */
 template<typename T>
 class QueryVectorCache {
 public:
 	typedef std::pair<bool, std::vector<T>> PairType;
 
 	std::vector<T>* ReserveVector(size_t base = 0, size_t capa = 1024) {
+		auto& vectors = threadVectors[ThreadPool::GetThreadNum()];
+
 		const auto pred = [](const PairType& p) { return (!p.first); };
-		const auto iter = std::find_if(vectors.begin() + base, vectors.end(), pred);
+		const auto iter = std::find_if(vectors.begin() + std::min(base, vectors.size()), vectors.end(), pred);
+
+		PairType* pair = nullptr;
 
 		if (iter != vectors.end()) {
-			iter->first = true;
-			iter->second.clear();
-			iter->second.reserve(capa);
-			return &iter->second;
+			pair = &(*iter);
+		} else {
+			// more nested queries on this thread than expected; deque
+			// keeps existing vectors in place so just add another one
+			vectors.emplace_back(false, std::vector<T>{});
+			pair = &vectors.back();
 		}
 
-		assert(false);
-		return nullptr;
+		pair->first = true;
+		pair->second.clear();
+		pair->second.reserve(capa);
+		return &pair->second;
 	}
 
+	// only reserves the calling thread's vectors; those of other threads
+	// stay empty until their first ReserveVector, which keeps idle worker
+	// threads from holding numQuads-sized buffers on large maps
 	void ReserveAll(size_t capa) {
-		for (size_t i = 0; i < vectors.size(); ++i) {
-			ReserveVector(i, capa);
+		for (PairType& pair: threadVectors[ThreadPool::GetThreadNum()]) {
+			pair.first = true;
+			pair.second.clear();
+			pair.second.reserve(capa);
 		}
 	}
 
@@ -49,6 +70,8 @@ public:
 		if (released == nullptr)
 			return;
 
+		auto& vectors = threadVectors[ThreadPool::GetThreadNum()];
+
 		const auto pred = [&](const PairType& p) { return (&p.second == released); };
 		const auto iter = std::find_if(vectors.begin(), vectors.end(), pred);
 
@@ -60,15 +83,26 @@ public:
 		iter->first = false;
 	}
 	void ReleaseAll() {
-		for (auto& pair: vectors) {
-			ReleaseVector(&pair.second);
+		for (auto& vectors: threadVectors) {
+			for (PairType& pair: vectors) {
+				pair.first = false;
+			}
 		}
 	}
 private:
-	// There should at most be 2 concurrent users of each vector type
-	// using 3 to be safe, increase this number if the assertions below
-	// fail
-	std::array<PairType, 3> vectors = {{{false, {}}, {false, {}}, {false, {}}}};
+	// there should at most be 2 concurrent users of each vector type per
+	// thread; start with 3 to be safe, more are added on demand
+	std::array<std::deque<PairType>, ThreadPool::MAX_THREADS> threadVectors = MakeThreadVectors();
+
+	static std::array<std::deque<PairType>, ThreadPool::MAX_THREADS> MakeThreadVectors() {
+		std::array<std::deque<PairType>, ThreadPool::MAX_THREADS> tv;
+
+		for (auto& vectors: tv) {
+			vectors.resize(3, {false, {}});
+		}
+
+		return tv;
+	}
 };
 
 
@@ -79,19 +113,31 @@ class CQuadField : spring::noncopyable
 	CR_DECLARE_SUB(Quad)
 
 public:
+	struct OccupancyStats {
+		float avgObjectsPerQuad = 0.0f; // units and features, averaged over non-empty quads
+		int peakObjectsPerQuad = 0;
+		int numOccupiedQuads = 0;
+		int numResizes = 0;
+	};
 
-	/*
-	needed to support dynamic resizing (not used yet)
-	in large games the average loading factor (number of objects per quad)
-	can grow too large to maintain amortized constant performance so more
-	quads are needed
-
-	static void Resize(int quadSize);
-	*/
-
+public:
 	void Init(int2 mapDims, int quadSize);
 	void Kill();
 
+	/**
+	 * Periodically (synced) recomputes the occupancy statistics and,
+	 * if enabled by modrules, adapts the quad size to them:
+	 * in large games the average loading factor (number of objects
+	 * per quad) can grow too large to maintain amortized constant
+	 * query performance so more quads are needed
+	 */
+	void Update();
+	/**
+	 * Rebuilds the grid with a new quad size and relinks every
+	 * object; quad indices held by callers become invalid
+	 */
+	void Resize(int quadSize);
+
 	void GetQuads(QuadFieldQuery& qfq, float3 pos, float radius);
 	void GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, const float3& maxs);
 	void GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const float3& dir, float length);
@@ -157,6 +203,7 @@ public:
 	void RemoveFeature(CFeature* feature);
 
 	void MovedProjectile(CProjectile* projectile);
+	void MovedProjectiles(const std::vector<CProjectile*>& projectiles);
 	void AddProjectile(CProjectile* projectile);
 	void RemoveProjectile(CProjectile* projectile);
 
@@ -225,12 +272,17 @@ public:
 	int GetQuadSizeX() const { return quadSizeX; }
 	int GetQuadSizeZ() const { return quadSizeZ; }
 
+	const OccupancyStats& GetOccupancyStats() const { return occupancyStats; }
+
 	constexpr static unsigned int BASE_QUAD_SIZE = 128;
+	constexpr static unsigned int MIN_QUAD_SIZE = 32;
 
 private:
 	int2 WorldPosToQuadField(const float3 p) const;
 	int WorldPosToQuadFieldIdx(const float3 p) const;
 
+	void UpdateOccupancyStats();
+
 private:
 	std::vector<Quad> baseQuads;
 
@@ -241,6 +293,11 @@ private:
 	QueryVectorCache<CSolidObject*> tempSolids;
 	QueryVectorCache<int> tempQuads;
 
+	// current quad of each projectile passed to MovedProjectiles
+	std::vector<int> tempProjectileQuads;
+
+	OccupancyStats occupancyStats;
+
 	int numQuadsX;
 	int numQuadsZ;
 
@@ -15,6 +15,7 @@
 #include "Sim/Features/Feature.h"
 #include "Sim/Features/FeatureHandler.h"
 #include "Sim/Misc/GeometricObjects.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
@@ -138,6 +139,12 @@ CR_REG_METADATA(CGroundMoveType, (
 	CR_MEMBER(useMainHeading),
 	CR_MEMBER(useRawMovement),
 
+	CR_IGNORED(samplePos),
+	CR_IGNORED(sampleHeight),
+	CR_IGNORED(sampleSlope),
+	CR_IGNORED(sampleFrame),
+	CR_IGNORED(sampleHeightMapChanges),
+
 	CR_POSTLOAD(PostLoad)
 ))
 
@@ -474,6 +481,33 @@ bool CGroundMoveType::OwnerMoved(const short oldHeading, const float3& posDif, c
 	return true;
 }
 
+void CGroundMoveType::UpdatePreCollisionsMT()
+{
+	// NOTE:
+	//   runs concurrently for all units, so only the samples may be written;
+	//   they are pure functions of the position and the heightmap and both
+	//   are checked before use, since earlier units can push the owner (and
+	//   Lua can change terrain) before this unit's Update runs
+	const float3& pos = owner->pos;
+
+	samplePos = pos;
+	sampleHeight = CGround::GetHeightReal(pos.x, pos.z);
+	sampleSlope = CGround::GetSlope(pos.x, pos.z);
+
+	sampleFrame = gs->frameNum;
+	sampleHeightMapChanges = readMap->GetNumHeightMapChanges();
+}
+
+bool CGroundMoveType::HaveTerrainSample(const float3& p) const
+{
+	if (sampleFrame != gs->frameNum)
+		return false;
+	if (sampleHeightMapChanges != readMap->GetNumHeightMapChanges())
+		return false;
+
+	return (p.x == samplePos.x && p.z == samplePos.z);
+}
+
 bool CGroundMoveType::Update()
 {
 	ASSERT_SYNCED(owner->pos);
@@ -2378,9 +2412,11 @@ bool CGroundMoveType::OnSlope(float minSlideTolerance) {
 	// (otherwise the unit could stop on an invalid path location, and be teleported
 	// back)
 	const float slopeMul = mix(ud->slideTolerance, 1.0f, (minSlideTolerance <= 0.0f));
-	const float curSlope = CGround::GetSlope(pos.x, pos.z);
+	const float curSlope = HaveTerrainSample(pos)? sampleSlope: CGround::GetSlope(pos.x, pos.z);
 	const float maxSlope = md->maxSlope * slopeMul;
 
+	assert(curSlope == CGround::GetSlope(pos.x, pos.z));
+
 	return (curSlope > maxSlope);
 }
 
@@ -2398,7 +2434,9 @@ const float3& CGroundMoveType::GetGroundNormal(const float3& p) const
 float CGroundMoveType::GetGroundHeight(const float3& p) const
 {
 	// in [minHeight, maxHeight]
-	const float gh = CGround::GetHeightReal(p.x, p.z);
+	const float gh = HaveTerrainSample(p)? sampleHeight: CGround::GetHeightReal(p.x, p.z);
+
+	assert(gh == CGround::GetHeightReal(p.x, p.z));
 	const float wh = -waterline * (gh <= 0.0f);
 
 	// in [-waterline, maxHeight], note that waterline
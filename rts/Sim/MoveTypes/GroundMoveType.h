@@ -29,6 +29,7 @@ public:
 
 	void PostLoad();
 
+	void UpdatePreCollisionsMT() override;
 	bool Update() override;
 	void SlowUpdate() override;
 
@@ -93,6 +94,8 @@ public:
 	float GetGroundHeight(const float3&) const;
 
 private:
+	bool HaveTerrainSample(const float3& p) const;
+
 	float3 GetObstacleAvoidanceDir(const float3& desiredDir);
 	float3 Here() const;
 
@@ -219,6 +222,15 @@ private:
 	bool canReverse = false;
 	bool useMainHeading = false;            /// if true, turn toward mainHeadingPos until weapons[0] can TryTarget() it
 	bool useRawMovement = false;            /// if true, move towards goal without invoking PFS (unrelated to MoveDef::allowRawMovement)
+
+	// terrain under the owner as sampled by UpdatePreCollisionsMT, only
+	// used while the owner is at samplePos and the heightmap is unchanged
+	float3 samplePos;
+	float sampleHeight = 0.0f;
+	float sampleSlope = 0.0f;
+
+	int sampleFrame = -1;
+	unsigned int sampleHeightMapChanges = 0;
 };
 
 #endif // GROUNDMOVETYPE_H
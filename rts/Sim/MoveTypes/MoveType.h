@@ -49,6 +49,12 @@ public:
 	virtual void SetManeuverLeash(float leashLength) { maneuverLeash = leashLength; }
 	virtual void SetWaterline(float depth) { waterline = depth; }
 
+	// optional compute-phase of the MoveType update; called for every
+	// active unit from ThreadPool workers before any Update, so it may
+	// only read and must only write owner-local members whose use by
+	// Update is validated (no unit is guaranteed to still be where it
+	// was sampled when its Update runs)
+	virtual void UpdatePreCollisionsMT() {}
 	virtual bool Update() = 0;
 	virtual void SlowUpdate();
 
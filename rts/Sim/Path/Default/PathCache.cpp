@@ -1,16 +1,23 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <iterator>
 
 #include "PathCache.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "System/Log/ILog.h"
 
-#define MAX_CACHE_QUEUE_SIZE   200
+#define MAX_CACHE_SIZE         200
 #define MAX_PATH_LIFETIME_SECS   6
 #define USE_NONCOLLIDABLE_HASH   1
 
+// start-blocks tested (in this order) when a request has no exact match
+static constexpr int2 NEAR_STRT_BLOCK_OFFSETS[] = {
+	{-1,  0}, { 1,  0}, { 0, -1}, { 0,  1},
+	{-1, -1}, { 1, -1}, {-1,  1}, { 1,  1},
+};
+
 CPathCache::CPathCache(int blocksX, int blocksZ)
 	: numBlocksX(blocksX)
 	, numBlocksZ(blocksZ)
@@ -18,25 +25,28 @@ CPathCache::CPathCache(int blocksX, int blocksZ)
 
 	, maxCacheSize(0)
 	, numCacheHits(0)
+	, numCacheNearHits(0)
 	, numCacheMisses(0)
+	, numEvictions(0)
+	, numExpirations(0)
 	, numHashCollisions(0)
 {
 	// {result, path, strtBlock, goalBlock, goalRadius, pathType}
 	dummyCacheItem = {IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1};
 
-	cachedPaths.reserve(4096);
+	cachedPaths.reserve(MAX_CACHE_SIZE + 1);
 }
 
 CPathCache::~CPathCache()
 {
 	const char* fmt =
 #ifdef _WIN32
-		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%I64u";
+		"[%s(%ux%u)] cacheHits=%u (near=%u) hitPercentage=%.0f%% evictions=%u expirations=%u numHashColls=%u maxCacheSize=%I64u";
 #else
-		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%lu";
+		"[%s(%ux%u)] cacheHits=%u (near=%u) hitPercentage=%.0f%% evictions=%u expirations=%u numHashColls=%u maxCacheSize=%lu";
 #endif
 
-	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, GetCacheHitPercentage(), numHashCollisions, maxCacheSize);
+	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, numCacheNearHits, GetCacheHitPercentage(), numEvictions, numExpirations, numHashCollisions, maxCacheSize);
 }
 
 bool CPathCache::AddPath(
@@ -47,22 +57,25 @@ bool CPathCache::AddPath(
 	float goalRadius,
 	int pathType
 ) {
-	if (cacheQue.size() > MAX_CACHE_QUEUE_SIZE)
-		RemoveFrontQueItem();
-
 	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
 	const std::uint32_t cols = numHashCollisions;
 	const auto iter = cachedPaths.find(hash);
 
 	// register any hash collisions
 	if (iter != cachedPaths.end())
-		return ((numHashCollisions += HashCollision(iter->second, strtBlock, goalBlock, goalRadius, pathType)) != cols);
+		return ((numHashCollisions += HashCollision(iter->second.item, strtBlock, goalBlock, goalRadius, pathType)) != cols);
 
-	cachedPaths[hash] = CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType};
+	// full, make room by dropping the least recently used path
+	if (cacheQue.size() >= MAX_CACHE_SIZE) {
+		RemoveQueItem(cacheQue.begin());
+		numEvictions += 1;
+	}
 
 	const int lifeTime = (result == IPath::Ok) ? GAME_SPEED * MAX_PATH_LIFETIME_SECS : GAME_SPEED * (MAX_PATH_LIFETIME_SECS / 2);
 
 	cacheQue.push_back({gs->frameNum + lifeTime, hash});
+	cachedPaths[hash] = CacheEntry{CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType}, std::prev(cacheQue.end())};
+
 	maxCacheSize = std::max<std::uint64_t>(maxCacheSize, cacheQue.size());
 	return false;
 }
@@ -71,41 +84,105 @@ const CPathCache::CacheItem& CPathCache::GetCachedPath(
 	const int2 strtBlock,
 	const int2 goalBlock,
 	float goalRadius,
-	int pathType
+	int pathType,
+	const BlocksConnectedFunc& blocksConnected
 ) {
-	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
-	const auto iter = cachedPaths.find(hash);
+	const CacheEntry* entry = FindEntry(strtBlock, goalBlock, goalRadius, pathType);
 
-	if (iter == cachedPaths.end()) {
-		++numCacheMisses; return dummyCacheItem;
-	}
-	if ((iter->second).strtBlock != strtBlock) {
-		++numCacheMisses; return dummyCacheItem;
-	}
-	if ((iter->second).goalBlock != goalBlock) {
-		++numCacheMisses; return dummyCacheItem;
+	if (entry == nullptr) {
+		// units ordered to the same spot as a group mostly start from
+		// adjacent blocks, let them share a completed search made for
+		// any neighbour they can move into (its first waypoint is then
+		// replaced by the caller)
+		for (const int2 offset: NEAR_STRT_BLOCK_OFFSETS) {
+			const int2 nearBlock = strtBlock + offset;
+
+			if (nearBlock.x < 0 || nearBlock.x >= int(numBlocksX))
+				continue;
+			if (nearBlock.y < 0 || nearBlock.y >= int(numBlocksZ))
+				continue;
+
+			if ((entry = FindEntry(nearBlock, goalBlock, goalRadius, pathType)) == nullptr)
+				continue;
+
+			if ((entry->item).result == IPath::Ok && blocksConnected(strtBlock, nearBlock)) {
+				++numCacheNearHits;
+				break;
+			}
+
+			entry = nullptr;
+		}
 	}
-	if ((iter->second).pathType != pathType) {
+
+	if (entry == nullptr) {
 		++numCacheMisses; return dummyCacheItem;
 	}
 
+	// mark as most recently used; does not extend the path's lifetime
+	cacheQue.splice(cacheQue.end(), cacheQue, entry->queIter);
+
 	++numCacheHits;
-	return (iter->second);
+	return (entry->item);
+}
+
+const CPathCache::CacheEntry* CPathCache::FindEntry(
+	const int2 strtBlock,
+	const int2 goalBlock,
+	float goalRadius,
+	int pathType
+) const {
+	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
+	const auto iter = cachedPaths.find(hash);
+
+	if (iter == cachedPaths.end())
+		return nullptr;
+
+	const CacheItem& ci = (iter->second).item;
+
+	if (ci.strtBlock != strtBlock)
+		return nullptr;
+	if (ci.goalBlock != goalBlock)
+		return nullptr;
+	if (ci.pathType != pathType)
+		return nullptr;
+	// hashes only include the integer part
+	if (ci.goalRadius != goalRadius)
+		return nullptr;
+
+	return &(iter->second);
+}
+
+void CPathCache::AddStats(IPathManager::PathCacheStats& stats) const
+{
+	stats.numHits += numCacheHits;
+	stats.numNearHits += numCacheNearHits;
+	stats.numMisses += numCacheMisses;
+	stats.numEvictions += numEvictions;
+	stats.numExpirations += numExpirations;
+	stats.numCachedPaths += cacheQue.size();
 }
 
 void CPathCache::Update()
 {
-	while (!cacheQue.empty() && (cacheQue.front().timeout) < gs->frameNum)
-		RemoveFrontQueItem();
+	// hits reorder the queue, so expired paths can be anywhere in it
+	for (auto it = cacheQue.begin(); it != cacheQue.end(); ) {
+		if ((it->timeout) >= gs->frameNum) {
+			++it;
+			continue;
+		}
+
+		RemoveQueItem(it++);
+		numExpirations += 1;
+	}
 }
 
-void CPathCache::RemoveFrontQueItem()
+void CPathCache::RemoveQueItem(CacheQue::iterator queIter)
 {
-	const auto it = cachedPaths.find((cacheQue.front()).hash);
+	const auto it = cachedPaths.find(queIter->hash);
 
 	assert(it != cachedPaths.end());
 	cachedPaths.erase(it);
-	cacheQue.pop_front();
+	cacheQue.erase(queIter);
 }
 
 std::uint64_t CPathCache::GetHash(
@@ -3,9 +3,11 @@
 #ifndef PATHCACHE_H
 #define PATHCACHE_H
 
-#include <deque>
+#include <functional>
+#include <list>
 
 #include "IPath.h"
+#include "Sim/Path/IPathManager.h"
 #include "System/type2.h"
 #include "System/UnorderedMap.hpp"
 
@@ -24,6 +26,9 @@ public:
 		int pathType;
 	};
 
+	/// whether a unit in the first block can move into the adjacent second one
+	typedef std::function<bool(const int2 strtBlock, const int2 nearBlock)> BlocksConnectedFunc;
+
 	void Update();
 	bool AddPath(
 		const IPath::Path* path,
@@ -38,11 +43,34 @@ public:
 		const int2 strtBlock,
 		const int2 goalBlock,
 		float goalRadius,
-		int pathType
+		int pathType,
+		const BlocksConnectedFunc& blocksConnected
 	);
 
+	void AddStats(IPathManager::PathCacheStats& stats) const;
+
 private:
-	void RemoveFrontQueItem();
+	struct CacheQueItem {
+		std::int32_t timeout;
+		std::uint64_t hash;
+	};
+
+	typedef std::list<CacheQueItem> CacheQue;
+
+	struct CacheEntry {
+		CacheItem item;
+		// position in cacheQue, moved to the back on every hit
+		CacheQue::iterator queIter;
+	};
+
+	void RemoveQueItem(CacheQue::iterator queIter);
+
+	const CacheEntry* FindEntry(
+		const int2 strtBlock,
+		const int2 goalBlock,
+		float goalRadius,
+		int pathType
+	) const;
 
 	std::uint64_t GetHash(
 		const int2 strtBlk,
@@ -67,16 +95,12 @@ private:
 	}
 
 private:
-	struct CacheQueItem {
-		std::int32_t timeout;
-		std::uint64_t hash;
-	};
-
 	// returned on any cache-miss
 	CacheItem dummyCacheItem;
 
-	std::deque<CacheQueItem> cacheQue;
-	spring::unordered_map<std::uint64_t, CacheItem> cachedPaths; // ints are sync-safe keys
+	// least recently used path at the front
+	CacheQue cacheQue;
+	spring::unordered_map<std::uint64_t, CacheEntry> cachedPaths; // ints are sync-safe keys
 
 	std::uint32_t numBlocksX;
 	std::uint32_t numBlocksZ;
@@ -84,7 +108,10 @@ private:
 
 	std::uint64_t maxCacheSize;
 	std::uint32_t numCacheHits;
+	std::uint32_t numCacheNearHits;
 	std::uint32_t numCacheMisses;
+	std::uint32_t numEvictions;
+	std::uint32_t numExpirations;
 	std::uint32_t numHashCollisions;
 };
 
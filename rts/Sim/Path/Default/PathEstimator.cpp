@@ -2,8 +2,6 @@
 
 #include "System/Platform/Win/win32.h"
 
-#include "minizip/zip.h"
-
 #include "PathEstimator.h"
 #include "PathFinder.h"
 #include "PathFinderDef.h"
@@ -12,6 +10,7 @@
 #include "PathMemPool.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/LoadScreen.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
@@ -20,8 +19,6 @@
 #include "System/Threading/ThreadPool.h" // for_mt
 #include "System/TimeProfiler.h"
 #include "System/Config/ConfigHandler.h"
-#include "System/FileSystem/Archives/IArchive.h"
-#include "System/FileSystem/ArchiveLoader.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
@@ -31,6 +28,10 @@
 #include "System/Sync/HsiehHash.h"
 #include "System/Sync/SHA512.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
 #define ENABLE_NETLOG_CHECKSUM 1
 
 CONFIG(int, PathingThreadCount).defaultValue(0).safemodeValue(1).minimumValue(0);
@@ -44,6 +45,32 @@ static const std::string GetPathCacheDir() {
 	return (FileSystem::GetCacheDir() + "/paths/");
 }
 
+static const std::string GetPathCacheFileName(const std::string& mapName, const std::string& baseFileName, std::uint32_t hashCode) {
+	return (GetPathCacheDir() + mapName + "." + baseFileName + "-" + IntToString(hashCode, "%x") + ".dat");
+}
+
+
+// uncompressed so it can be mapped; offsets and costs of each
+// MoveDef are stored contiguously and follow this header (the
+// header size keeps both sections naturally aligned)
+struct PathCacheFileHeader {
+	static constexpr std::uint32_t MAGIC = 0x45504853; // "SHPE"
+	static constexpr std::uint32_t VERSION = 2;
+
+	std::uint32_t magic;
+	std::uint32_t version;
+	std::uint32_t hashCode;
+	std::uint32_t blockSize;
+	std::uint32_t numMoveDefs;
+	std::uint32_t numBlocks;
+	std::uint32_t numVertexCosts;
+	// only used to detect stale or corrupted files, the
+	// digest is always recalculated from the mapped data
+	std::uint32_t checksum;
+};
+
+static_assert((sizeof(PathCacheFileHeader) % sizeof(float)) == 0, "");
+
 static size_t GetNumThreads() {
 	const size_t numThreads = std::max(0, configHandler->GetInt("PathingThreadCount"));
 	const size_t numCores = Threading::GetLogicalCpuCores();
@@ -73,8 +100,9 @@ void CPathEstimator::Init(IPathFinder* pf, unsigned int BLOCK_SIZE, const std::s
 		nextPathEstimator = nullptr;
 	}
 	{
-		vertexCosts.clear();
-		vertexCosts.resize(moveDefHandler.GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES, PATHCOST_INFINITY);
+		// allocated by InitEstimator unless the cache-file can be mapped
+		vertexCosts.Clear();
+		cacheFileMap.Close();
 		maxSpeedMods.clear();
 		maxSpeedMods.resize(moveDefHandler.GetNumMoveDefs(), 0.001f);
 
@@ -134,6 +162,17 @@ void CPathEstimator::Init(IPathFinder* pf, unsigned int BLOCK_SIZE, const std::s
 
 void CPathEstimator::Kill()
 {
+	for (CPathFinder* pf: vertexCostPFs) {
+		pf->Kill();
+		pfMemPool.free(pf);
+	}
+
+	vertexCostPFs.clear();
+	pathFinders.resize(1);
+
+	vertexCosts.Clear();
+	cacheFileMap.Close();
+
 	pcMemPool.free(pathCache[0]);
 	pcMemPool.free(pathCache[1]);
 }
@@ -146,10 +185,12 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 	if (threads.size() != numThreads) {
 		threads.clear();
 		threads.resize(numThreads);
-		pathFinders.clear();
-		pathFinders.resize(numThreads);
 	}
 
+	// not reused, the previous instance may have appended Update helpers
+	pathFinders.clear();
+	pathFinders.resize(numThreads);
+
 	// always use PF for initialization, later PE maybe used
 	// TODO: pooling these will not help much, need to reuse
 	pathFinders[0] = pfMemPool.alloc<CPathFinder>(true);
@@ -158,6 +199,8 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 	InitBlocks();
 
 	if (!ReadFile(cacheFileName, mapName)) {
+		vertexCosts.Alloc(GetNumVertexCosts(), PATHCOST_INFINITY);
+
 		// start extra threads if applicable, but always keep the total
 		// memory-footprint made by CPathFinder instances within bounds
 		const unsigned int minMemFootPrint = sizeof(CPathFinder) + parentPathFinder->GetMemFootPrint();
@@ -196,6 +239,9 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 		}
 
 
+		// Calculate PreCached PathData Checksum, stored alongside the data
+		pathChecksum = CalcChecksum(pathDigest.data());
+
 		sprintf(calcMsg, fmtStrs[2], __func__, BLOCK_SIZE, cacheFileName.c_str(), fileHashCode);
 		loadscreen->SetLoadMessage(calcMsg, true);
 
@@ -205,8 +251,7 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 		loadscreen->SetLoadMessage(calcMsg, true);
 	}
 
-	// Calculate PreCached PathData Checksum
-	pathChecksum = CalcChecksum();
+	LogChecksum(pathDigest.data());
 
 	// switch to runtime wanted IPathFinder (maybe PF or PE)
 	pfMemPool.free(pathFinders[0]);
@@ -214,6 +259,38 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 
 	pathCache[0] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y);
 	pathCache[1] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y);
+
+	blockPathCounts.clear();
+	blockPathCounts.resize(blockStates.GetSize(), 0);
+	blockPathCountsFrame = -1;
+
+	InitVertexCostPathFinders();
+}
+
+
+void CPathEstimator::InitVertexCostPathFinders()
+{
+	// the InitEstimator helpers are gone, only [0] (parent) is valid now
+	pathFinders.resize(1);
+
+	// a PE parent (low-res case) shares search-state and caches and
+	// has to be used from the main thread, a PF can be replaced by
+	// thread-safe instances for parallel vertex-cost updates
+	if (dynamic_cast<CPathFinder*>(parentPathFinder) == nullptr)
+		return;
+
+	const unsigned int minMemFootPrint = sizeof(CPathFinder) + parentPathFinder->GetMemFootPrint();
+	const unsigned int maxMemFootPrint = configHandler->GetInt("MaxPathCostsMemoryFootPrint") * 1024 * 1024;
+	const unsigned int numHelperPFs = Clamp(int(maxMemFootPrint / minMemFootPrint), 0, ThreadPool::GetNumThreads());
+
+	if (numHelperPFs <= 1)
+		return;
+
+	vertexCostPFs.resize(numHelperPFs, nullptr);
+
+	for (CPathFinder*& pf: vertexCostPFs) {
+		pathFinders.push_back(pf = pfMemPool.alloc<CPathFinder>(true));
+	}
 }
 
 
@@ -509,6 +586,9 @@ void CPathEstimator::Update()
 	consumedBlocks.clear();
 	consumedBlocks.reserve(consumeBlocks);
 
+	if ((updatedBlocks.size() * numMoveDefs) > blocksToUpdate)
+		PrioritizeUpdatedBlocks();
+
 	// get blocks to update
 	while (!updatedBlocks.empty()) {
 		const int2& pos = updatedBlocks.front();
@@ -553,19 +633,68 @@ void CPathEstimator::Update()
 		});
 	}
 
-	// CalcVertexPathCosts (not threadsafe)
+	// CalcVertexPathCosts (threadsafe only with our own PF's)
 	{
 		SCOPED_TIMER("Sim::Path::Estimator::CalcVertexPathCosts");
-		for (unsigned int n = 0; n < consumedBlocks.size(); ++n) {
-			CalcVertexPathCosts(*consumedBlocks[n].moveDef, consumedBlocks[n].blockPos);
+
+		if (vertexCostPFs.empty() || consumedBlocks.size() <= 1) {
+			for (unsigned int n = 0; n < consumedBlocks.size(); ++n) {
+				CalcVertexPathCosts(*consumedBlocks[n].moveDef, consumedBlocks[n].blockPos);
+			}
+		} else {
+			// every task owns one PF, blocks are distributed round-robin;
+			// each (block, movedef) pair writes only its own vertex-costs
+			const unsigned int numTasks = std::min(vertexCostPFs.size(), consumedBlocks.size());
+
+			for_mt(0, numTasks, [&](const int taskNum) {
+				for (unsigned int n = taskNum; n < consumedBlocks.size(); n += numTasks) {
+					CalcVertexPathCosts(*consumedBlocks[n].moveDef, consumedBlocks[n].blockPos, taskNum + 1);
+				}
+			});
 		}
 	}
 }
 
 
+/**
+ * Reorder the queued blocks s.t. those crossed by the most synced paths
+ * are updated first; blocks with equal counts keep their FIFO order
+ */
+void CPathEstimator::PrioritizeUpdatedBlocks()
+{
+	// only resort when the counts were refreshed, blocks queued since
+	// then are appended (in FIFO order) behind the prioritized ones
+	if (blockPathCountsFrame != gs->frameNum)
+		return;
+
+	std::stable_sort(updatedBlocks.begin(), updatedBlocks.end(), [&](const int2& a, const int2& b) {
+		return (blockPathCounts[BlockPosToIdx(a)] > blockPathCounts[BlockPosToIdx(b)]);
+	});
+}
+
+
 const CPathCache::CacheItem& CPathEstimator::GetCache(const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced) const
 {
-	return pathCache[synced]->GetCachedPath(strtBlock, goalBlock, goalRadius, pathType);
+	const auto BlocksConnected = [&](const int2 srcBlock, const int2 dstBlock) {
+		const auto dirBeg = std::begin(PE_DIRECTION_VECTORS);
+		const auto dirEnd = std::end(PE_DIRECTION_VECTORS);
+		const auto dirIter = std::find(dirBeg, dirEnd, dstBlock - srcBlock);
+
+		if (dirIter == dirEnd)
+			return false;
+
+		// same lookup as TestBlock; an infinite cost means there is a
+		// cliff, water-edge or structure between the two blocks
+		const unsigned int vertexBaseIdx = pathType * nbrOfBlocks.x * nbrOfBlocks.y * PATH_DIRECTION_VERTICES;
+		const unsigned int vertexCostIdx =
+			vertexBaseIdx +
+			BlockPosToIdx(srcBlock) * PATH_DIRECTION_VERTICES +
+			GetBlockVertexOffset(dirIter - dirBeg, nbrOfBlocks.x);
+
+		return (vertexCosts[vertexCostIdx] < PATHCOST_INFINITY);
+	};
+
+	return pathCache[synced]->GetCachedPath(strtBlock, goalBlock, goalRadius, pathType, BlocksConnected);
 }
 
 void CPathEstimator::AddCache(const IPath::Path* path, const IPath::SearchResult result, const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced)
@@ -926,22 +1055,27 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, const CPathFinderDef&
 }
 
 
+size_t CPathEstimator::GetNumVertexCosts() const
+{
+	return (moveDefHandler.GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES);
+}
+
+
 /**
- * Try to read offset and vertices data from file, return false on failure
+ * Try to map offset and vertices data from file, return false on failure
  */
 bool CPathEstimator::ReadFile(const std::string& baseFileName, const std::string& mapName)
 {
-	const std::string hashHexString = IntToString(fileHashCode, "%x");
-	const std::string cacheFileName = GetPathCacheDir() + mapName + "." + baseFileName + "-" + hashHexString + ".zip";
+	static_assert(std::tuple_size<decltype(pathDigest)>::value == sha512::SHA_LEN, "");
+
+	const std::string cacheFileName = GetPathCacheFileName(mapName, baseFileName, fileHashCode);
 
-	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
+	LOG("[PathEstimator::%s] hash=%x file=\"%s\" (exists=%d)", __func__, fileHashCode, cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
 	if (!FileSystem::FileExists(cacheFileName))
 		return false;
 
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
-
-	if (upfile == nullptr || !upfile->IsOpen()) {
+	if (!cacheFileMap.Open(dataDirsAccess.LocateFile(cacheFileName))) {
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
@@ -950,49 +1084,64 @@ bool CPathEstimator::ReadFile(const std::string& baseFileName, const std::string
 	sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
 	loadscreen->SetLoadMessage(calcMsg);
 
-	const unsigned fid = upfile->FindFile("pathinfo");
-	if (fid >= upfile->NumFiles()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+	const unsigned int numMoveDefs = moveDefHandler.GetNumMoveDefs();
+	const unsigned int numBlocks = blockStates.GetSize();
+	const size_t numVertexCosts = GetNumVertexCosts();
 
-	// pointless; gets reassigned the output of CalcChecksum and CRC is not otherwise used
-	// pathChecksum = upfile->GetCrc32(fid);
+	const size_t offsetsSize = numMoveDefs * numBlocks * sizeof(short2);
+	const size_t costsSize = numVertexCosts * sizeof(float);
 
-	std::vector<std::uint8_t> buffer;
+	PathCacheFileHeader header;
 
-	if (!upfile->GetFile(fid, buffer) || buffer.size() < 4) {
+	if (cacheFileMap.GetSize() != (sizeof(header) + offsetsSize + costsSize)) {
+		cacheFileMap.Close();
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	const unsigned int filehash = *(reinterpret_cast<unsigned int*>(&buffer[0]));
-	const unsigned int blockSize = blockStates.GetSize() * sizeof(short2);
-	unsigned int pos = sizeof(unsigned);
+	std::memcpy(&header, cacheFileMap.GetData(), sizeof(header));
 
-	if (filehash != fileHashCode) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+	bool validHeader = true;
+	validHeader &= (header.magic == PathCacheFileHeader::MAGIC);
+	validHeader &= (header.version == PathCacheFileHeader::VERSION);
+	validHeader &= (header.hashCode == fileHashCode);
+	validHeader &= (header.blockSize == BLOCK_SIZE);
+	validHeader &= (header.numMoveDefs == numMoveDefs);
+	validHeader &= (header.numBlocks == numBlocks);
+	validHeader &= (header.numVertexCosts == numVertexCosts);
 
-	if (buffer.size() < (pos + blockSize * moveDefHandler.GetNumMoveDefs())) {
+	if (!validHeader) {
+		cacheFileMap.Close();
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	// read center-offset data
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		std::memcpy(&blockStates.peNodeOffsets[pathType][0], &buffer[pos], blockSize);
-		pos += blockSize;
+	std::uint8_t* offsetsData = cacheFileMap.GetData() + sizeof(header);
+	std::uint8_t* costsData = offsetsData + offsetsSize;
+
+	// copy center-offset data (small, and shared with the runtime block-states)
+	for (unsigned int pathType = 0; pathType < numMoveDefs; ++pathType) {
+		std::memcpy(&blockStates.peNodeOffsets[pathType][0], offsetsData + pathType * numBlocks * sizeof(short2), numBlocks * sizeof(short2));
 	}
 
-	// read vertex-cost data
-	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
+	// vertex-cost data stays mapped, later updates are copy-on-write
+	vertexCosts.Assign(reinterpret_cast<float*>(costsData), numVertexCosts);
+
+	// never trust the stored checksum, it feeds the synced PFS checksum
+	// (see CPathManager::Finalize); this pages in all cost data once, so
+	// mapping only saves the decompression and copy of the old format
+	// (unmodified pages stay file-backed and can be dropped by the OS)
+	pathChecksum = CalcChecksum(pathDigest.data());
+
+	if (pathChecksum != header.checksum) {
+		LOG_L(L_WARNING, "[PathEstimator::%s] checksum mismatch (%x != %x) for \"%s\", recalculating", __func__, pathChecksum, header.checksum, cacheFileName.c_str());
+
+		vertexCosts.Clear();
+		cacheFileMap.Close();
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
 	return true;
 }
 
@@ -1006,58 +1155,64 @@ void CPathEstimator::WriteFile(const std::string& baseFileName, const std::strin
 	if (!FileSystem::CreateDirectory(GetPathCacheDir()))
 		return;
 
-	const std::string hashHexString = IntToString(fileHashCode, "%x");
-	const std::string cacheFileName = GetPathCacheDir() + mapName + "." + baseFileName + "-" + hashHexString + ".zip";
+	const std::string cacheFileName = GetPathCacheFileName(mapName, baseFileName, fileHashCode);
+	const std::string tempFileName = cacheFileName + ".tmp";
 
-	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
+	LOG("[PathEstimator::%s] hash=%x file=\"%s\" (exists=%d)", __func__, fileHashCode, cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
-	// open file for writing in a suitable location
-	zipFile file = zipOpen(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE).c_str(), APPEND_STATUS_CREATE);
-
-	if (file == nullptr)
-		return;
+	const std::string cacheFilePath = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+	const std::string tempFilePath = dataDirsAccess.LocateFile(tempFileName, FileQueryFlags::WRITE);
 
-	zipOpenNewFileInZip(file, "pathinfo", nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_BEST_COMPRESSION);
+	PathCacheFileHeader header;
+	header.magic = PathCacheFileHeader::MAGIC;
+	header.version = PathCacheFileHeader::VERSION;
+	header.hashCode = fileHashCode;
+	header.blockSize = BLOCK_SIZE;
+	header.numMoveDefs = moveDefHandler.GetNumMoveDefs();
+	header.numBlocks = blockStates.GetSize();
+	header.numVertexCosts = vertexCosts.size();
+	header.checksum = pathChecksum;
 
-	// write hash-code (NOTE: this also affects the CRC!)
-	zipWriteInFileInZip(file, (const void*) &fileHashCode, 4);
+	{
+		// write to a temporary first, a concurrently starting client
+		// must never see (and map) a partially written cache-file
+		std::ofstream file(tempFilePath, std::ios::out | std::ios::binary | std::ios::trunc);
 
-	// write center-offsets
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		zipWriteInFileInZip(file, (const void*) &blockStates.peNodeOffsets[pathType][0], blockStates.peNodeOffsets[pathType].size() * sizeof(short2));
-	}
+		if (!file.good())
+			return;
 
-	// write vertex-costs
-	zipWriteInFileInZip(file, vertexCosts.data(), vertexCosts.size() * sizeof(float));
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
-	zipCloseFileInZip(file);
-	zipClose(file, nullptr);
+		// write center-offsets
+		for (unsigned int pathType = 0; pathType < header.numMoveDefs; ++pathType) {
+			file.write(reinterpret_cast<const char*>(blockStates.peNodeOffsets[pathType].data()), header.numBlocks * sizeof(short2));
+		}
 
+		// write vertex-costs
+		file.write(reinterpret_cast<const char*>(vertexCosts.data()), vertexCosts.size() * sizeof(float));
+		file.close();
 
-	// get the CRC over the written path data
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
+		if (file.fail()) {
+			FileSystem::Remove(tempFileName);
+			return;
+		}
+	}
 
-	if (upfile == nullptr || !upfile->IsOpen()) {
+	// rename fails on Windows if the target exists (e.g. written by another client)
+	if (FileSystem::FileExists(cacheFileName))
 		FileSystem::Remove(cacheFileName);
-		return;
-	}
 
-	assert(upfile->FindFile("pathinfo") < upfile->NumFiles());
-	// pointless; gets reassigned the output of CalcChecksum and CRC is not otherwise used
-	// pathChecksum = upfile->GetCrc32(upfile->FindFile("pathinfo"));
+	if (std::rename(tempFilePath.c_str(), cacheFilePath.c_str()) != 0)
+		FileSystem::Remove(tempFileName);
 }
 
 
-std::uint32_t CPathEstimator::CalcChecksum() const
+std::uint32_t CPathEstimator::CalcChecksum(std::uint8_t* shaBytes) const
 {
 	std::uint32_t cs = 0;
 	std::uint64_t nb = 0;
 
 	#if (ENABLE_NETLOG_CHECKSUM == 1)
-	std::array<char, 128 + sha512::SHA_LEN * 2 + 1> msgBuffer;
-
-	sha512::hex_digest hexChars;
-	sha512::raw_digest shaBytes;
 	sha512::msg_vector rawBytes;
 	#endif
 
@@ -1079,17 +1234,31 @@ std::uint32_t CPathEstimator::CalcChecksum() const
 		rawBytes.resize(rawBytes.size() + nb);
 
 		std::memcpy(&rawBytes[rawBytes.size() - nb], vertexCosts.data(), nb);
-		sha512::calc_digest(rawBytes, shaBytes); // hash(offsets|costs)
-		sha512::dump_digest(shaBytes, hexChars); // hexify(hash)
-
-		SNPRINTF(msgBuffer.data(), msgBuffer.size(), "[PE::%s][BLK_SIZE=%d][SHA_DATA=%s]", __func__, BLOCK_SIZE, hexChars.data());
-		CLIENT_NETLOG(gu->myPlayerNum, LOG_LEVEL_INFO, msgBuffer.data());
+		sha512::calc_digest(rawBytes.data(), rawBytes.size(), shaBytes); // hash(offsets|costs)
 	}
+	#else
+	std::memset(shaBytes, 0, sha512::SHA_LEN);
 	#endif
 
 	return cs;
 }
 
+void CPathEstimator::LogChecksum(const std::uint8_t* shaBytes) const
+{
+	#if (ENABLE_NETLOG_CHECKSUM == 1)
+	std::array<char, 128 + sha512::SHA_LEN * 2 + 1> msgBuffer;
+
+	sha512::hex_digest hexChars;
+	sha512::raw_digest rawBytes;
+
+	std::memcpy(rawBytes.data(), shaBytes, sha512::SHA_LEN);
+	sha512::dump_digest(rawBytes, hexChars); // hexify(hash)
+
+	SNPRINTF(msgBuffer.data(), msgBuffer.size(), "[PE::%s][BLK_SIZE=%d][SHA_DATA=%s]", __func__, BLOCK_SIZE, hexChars.data());
+	CLIENT_NETLOG(gu->myPlayerNum, LOG_LEVEL_INFO, msgBuffer.data());
+	#endif
+}
+
 
 /**
  * Returns a hash-code identifying the dataset of this estimator.
@@ -3,6 +3,7 @@
 #ifndef PATHESTIMATOR_H
 #define PATHESTIMATOR_H
 
+#include <array>
 #include <atomic>
 #include <cinttypes>
 #include <deque>
@@ -14,6 +15,7 @@
 #include "PathConstants.h"
 #include "PathDataTypes.h"
 #include "System/float3.h"
+#include "System/FileSystem/MemoryMappedFile.h"
 #include "System/Threading/SpringThreading.h"
 
 
@@ -24,6 +26,42 @@ class CPathFinderDef;
 class CPathCache;
 class CSolidObject;
 
+/**
+ * Vertex-costs either live in an owned buffer (freshly calculated)
+ * or point into the copy-on-write mapping of the PE cache-file, in
+ * which case costs of a MoveDef are only paged in when first used.
+ */
+class CVertexCosts {
+public:
+	void Alloc(size_t count, float value) {
+		buffer.clear();
+		buffer.resize(count, value);
+		Assign(buffer.data(), count);
+	}
+	void Assign(float* data, size_t count) {
+		costs = data;
+		numCosts = count;
+	}
+	void Clear() {
+		buffer.clear();
+		Assign(nullptr, 0);
+	}
+
+	      float& operator [] (size_t i)       { return costs[i]; }
+	const float& operator [] (size_t i) const { return costs[i]; }
+
+	      float* data()       { return costs; }
+	const float* data() const { return costs; }
+
+	size_t size() const { return numCosts; }
+
+private:
+	std::vector<float> buffer;
+
+	float* costs = nullptr;
+	size_t numCosts = 0;
+};
+
 class CPathEstimator: public IPathFinder {
 public:
 	/**
@@ -66,8 +104,9 @@ public:
 	std::uint32_t GetPathChecksum() const { return pathChecksum; }
 
 
-	const std::vector<float>& GetVertexCosts() const { return vertexCosts; }
+	const CVertexCosts& GetVertexCosts() const { return vertexCosts; }
 	const std::deque<int2>& GetUpdatedBlocks() const { return updatedBlocks; }
+	const CPathCache* GetPathCache(bool synced) const { return pathCache[synced]; }
 
 
 protected: // IPathFinder impl
@@ -107,6 +146,8 @@ protected: // IPathFinder impl
 private:
 	void InitEstimator(const std::string& cacheFileName, const std::string& mapName);
 	void InitBlocks();
+	void InitVertexCostPathFinders();
+	void PrioritizeUpdatedBlocks();
 
 	void CalcOffsetsAndPathCosts(unsigned int threadNum, spring::barrier* pathBarrier);
 	void CalculateBlockOffsets(unsigned int, unsigned int);
@@ -119,7 +160,10 @@ private:
 	bool ReadFile(const std::string& baseFileName, const std::string& mapName);
 	void WriteFile(const std::string& baseFileName, const std::string& mapName);
 
-	std::uint32_t CalcChecksum() const;
+	size_t GetNumVertexCosts() const;
+
+	std::uint32_t CalcChecksum(std::uint8_t* shaBytes) const;
+	void LogChecksum(const std::uint8_t* shaBytes) const;
 	std::uint32_t CalcHash(const char* caller) const;
 
 private:
@@ -134,6 +178,7 @@ private:
 	int blockUpdatePenalty = 0;
 
 	std::uint32_t pathChecksum = 0;
+	std::array<std::uint8_t, 64> pathDigest; // SHA512 over offsets and costs, for netlog
 	std::uint32_t fileHashCode = 0;
 
 	std::atomic<std::int64_t> offsetBlockNum = {0};
@@ -143,13 +188,20 @@ private:
 	CPathEstimator* nextPathEstimator; // next lower-resolution estimator
 	CPathCache* pathCache[2]; // [0] = !synced, [1] = synced
 
-	std::vector<IPathFinder*> pathFinders; // InitEstimator helpers
+	std::vector<IPathFinder*> pathFinders; // InitEstimator helpers, [0] = parent afterwards
+	std::vector<CPathFinder*> vertexCostPFs; // Update helpers ([1..] in pathFinders), only if parent is a PF
 	std::vector<spring::thread> threads;
 
 	std::vector<float> maxSpeedMods;
-	std::vector<float> vertexCosts;
+	CVertexCosts vertexCosts;
+	/// cache-file mapping backing vertexCosts, if it was read from disk
+	CMemoryMappedFile cacheFileMap;
 	/// blocks that may need an update due to map changes
 	std::deque<int2> updatedBlocks;
+	/// number of synced paths crossing each block, set by CPathManager
+	/// every UNIT_SLOWUPDATE_RATE frames while updates are backlogged
+	std::vector<std::uint32_t> blockPathCounts;
+	int blockPathCountsFrame = -1;
 
 	struct SOffsetBlock {
 		float cost;
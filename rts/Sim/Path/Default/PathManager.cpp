@@ -9,10 +9,13 @@
 #include "PathLog.h"
 #include "PathMemPool.h"
 #include "Map/MapInfo.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Objects/SolidObject.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/TimeProfiler.h"
 
 
@@ -20,6 +23,19 @@ static CPathFinder    gMaxResPF;
 static CPathEstimator gMedResPE;
 static CPathEstimator gLowResPE;
 
+enum {
+	PATH_LOW_RES = 0,
+	PATH_MED_RES = 1,
+	PATH_MAX_RES = 2,
+};
+
+// all indexed by PATH_*_RES
+static constexpr float PATH_SEARCH_DISTANCES[] = {std::numeric_limits<float>::max(), MEDRES_SEARCH_DISTANCE, MAXRES_SEARCH_DISTANCE};
+static constexpr unsigned int PATH_NODE_LIMITS[] = {MAX_SEARCHED_NODES_PE >> 3, MAX_SEARCHED_NODES_PE >> 3, MAX_SEARCHED_NODES_PF >> 3};
+
+static constexpr bool PATH_USE_CONSTRAINTS[] = {false, false, false};
+static constexpr bool PATH_ALLOW_RAW_SEARCH[] = {false, false, false};
+
 
 CPathManager::CPathManager()
 : maxResPF(nullptr)
@@ -46,6 +62,8 @@ CPathManager::~CPathManager()
 {
 	// Finalize is not called in case of forced exit
 	if (maxResPF != nullptr) {
+		KillHelperPathFinders();
+
 		lowResPE->Kill();
 		medResPE->Kill();
 		maxResPF->Kill();
@@ -73,6 +91,8 @@ std::int64_t CPathManager::Finalize() {
 		medResPE->Init(maxResPF, MEDRES_PE_BLOCKSIZE, "pe",  mapInfo->map.name);
 		lowResPE->Init(medResPE, LOWRES_PE_BLOCKSIZE, "pe2", mapInfo->map.name);
 
+		InitHelperPathFinders();
+
 		// make cached path data checksum part of synced state s.t. when
 		// any client has a corrupted or incorrect cache it desyncs from
 		// the start, not minutes later
@@ -127,15 +147,32 @@ IPath::SearchResult CPathManager::ArrangePath(
 	const float3& startPos,
 	const float3& goalPos,
 	CSolidObject* caller
+) const {
+	assert(newPath->moveDef == moveDef);
+
+	ArrangeState state;
+	ArrangeMaxResPath(state, newPath, startPos, goalPos, caller, maxResPF);
+	return (ArrangeLowResPath(state, newPath, startPos, caller));
+}
+
+void CPathManager::ArrangeMaxResPath(
+	ArrangeState& state,
+	MultiPath* newPath,
+	const float3& startPos,
+	const float3& goalPos,
+	const CSolidObject* caller,
+	IPathFinder* pathFinder
 ) const {
 	CPathFinderDef* pfDef = &newPath->peDef;
+	const MoveDef* moveDef = newPath->moveDef;
 
 	// choose the PF or the PE depending on the projected 2D goal-distance
 	// NOTE: this distance can be far smaller than the actual path length!
 	// NOTE: take height difference into consideration for "special" cases
 	// (unit at top of cliff, goal at bottom or vv.)
-	const float heurGoalDist2D = pfDef->Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE, 1) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE;
-	const float searchDistances[] = {std::numeric_limits<float>::max(), MEDRES_SEARCH_DISTANCE, MAXRES_SEARCH_DISTANCE};
+	state.heurGoalDist2D = pfDef->Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE, 1) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE;
+	state.bestSearch = -1u;
+	state.bestResult = IPath::Error;
 
 	// MAX_SEARCHED_NODES_PF is 65536, MAXRES_SEARCH_DISTANCE is 50 squares
 	// the circular-constraint area therefore is PI*50*50 squares (i.e. 7854
@@ -145,199 +182,101 @@ IPath::SearchResult CPathManager::ArrangePath(
 	assert(MAX_SEARCHED_NODES_PF <= 65536u);
 	assert(MAXRES_SEARCH_DISTANCE <= 50.0f);
 
-	constexpr unsigned int nodeLimits[] = {MAX_SEARCHED_NODES_PE >> 3, MAX_SEARCHED_NODES_PE >> 3, MAX_SEARCHED_NODES_PF >> 3};
+	if (state.heurGoalDist2D <= (MAXRES_SEARCH_DISTANCE * modInfo.pfRawDistMult)) {
+		pfDef->AllowRawPathSearch( true);
+		pfDef->AllowDefPathSearch(false); // block default search
 
-	constexpr bool useConstraints[] = {false, false, false};
-	constexpr bool allowRawSearch[] = {false, false, false};
+		// only the max-res CPathFinder implements DoRawSearch
+		state.bestResult = pathFinder->GetPath(*moveDef, *pfDef, caller, startPos, newPath->maxResPath, PATH_NODE_LIMITS[PATH_MAX_RES]);
+		state.bestSearch = PATH_MAX_RES;
 
-	IPathFinder* pathFinders[] = {lowResPE, medResPE, maxResPF};
-	IPath::Path* pathObjects[] = {&newPath->lowResPath, &newPath->medResPath, &newPath->maxResPath};
+		pfDef->AllowRawPathSearch(false);
+		pfDef->AllowDefPathSearch( true);
+	}
 
-	IPath::SearchResult bestResult = IPath::Error;
+	if (state.bestResult == IPath::Ok)
+		return;
 
-#if 1
+	// first step of the MAX to LOW sequence, see ArrangeLowResPath
+	if (state.heurGoalDist2D > PATH_SEARCH_DISTANCES[PATH_MAX_RES])
+		return;
 
-	unsigned int bestSearch = -1u; // index
+	pfDef->DisableConstraint(!PATH_USE_CONSTRAINTS[PATH_MAX_RES]);
+	pfDef->AllowRawPathSearch(PATH_ALLOW_RAW_SEARCH[PATH_MAX_RES]);
 
-	enum {
-		PATH_LOW_RES = 0,
-		PATH_MED_RES = 1,
-		PATH_MAX_RES = 2,
-	};
+	const IPath::SearchResult currResult = pathFinder->GetPath(*moveDef, *pfDef, caller, startPos, newPath->maxResPath, PATH_NODE_LIMITS[PATH_MAX_RES]);
 
-	{
-		if (heurGoalDist2D <= (MAXRES_SEARCH_DISTANCE * modInfo.pfRawDistMult)) {
-			pfDef->AllowRawPathSearch( true);
-			pfDef->AllowDefPathSearch(false); // block default search
+	if (currResult >= state.bestResult)
+		return;
 
-			// only the max-res CPathFinder implements DoRawSearch
-			bestResult = pathFinders[PATH_MAX_RES]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[PATH_MAX_RES], nodeLimits[PATH_MAX_RES]);
-			bestSearch = PATH_MAX_RES;
+	state.bestResult = currResult;
+	state.bestSearch = PATH_MAX_RES;
+}
 
-			pfDef->AllowRawPathSearch(false);
-			pfDef->AllowDefPathSearch( true);
-		}
+IPath::SearchResult CPathManager::ArrangeLowResPath(
+	ArrangeState& state,
+	MultiPath* newPath,
+	const float3& startPos,
+	const CSolidObject* caller
+) const {
+	CPathFinderDef* pfDef = &newPath->peDef;
+	const MoveDef* moveDef = newPath->moveDef;
 
-		if (bestResult != IPath::Ok) {
-			// try each pathfinder in order from MAX to LOW limited by distance,
-			// with constraints disabled for all three since these break search
-			// completeness (CPU usage is still limited by MAX_SEARCHED_NODES_*)
-			for (int n = PATH_MAX_RES; n >= PATH_LOW_RES; n--) {
-				// distance-limits are in ascending order
-				if (heurGoalDist2D > searchDistances[n])
-					continue;
+	// max-res searches were already done by ArrangeMaxResPath
+	IPathFinder* pathFinders[] = {lowResPE, medResPE, nullptr};
+	IPath::Path* pathObjects[] = {&newPath->lowResPath, &newPath->medResPath, &newPath->maxResPath};
 
-				pfDef->DisableConstraint(!useConstraints[n]);
-				pfDef->AllowRawPathSearch(allowRawSearch[n]);
+	if (state.bestResult != IPath::Ok) {
+		// try each pathfinder in order from MAX to LOW limited by distance,
+		// with constraints disabled for all three since these break search
+		// completeness (CPU usage is still limited by MAX_SEARCHED_NODES_*)
+		for (int n = PATH_MED_RES; n >= PATH_LOW_RES; n--) {
+			// distance-limits are in ascending order
+			if (state.heurGoalDist2D > PATH_SEARCH_DISTANCES[n])
+				continue;
 
-				const IPath::SearchResult currResult = pathFinders[n]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[n], nodeLimits[n]);
+			pfDef->DisableConstraint(!PATH_USE_CONSTRAINTS[n]);
+			pfDef->AllowRawPathSearch(PATH_ALLOW_RAW_SEARCH[n]);
 
-				// note: GEQ s.t. MED-OK will be preferred over LOW-OK, etc
-				if (currResult >= bestResult)
-					continue;
+			const IPath::SearchResult currResult = pathFinders[n]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[n], PATH_NODE_LIMITS[n]);
 
-				bestResult = currResult;
-				bestSearch = n;
+			// note: GEQ s.t. MED-OK will be preferred over LOW-OK, etc
+			if (currResult >= state.bestResult)
+				continue;
 
-				if (currResult == IPath::Ok)
-					break;
-			}
+			state.bestResult = currResult;
+			state.bestSearch = n;
+
+			if (currResult == IPath::Ok)
+				break;
 		}
 	}
 
 	for (unsigned int n = PATH_LOW_RES; n <= PATH_MAX_RES; n++) {
-		if (n != bestSearch) {
+		if (n != state.bestSearch) {
 			pathObjects[n]->path.clear();
 			pathObjects[n]->squares.clear();
 		}
 	}
 
-	if (bestResult == IPath::Ok)
-		return bestResult;
+	if (state.bestResult == IPath::Ok)
+		return state.bestResult;
 
 	// if we did not get a complete path with distance/search
 	// constraints enabled, run a final unconstrained fallback
 	// MED search (unconstrained MAX search is not useful with
 	// current node limits and could kill performance without)
-	if (heurGoalDist2D > searchDistances[PATH_MED_RES]) {
+	if (state.heurGoalDist2D > PATH_SEARCH_DISTANCES[PATH_MED_RES]) {
 		pfDef->DisableConstraint(true);
 
 		// we can only have a low-res result at this point
 		pathObjects[PATH_LOW_RES]->path.clear();
 		pathObjects[PATH_LOW_RES]->squares.clear();
 
-		bestResult = std::min(bestResult, pathFinders[PATH_MED_RES]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[PATH_MED_RES], nodeLimits[PATH_MED_RES]));
-	}
-
-	return bestResult;
-
-
-#else
-
-
-	enum {
-		PATH_MAX_RES = 0,
-		PATH_MED_RES = 1,
-		PATH_LOW_RES = 3
-	};
-
-	int origPathRes = PATH_LOW_RES;
-
-	// first attempt - use ideal pathfinder (performance-wise)
-	{
-		if (heurGoalDist2D < MAXRES_SEARCH_DISTANCE) {
-			origPathRes = PATH_MAX_RES;
-		} else if (heurGoalDist2D < MEDRES_SEARCH_DISTANCE) {
-			origPathRes = PATH_MED_RES;
-		//} else {
-		//	origPathRes = PATH_LOW_RES;
-		}
-
-		switch (origPathRes) {
-			case PATH_MAX_RES: bestResult = maxResPF->GetPath(*moveDef, *pfDef, caller, startPos, newPath->maxResPath, nodeLimits[2]); break;
-			case PATH_MED_RES: bestResult = medResPE->GetPath(*moveDef, *pfDef, caller, startPos, newPath->medResPath, nodeLimits[1]); break;
-			case PATH_LOW_RES: bestResult = lowResPE->GetPath(*moveDef, *pfDef, caller, startPos, newPath->lowResPath, nodeLimits[0]); break;
-		}
-
-		if (bestResult == IPath::Ok) {
-			return bestResult;
-		}
+		state.bestResult = std::min(state.bestResult, pathFinders[PATH_MED_RES]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[PATH_MED_RES], PATH_NODE_LIMITS[PATH_MED_RES]));
 	}
 
-	// second attempt - try to reverse path
-	/*{
-		CCircularSearchConstraint reversedPfDef(goalPos, startPos, pfDef->sqGoalRadius, 7.0f, 8000);
-		switch (pathres) {
-			case PATH_MAX_RES: bestResult = maxResPF->GetPath(*moveDef, reversedPfDef, caller, goalPos, newPath->maxResPath, nodeLimits[2]); break;
-			case PATH_MED_RES: bestResult = medResPE->GetPath(*moveDef, reversedPfDef, caller, goalPos, newPath->medResPath, nodeLimits[1]); break;
-			case PATH_LOW_RES: bestResult = lowResPE->GetPath(*moveDef, reversedPfDef, caller, goalPos, newPath->lowResPath, nodeLimits[0]); break;
-		}
-
-		if (bestResult == IPath::Ok) {
-			assert(false);
-
-			float3 midPos;
-			switch (pathres) {
-				case PATH_MAX_RES: midPos = newPath->maxResPath.path.back(); break;
-				case PATH_MED_RES: midPos = newPath->medResPath.path.back(); break;
-				case PATH_LOW_RES: midPos = newPath->lowResPath.path.back(); break;
-			}
-
-			CCircularSearchConstraint midPfDef(startPos, midPos, pfDef->sqGoalRadius, 3.0f, 8000);
-			bestResult = maxResPF->GetPath(*moveDef, midPfDef, caller, startPos, newPath->maxResPath, MAX_SEARCHED_NODES_PF >> 3);
-
-			CCircularSearchConstraint restPfDef(midPos, goalPos, pfDef->sqGoalRadius, 7.0f, 8000);
-			switch (pathres) {
-				case PATH_MAX_RES:
-				case PATH_MED_RES: bestResult = medResPE->GetPath(*moveDef, restPfDef, caller, startPos, newPath->medResPath, nodeLimits[1]); break;
-				case PATH_LOW_RES: bestResult = lowResPE->GetPath(*moveDef, restPfDef, caller, startPos, newPath->lowResPath, nodeLimits[0]); break;
-			}
-
-			return bestResult;
-
-		}
-	}*/
-
-	// third attempt - use better pathfinder
-	{
-		int advPathRes = origPathRes;
-		int maxRes = (heurGoalDist2D < (MAXRES_SEARCH_DISTANCE * 2.0f)) ? PATH_MAX_RES : PATH_MED_RES;
-
-		while (--advPathRes >= maxRes) {
-			switch (advPathRes) {
-				case PATH_MAX_RES: bestResult = maxResPF->GetPath(*moveDef, *pfDef, caller, startPos, newPath->maxResPath, nodeLimits[2]); break;
-				case PATH_MED_RES: bestResult = medResPE->GetPath(*moveDef, *pfDef, caller, startPos, newPath->medResPath, nodeLimits[1]); break;
-				case PATH_LOW_RES: bestResult = lowResPE->GetPath(*moveDef, *pfDef, caller, startPos, newPath->lowResPath, nodeLimits[0]); break;
-			}
-
-			if (bestResult == IPath::Ok) {
-				return bestResult;
-			}
-		}
-	}
-
-	// fourth attempt - unconstrained search radius (performance heavy, esp. on max_res)
-	pfDef->DisableConstraint(true);
-	if (origPathRes > PATH_MAX_RES) {
-		int advPathRes = origPathRes;
-		int maxRes = PATH_MED_RES;
-
-		while (--advPathRes >= maxRes) {
-			switch (advPathRes) {
-				case PATH_MAX_RES: bestResult = maxResPF->GetPath(*moveDef, *pfDef, caller, startPos, newPath->maxResPath, nodeLimits[2]); break;
-				case PATH_MED_RES: bestResult = medResPE->GetPath(*moveDef, *pfDef, caller, startPos, newPath->medResPath, nodeLimits[1]); break;
-				case PATH_LOW_RES: bestResult = lowResPE->GetPath(*moveDef, *pfDef, caller, startPos, newPath->lowResPath, nodeLimits[0]); break;
-			}
-
-			if (bestResult == IPath::Ok) {
-				return bestResult;
-			}
-		}
-	}
-
-	LOG_L(L_DEBUG, "PathManager: no path found");
-	return bestResult;
-	#endif
+	return state.bestResult;
 }
 
 
@@ -369,6 +308,14 @@ unsigned int CPathManager::RequestPath(
 	newPath.caller = caller;
 	newPath.peDef.synced = synced;
 
+	if (modInfo.pfAsyncRequests && synced && caller != nullptr) {
+		// resolved by the next Update; until then NextWayPoint
+		// hands out temporary waypoints toward the final goal
+		newPath.pending = true;
+		queuedPathIDs.push_back(Store(newPath));
+		return (queuedPathIDs.back());
+	}
+
 	if (caller != nullptr)
 		caller->UnBlock();
 
@@ -380,7 +327,7 @@ unsigned int CPathManager::RequestPath(
 		if (newPath.maxResPath.path.empty()) {
 			if (result != IPath::CantGetCloser) {
 				LowRes2MedRes(newPath, startPos, caller, synced);
-				MedRes2MaxRes(newPath, startPos, caller, synced);
+				MedRes2MaxRes(newPath, startPos, caller, synced, maxResPF);
 			} else {
 				// add one dummy waypoint so that the calling MoveType
 				// does not consider this request a failure, which can
@@ -407,7 +354,7 @@ unsigned int CPathManager::RequestPath(
 
 
 // converts part of a med-res path into a max-res path
-void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced) const
+void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced, IPathFinder* pathFinder) const
 {
 	assert(IsFinalized());
 
@@ -440,7 +387,7 @@ void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, c
 	// Perform the search.
 	// If this is the final improvement of the path, then use the original goal.
 	const auto& pfd = (medResPath.path.empty() && lowResPath.path.empty()) ? multiPath.peDef : rangedGoalDef;
-	const IPath::SearchResult result = maxResPF->GetPath(*multiPath.moveDef, pfd, owner, startPos, maxResPath, MAX_SEARCHED_NODES_ON_REFINE);
+	const IPath::SearchResult result = pathFinder->GetPath(*multiPath.moveDef, pfd, owner, startPos, maxResPath, MAX_SEARCHED_NODES_ON_REFINE);
 
 	// If no refined path could be found, set goal as desired goal.
 	if (result == IPath::CantGetCloser || result == IPath::Error) {
@@ -517,6 +464,13 @@ float3 CPathManager::NextWayPoint(
 	if (multiPath == nullptr)
 		return noPathPoint;
 
+	if (multiPath->pending) {
+		// queued request, keep the caller moving a fixed small distance
+		// toward its goal; y=-1 tells GMT this is a temporary waypoint
+		const float3 goalDir = (multiPath->finalGoal - callerPos).SafeNormalize2D() * SQUARE_SIZE;
+		return float3(callerPos.x + goalDir.x, -1.0f, callerPos.z + goalDir.z);
+	}
+
 	if (numRetries > MAX_PATH_REFINEMENT_DEPTH)
 		return (multiPath->finalGoal);
 
@@ -544,7 +498,7 @@ float3 CPathManager::NextWayPoint(
 		if (extendMedResPath)
 			LowRes2MedRes(*multiPath, callerPos, owner, synced);
 
-		MedRes2MaxRes(*multiPath, callerPos, owner, synced);
+		MedRes2MaxRes(*multiPath, callerPos, owner, synced, maxResPF);
 
 		if (multiPath->caller != nullptr)
 			multiPath->caller->Block();
@@ -586,7 +540,7 @@ float3 CPathManager::NextWayPoint(
 	} while ((callerPos.SqDistance2D(waypoint) < Square(radius)) && (waypoint != maxResPath.pathGoal));
 
 	// y=0 indicates this is not a temporary waypoint
-	// (the default PFS does not queue path-requests)
+	// (queued requests are handled above)
 	return (waypoint * XZVector);
 }
 
@@ -612,13 +566,207 @@ void CPathManager::Update()
 	SCOPED_TIMER("Sim::Path");
 	assert(IsFinalized());
 
+	// resolve requests queued during the previous frame before
+	// the PE's process this frame's block-updates
+	UpdateQueuedPaths();
+
 	pathFlowMap->Update();
 	pathHeatMap->Update();
 
+	UpdateBlockPathCounts(medResPE);
+	UpdateBlockPathCounts(lowResPE);
+
 	medResPE->Update();
 	lowResPE->Update();
 }
 
+// lets the PE's update the blocks crossed by the most paths first
+void CPathManager::UpdateBlockPathCounts(CPathEstimator* pe) const
+{
+	// counts only matter while more blocks are queued than can be
+	// processed in a frame, and are too costly to gather each frame
+	if ((pe->updatedBlocks.size() * moveDefHandler.GetNumMoveDefs()) <= pe->BLOCKS_TO_UPDATE)
+		return;
+	if ((gs->frameNum % UNIT_SLOWUPDATE_RATE) != 0)
+		return;
+
+	std::vector<std::uint32_t>& blockPathCounts = pe->blockPathCounts;
+	std::fill(blockPathCounts.begin(), blockPathCounts.end(), 0);
+
+	for (const auto& p: pathMap) {
+		const MultiPath& multiPath = p.second;
+
+		// unsynced paths differ between clients
+		if (!multiPath.peDef.synced)
+			continue;
+
+		unsigned int prevBlockIdx = -1u;
+
+		for (const IPath::Path* path: {&multiPath.maxResPath, &multiPath.medResPath, &multiPath.lowResPath}) {
+			for (const float3& wayPoint: path->path) {
+				const int2 blockPos = {
+					Clamp(int(wayPoint.x / pe->BLOCK_PIXEL_SIZE), 0, pe->nbrOfBlocks.x - 1),
+					Clamp(int(wayPoint.z / pe->BLOCK_PIXEL_SIZE), 0, pe->nbrOfBlocks.y - 1)
+				};
+				const unsigned int blockIdx = pe->BlockPosToIdx(blockPos);
+
+				// count each path once per run of waypoints inside a block
+				if (blockIdx == prevBlockIdx)
+					continue;
+
+				blockPathCounts[blockIdx] += 1;
+				prevBlockIdx = blockIdx;
+			}
+		}
+	}
+
+	pe->blockPathCountsFrame = gs->frameNum;
+}
+
+void CPathManager::InitHelperPathFinders()
+{
+	if (!modInfo.pfAsyncRequests)
+		return;
+
+	// keep the total memory-footprint made by the helpers within bounds
+	// (same limit as for the PF's creating the PE caches at load-time)
+	const unsigned int minMemFootPrint = sizeof(CPathFinder) + maxResPF->GetMemFootPrint();
+	const unsigned int maxMemFootPrint = configHandler->GetInt("MaxPathCostsMemoryFootPrint") * 1024 * 1024;
+	const unsigned int numHelperPFs = Clamp(int(maxMemFootPrint / minMemFootPrint), 0, ThreadPool::GetNumThreads());
+
+	// a single helper would not run anything in parallel
+	if (numHelperPFs <= 1)
+		return;
+
+	helperPFs.resize(numHelperPFs, nullptr);
+
+	for (CPathFinder*& pf: helperPFs) {
+		pf = pfMemPool.alloc<CPathFinder>(true);
+	}
+
+	LOG("[PathManager::%s] using %u helper PF's (%u MB) for queued requests", __func__, numHelperPFs, (minMemFootPrint * numHelperPFs) / (1024 * 1024));
+}
+
+void CPathManager::KillHelperPathFinders()
+{
+	for (CPathFinder* pf: helperPFs) {
+		pf->Kill();
+		pfMemPool.free(pf);
+	}
+
+	helperPFs.clear();
+}
+
+
+template<typename F> void CPathManager::ForEachQueuedPath(F&& func)
+{
+	if (helperPFs.empty()) {
+		for (size_t i = 0; i < queuedPaths.size(); i++) {
+			func(i, maxResPF);
+		}
+
+		return;
+	}
+
+	// every task owns one helper, requests are distributed round-robin
+	const size_t numTasks = std::min(helperPFs.size(), queuedPaths.size());
+
+	for_mt(0, numTasks, [&](const int taskNum) {
+		for (size_t i = taskNum; i < queuedPaths.size(); i += numTasks) {
+			func(i, helperPFs[taskNum]);
+		}
+	});
+}
+
+void CPathManager::UpdateQueuedPaths()
+{
+	if (queuedPathIDs.empty())
+		return;
+
+	SCOPED_TIMER("Sim::Path::QueuedRequests");
+
+	queuedPaths.clear();
+	queuedPaths.reserve(queuedPathIDs.size());
+
+	// skip requests whose path was deleted while queued
+	for (const unsigned int pathID: queuedPathIDs) {
+		MultiPath* multiPath = GetMultiPath(pathID);
+
+		if (multiPath == nullptr)
+			continue;
+
+		assert(multiPath->pending);
+		queuedPaths.push_back(multiPath);
+	}
+
+	queuedStates.clear();
+	queuedStates.resize(queuedPaths.size());
+
+	// the max-res PF searches (raw, short-range and refinement) touch no
+	// shared state and can run in parallel; the PE's have shared search
+	// state and path-caches, so med- and low-res searches are made on the
+	// main thread in request order which keeps the results deterministic
+	ForEachQueuedPath([&](size_t i, IPathFinder* pathFinder) {
+		MultiPath* multiPath = queuedPaths[i];
+		ArrangeMaxResPath(queuedStates[i], multiPath, multiPath->start, multiPath->finalGoal, multiPath->caller, pathFinder);
+	});
+
+	for (size_t i = 0; i < queuedPaths.size(); i++) {
+		MultiPath* multiPath = queuedPaths[i];
+		ArrangeState& state = queuedStates[i];
+
+		multiPath->caller->UnBlock();
+
+		state.bestResult = ArrangeLowResPath(state, multiPath, multiPath->start, multiPath->caller);
+
+		if (state.bestResult != IPath::Error && state.bestResult != IPath::CantGetCloser && multiPath->maxResPath.path.empty())
+			LowRes2MedRes(*multiPath, multiPath->start, multiPath->caller, true);
+
+		multiPath->caller->Block();
+	}
+
+	ForEachQueuedPath([&](size_t i, IPathFinder* pathFinder) {
+		MultiPath* multiPath = queuedPaths[i];
+		const ArrangeState& state = queuedStates[i];
+
+		if (state.bestResult != IPath::Error && state.bestResult != IPath::CantGetCloser && multiPath->maxResPath.path.empty())
+			MedRes2MaxRes(*multiPath, multiPath->start, multiPath->caller, true, pathFinder);
+	});
+
+	for (size_t i = 0; i < queuedPaths.size(); i++) {
+		MultiPath* multiPath = queuedPaths[i];
+		const IPath::SearchResult result = queuedStates[i].bestResult;
+
+		multiPath->pending = false;
+		multiPath->searchResult = result;
+
+		if (result == IPath::Error)
+			continue;
+
+		// dummy waypoint for CantGetCloser, see RequestPath
+		if (result == IPath::CantGetCloser && multiPath->maxResPath.path.empty()) {
+			multiPath->maxResPath.path.push_back(multiPath->start);
+			multiPath->maxResPath.squares.push_back(int2(multiPath->start.x / SQUARE_SIZE, multiPath->start.z / SQUARE_SIZE));
+		}
+
+		FinalizePath(multiPath, multiPath->start, multiPath->finalGoal, result == IPath::CantGetCloser);
+	}
+
+	// failed requests are treated as if RequestPath had returned 0,
+	// the caller fails on its next NextWayPoint
+	for (const unsigned int pathID: queuedPathIDs) {
+		const MultiPath* multiPath = GetMultiPathConst(pathID);
+
+		if (multiPath == nullptr || multiPath->searchResult != IPath::Error)
+			continue;
+
+		pathMap.erase(pathID);
+	}
+
+	queuedPathIDs.clear();
+	queuedPaths.clear();
+}
+
 // used to deposit heat on the heat-map as a unit moves along its path
 void CPathManager::UpdatePath(const CSolidObject* owner, unsigned int pathID)
 {
@@ -734,6 +882,14 @@ bool CPathManager::SetNodeExtraCost(unsigned int x, unsigned int z, float cost,
 	maxResBuf.SetNodeExtraCost(x, z, cost, synced);
 	medResBuf.SetNodeExtraCost(x, z, cost, synced);
 	lowResBuf.SetNodeExtraCost(x, z, cost, synced);
+
+	for (CPathFinder* pf: helperPFs) {
+		pf->GetNodeStateBuffer().SetNodeExtraCost(x, z, cost, synced);
+	}
+	for (CPathFinder* pf: medResPE->vertexCostPFs) {
+		pf->GetNodeStateBuffer().SetNodeExtraCost(x, z, cost, synced);
+	}
+
 	return true;
 }
 
@@ -752,6 +908,14 @@ bool CPathManager::SetNodeExtraCosts(const float* costs, unsigned int sizex, uns
 	maxResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
 	medResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
 	lowResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
+
+	for (CPathFinder* pf: helperPFs) {
+		pf->GetNodeStateBuffer().SetNodeExtraCosts(costs, sizex, sizez, synced);
+	}
+	for (CPathFinder* pf: medResPE->vertexCostPFs) {
+		pf->GetNodeStateBuffer().SetNodeExtraCosts(costs, sizex, sizez, synced);
+	}
+
 	return true;
 }
 
@@ -787,3 +951,13 @@ int2 CPathManager::GetNumQueuedUpdates() const {
 	return data;
 }
 
+IPathManager::PathCacheStats CPathManager::GetPathCacheStats(bool synced) const {
+	PathCacheStats stats;
+
+	if (IsFinalized()) {
+		medResPE->GetPathCache(synced)->AddStats(stats);
+		lowResPE->GetPathCache(synced)->AddStats(stats);
+	}
+
+	return stats;
+}
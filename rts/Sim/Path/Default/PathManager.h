@@ -4,6 +4,7 @@
 #define PATHMANAGER_H
 
 #include <cinttypes>
+#include <vector>
 
 #include "Sim/Path/IPathManager.h"
 #include "IPath.h"
@@ -11,6 +12,7 @@
 #include "System/UnorderedMap.hpp"
 
 class CSolidObject;
+class IPathFinder;
 class CPathFinder;
 class CPathEstimator;
 class PathFlowMap;
@@ -48,6 +50,8 @@ public:
 			moveDef = mp.moveDef;
 			caller  = mp.caller;
 
+			pending = mp.pending;
+
 			mp.moveDef = nullptr;
 			mp.caller  = nullptr;
 			return *this;
@@ -70,6 +74,9 @@ public:
 
 		// additional information
 		CSolidObject* caller;
+
+		// true while queued for the next Update (modInfo.pfAsyncRequests)
+		bool pending = false;
 	};
 
 public:
@@ -143,6 +150,7 @@ public:
 	const float* GetNodeExtraCosts(bool) const override;
 
 	int2 GetNumQueuedUpdates() const override;
+	PathCacheStats GetPathCacheStats(bool synced) const override;
 
 
 	const CPathFinder* GetMaxResPF() const { return maxResPF; }
@@ -155,6 +163,16 @@ public:
 	const spring::unordered_map<unsigned int, MultiPath>& GetPathMap() const { return pathMap; }
 
 private:
+	// intermediate state between the max-res and the lower-res
+	// parts of ArrangePath, so that these can run in separate
+	// passes (the former on helper PF's) for queued requests
+	struct ArrangeState {
+		float heurGoalDist2D = 0.0f;
+
+		unsigned int bestSearch = -1u;
+		IPath::SearchResult bestResult = IPath::Error;
+	};
+
 	IPath::SearchResult ArrangePath(
 		MultiPath* newPath,
 		const MoveDef* moveDef,
@@ -163,6 +181,28 @@ private:
 		CSolidObject* caller
 	) const;
 
+	void ArrangeMaxResPath(
+		ArrangeState& state,
+		MultiPath* newPath,
+		const float3& startPos,
+		const float3& goalPos,
+		const CSolidObject* caller,
+		IPathFinder* pathFinder
+	) const;
+	IPath::SearchResult ArrangeLowResPath(
+		ArrangeState& state,
+		MultiPath* newPath,
+		const float3& startPos,
+		const CSolidObject* caller
+	) const;
+
+	template<typename F> void ForEachQueuedPath(F&& func);
+
+	void InitHelperPathFinders();
+	void KillHelperPathFinders();
+	void UpdateQueuedPaths();
+	void UpdateBlockPathCounts(CPathEstimator* pe) const;
+
 	MultiPath* GetMultiPath(int pathID) { return (const_cast<MultiPath*>(GetMultiPathConst(pathID))); }
 
 	const MultiPath* GetMultiPathConst(int pathID) const {
@@ -181,7 +221,7 @@ private:
 	static void FinalizePath(MultiPath* path, const float3 startPos, const float3 goalPos, const bool cantGetCloser);
 
 	void LowRes2MedRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
-	void MedRes2MaxRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced) const;
+	void MedRes2MaxRes(MultiPath& path, const float3& startPos, const CSolidObject* owner, bool synced, IPathFinder* pathFinder) const;
 
 	bool IsFinalized() const { return (maxResPF != nullptr); }
 
@@ -195,6 +235,13 @@ private:
 
 	spring::unordered_map<unsigned int, MultiPath> pathMap;
 
+	// thread-safe max-res PF's used to resolve queued requests in parallel
+	std::vector<CPathFinder*> helperPFs;
+
+	std::vector<unsigned int> queuedPathIDs;
+	std::vector<MultiPath*> queuedPaths;
+	std::vector<ArrangeState> queuedStates;
+
 	unsigned int nextPathID;
 };
 
@@ -169,6 +169,28 @@ public:
 	virtual const float* GetNodeExtraCosts(bool synced) const { return nullptr; }
 
 	virtual int2 GetNumQueuedUpdates() const { return (int2(0, 0)); }
+
+	struct PathCacheStats {
+		std::uint32_t numHits = 0;
+		std::uint32_t numNearHits = 0; // subset of numHits served by a path from a neighbouring start-block
+		std::uint32_t numMisses = 0;
+		std::uint32_t numEvictions = 0; // LRU paths dropped because the cache was full
+		std::uint32_t numExpirations = 0; // paths dropped because their lifetime ran out
+		std::uint32_t numCachedPaths = 0;
+	};
+
+	virtual PathCacheStats GetPathCacheStats(bool synced) const { return {}; }
+
+	// summed over all layers, only maintained by QTPFS
+	struct LayerUpdateStats {
+		std::uint32_t numQueuedRects = 0;
+		std::uint32_t numMergedRects = 0; // subset of numQueuedRects coalesced with another rectangle
+		std::uint32_t numExecutedRects = 0;
+		std::uint32_t numTesselatedRects = 0; // subset of numExecutedRects that changed a tree
+		std::uint32_t numPendingRects = 0;
+	};
+
+	virtual LayerUpdateStats GetLayerUpdateStats() const { return {}; }
 };
 
 extern IPathManager* pathManager;
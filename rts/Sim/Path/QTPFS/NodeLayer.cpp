@@ -70,12 +70,43 @@ void QTPFS::NodeLayer::Clear() {
 	#ifdef QTPFS_STAGGERED_LAYER_UPDATES
 	layerUpdates.clear();
 	#endif
+
+	updateStats = {};
 }
 
 
 
 #ifdef QTPFS_STAGGERED_LAYER_UPDATES
-void QTPFS::NodeLayer::QueueUpdate(const SRectangle& r, const MoveDef* md) {
+void QTPFS::NodeLayer::QueueUpdate(const SRectangle& qr, const MoveDef* md) {
+	SRectangle r = qr;
+
+	updateStats.numQueuedRects += 1;
+
+	// coalesce with rectangles queued earlier in the same frame (an object
+	// changes the height- and then the blocking-map, explosions overlap) if
+	// their bounding box covers no more squares than both did separately;
+	// the merged snapshot below is taken from the current terrain-state so
+	// it supersedes the older ones
+	for (bool merged = true; merged; ) {
+		merged = false;
+
+		for (auto it = layerUpdates.rbegin(); it != layerUpdates.rend() && it->frameNum == gs->frameNum; ++it) {
+			const SRectangle& ur = it->rectangle;
+			const SRectangle br = {std::min(r.x1, ur.x1), std::min(r.z1, ur.z1),  std::max(r.x2, ur.x2), std::max(r.z2, ur.z2)};
+
+			if (br.GetArea() > (r.GetArea() + ur.GetArea()))
+				continue;
+
+			r = br;
+
+			layerUpdates.erase(std::next(it).base());
+			updateStats.numMergedRects += 1;
+
+			merged = true;
+			break;
+		}
+	}
+
 	layerUpdates.emplace_back();
 	LayerUpdate& layerUpdate = layerUpdates.back();
 
@@ -85,6 +116,7 @@ void QTPFS::NodeLayer::QueueUpdate(const SRectangle& r, const MoveDef* md) {
 	layerUpdate.speedMods.resize(r.GetArea());
 	layerUpdate.blockBits.resize(r.GetArea());
 	layerUpdate.counter = ++updateCounter;
+	layerUpdate.frameNum = gs->frameNum;
 
 	// make a snapshot of the terrain-state within <r>
 	for (unsigned int hmz = r.z1; hmz < r.z2; hmz++) {
@@ -108,7 +140,11 @@ bool QTPFS::NodeLayer::ExecQueuedUpdate() {
 	const std::vector<float>* speedMods = &layerUpdate.speedMods;
 	const std::vector<  int>* blockBits = &layerUpdate.blockBits;
 
-	return (Update(rectangle, moveDefHandler.GetMoveDefByPathType(layerNumber), speedMods, blockBits));
+	const bool needTesselation = Update(rectangle, moveDefHandler.GetMoveDefByPathType(layerNumber), speedMods, blockBits);
+
+	updateStats.numExecutedRects += 1;
+	updateStats.numTesselatedRects += needTesselation;
+	return needTesselation;
 }
 #endif
 
@@ -25,6 +25,8 @@ namespace QTPFS {
 		std::vector<int  > blockBits;
 
 		unsigned int counter;
+		// sim-frame during which the update was queued
+		int frameNum;
 	};
 	#endif
 
@@ -55,6 +57,15 @@ namespace QTPFS {
 		unsigned int NumQueuedUpdates() const { return (layerUpdates.size()); }
 		#endif
 
+		struct UpdateStats {
+			unsigned int numQueuedRects = 0; // terrain-change rectangles passed to QueueUpdate
+			unsigned int numMergedRects = 0; // queued rectangles coalesced into another one
+			unsigned int numExecutedRects = 0; // (coalesced) rectangles consumed by ExecQueuedUpdate
+			unsigned int numTesselatedRects = 0; // executed rectangles that needed re-tesselation
+		};
+
+		const UpdateStats& GetUpdateStats() const { return updateStats; }
+
 		bool Update(
 			const SRectangle& r,
 			const MoveDef* md,
@@ -163,6 +174,8 @@ namespace QTPFS {
 		unsigned int numLeafNodes = 0;
 		unsigned int updateCounter = 0;
 
+		UpdateStats updateStats;
+
 		unsigned int xsize = 0;
 		unsigned int zsize = 0;
 
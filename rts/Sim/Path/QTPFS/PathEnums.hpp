@@ -40,6 +40,14 @@ namespace QTPFS {
 		PATH_SEARCH_ASTAR    = 0,
 		PATH_SEARCH_DIJKSTRA = 1,
 	};
+	enum {
+		SEARCH_STATUS_QUEUED   = 0, // not (yet) scheduled, e.g. held back by the team search-limit
+		SEARCH_STATUS_EXECUTE  = 1,
+		SEARCH_STATUS_SHARED   = 2, // may reuse the path of an identical search executed earlier
+		SEARCH_STATUS_FINISHED = 3,
+		SEARCH_STATUS_FAILED   = 4,
+		SEARCH_STATUS_DISCARD  = 5, // temp-path was deleted before the search could run
+	};
 	enum {
 		PATH_TYPE_TEMP = 0,
 		PATH_TYPE_LIVE = 1,
@@ -148,7 +148,10 @@ QTPFS::PathManager::~PathManager() {
 	numCurrExecutedSearches.clear();
 	numPrevExecutedSearches.clear();
 
-	PathSearch::FreeGlobalQueue();
+	sharedPaths.clear();
+	searchStateOffsets.clear();
+
+	PathSearch::FreeGlobalQueues();
 
 	#ifdef QTPFS_ENABLE_THREADED_UPDATE
 	// at this point the thread is waiting, so notify it
@@ -185,8 +188,6 @@ void QTPFS::PathManager::InitStatic() {
 }
 
 void QTPFS::PathManager::Load() {
-	// NOTE: offset *must* start at a non-zero value
-	searchStateOffset = NODE_STATE_OFFSET;
 	numTerrainChanges = 0;
 	numPathRequests   = 0;
 	maxNumLeafNodes   = 0;
@@ -195,6 +196,9 @@ void QTPFS::PathManager::Load() {
 	nodeLayers.resize(moveDefHandler.GetNumMoveDefs());
 	pathCaches.resize(moveDefHandler.GetNumMoveDefs());
 	pathSearches.resize(moveDefHandler.GetNumMoveDefs());
+	sharedPaths.resize(moveDefHandler.GetNumMoveDefs());
+	// NOTE: offsets *must* start at a non-zero value
+	searchStateOffsets.resize(moveDefHandler.GetNumMoveDefs(), NODE_STATE_OFFSET);
 
 	// add one extra element for object-less requests
 	numCurrExecutedSearches.resize(teamHandler.ActiveTeams() + 1, 0);
@@ -247,7 +251,7 @@ void QTPFS::PathManager::Load() {
 
 		{ SyncedUint tmp(pfsCheckSum); }
 
-		PathSearch::InitGlobalQueue(maxNumLeafNodes);
+		PathSearch::InitGlobalQueues(maxNumLeafNodes);
 	}
 
 	{
@@ -710,7 +714,7 @@ void QTPFS::PathManager::ThreadUpdate() {
 		static unsigned int minPathTypeUpdate = 0;
 		static unsigned int maxPathTypeUpdate = numPathTypeUpdates;
 
-		sharedPaths.clear();
+		searchHashes.clear();
 
 		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
 			#ifndef QTPFS_IGNORE_DEAD_PATHS
@@ -722,7 +726,24 @@ void QTPFS::PathManager::ThreadUpdate() {
 			ExecQueuedNodeLayerUpdates(pathTypeUpdate, !pathSearches[pathTypeUpdate].empty());
 			#endif
 
-			ExecuteQueuedSearches(pathTypeUpdate);
+			// serial; team search-limits are shared by all layers
+			PrepareQueuedSearches(pathTypeUpdate);
+		}
+
+		{
+			// layers own disjoint node-trees and path-caches, so their
+			// searches can run concurrently (serially within a layer to
+			// keep results independent of the number of threads)
+			const unsigned int minPathType = minPathTypeUpdate;
+			const unsigned int maxPathType = maxPathTypeUpdate;
+
+			for_mt(minPathType, maxPathType, [this](const int pathType) {
+				ExecuteQueuedSearches(pathType);
+			});
+		}
+
+		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
+			FinalizeQueuedSearches(pathTypeUpdate);
 		}
 
 		std::copy(numCurrExecutedSearches.begin(), numCurrExecutedSearches.end(), numPrevExecutedSearches.begin());
@@ -747,66 +768,35 @@ void QTPFS::PathManager::ThreadUpdate() {
 
 
 
-void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType) {
+void QTPFS::PathManager::PrepareQueuedSearches(unsigned int pathType) {
 	NodeLayer& nodeLayer = nodeLayers[pathType];
 	PathCache& pathCache = pathCaches[pathType];
 
-	std::vector<IPathSearch*>& searches = pathSearches[pathType];
-	std::vector<IPathSearch*>::iterator searchesIt = searches.begin();
-
-	if (!searches.empty()) {
-		// execute pending searches collected via
-		// RequestPath and QueueDeadPathSearches
-		while (searchesIt != searches.end()) {
-			if (ExecuteSearch(searches, searchesIt, nodeLayer, pathCache, pathType)) {
-				searchStateOffset += NODE_STATE_OFFSET;
-			}
-		}
-	}
-}
-
-bool QTPFS::PathManager::ExecuteSearch(
-	PathSearchVect& searches,
-	PathSearchVectIt& searchesIt,
-	NodeLayer& nodeLayer,
-	PathCache& pathCache,
-	unsigned int pathType
-) {
-	IPathSearch* search = *searchesIt;
-	IPath* path = pathCache.GetTempPath(search->GetID());
+	// decide which of the pending searches collected via RequestPath
+	// and QueueDeadPathSearches get to run (or share a path) this time
+	for (IPathSearch* search: pathSearches[pathType]) {
+		IPath* path = pathCache.GetTempPath(search->GetID());
 
-	assert(search != nullptr);
-	assert(path != nullptr);
+		assert(search != nullptr);
+		assert(path != nullptr);
 
-	const auto DeleteSearch = [](IPathSearch* s, PathSearchVect& v, PathSearchVectIt& it) {
-		// ordering of still-queued searches is not relevant
-		*it = v.back();
-		v.pop_back();
-		delete s;
-	};
-
-	// temp-path might have been removed already via
-	// DeletePath before we got a chance to process it
-	if (path->GetID() == 0) {
-		DeleteSearch(search, searches, searchesIt);
-		return false;
-	}
+		// temp-path might have been removed already via
+		// DeletePath before we got a chance to process it
+		if (path->GetID() == 0) {
+			search->SetStatus(SEARCH_STATUS_DISCARD);
+			continue;
+		}
 
-	assert(search->GetID() != 0);
-	assert(path->GetID() == search->GetID());
+		assert(search->GetID() != 0);
+		assert(path->GetID() == search->GetID());
 
-	search->Initialize(&nodeLayer, &pathCache, path->GetSourcePoint(), path->GetTargetPoint(), MAP_RECTANGLE);
-	path->SetHash(search->GetHash(mapDims.mapx * mapDims.mapy, pathType));
+		search->Initialize(&nodeLayer, &pathCache, path->GetSourcePoint(), path->GetTargetPoint(), MAP_RECTANGLE);
+		path->SetHash(search->GetHash(mapDims.mapx * mapDims.mapy, pathType));
 
-	{
 		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		SharedPathMap::const_iterator sharedPathsIt = sharedPaths.find(path->GetHash());
-
-		if (sharedPathsIt != sharedPaths.end()) {
-			if (search->SharedFinalize(sharedPathsIt->second, path)) {
-				DeleteSearch(search, searches, searchesIt);
-				return false;
-			}
+		if (searchHashes.find(path->GetHash()) != searchHashes.end()) {
+			search->SetStatus(SEARCH_STATUS_SHARED);
+			continue;
 		}
 		#endif
 
@@ -815,30 +805,95 @@ bool QTPFS::PathManager::ExecuteSearch(
 		const unsigned int numPrevSearches = numPrevExecutedSearches[search->GetTeam()];
 
 		if ((numCurrSearches - numPrevSearches) >= MAX_TEAM_SEARCHES) {
-			++searchesIt; return false;
+			search->SetStatus(SEARCH_STATUS_QUEUED);
+			continue;
 		}
 
 		numCurrExecutedSearches[search->GetTeam()] += 1;
 		#endif
+
+		searchHashes.insert(path->GetHash());
+		search->SetStatus(SEARCH_STATUS_EXECUTE);
 	}
+}
+
+void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType) {
+	PathCache& pathCache = pathCaches[pathType];
+	SharedPathMap& layerSharedPaths = sharedPaths[pathType];
+
+	// NOTE:
+	//   runs on a ThreadPool worker, must only touch state
+	//   belonging to this layer (DeletePath, pathTraces and
+	//   search deletion are left to FinalizeQueuedSearches)
+	layerSharedPaths.clear();
+
+	for (IPathSearch* search: pathSearches[pathType]) {
+		switch (search->GetStatus()) {
+			case SEARCH_STATUS_EXECUTE: {} break;
+			case SEARCH_STATUS_SHARED : {} break;
+			default                   : { continue; } break;
+		}
 
-	// removes path from temp-paths, adds it to live-paths
-	if (search->Execute(searchStateOffset, numTerrainChanges)) {
-		search->Finalize(path);
+		IPath* path = pathCache.GetTempPath(search->GetID());
 
 		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		sharedPaths[path->GetHash()] = path;
-		#endif
+		if (search->GetStatus() == SEARCH_STATUS_SHARED) {
+			const SharedPathMapIt sharedPathsIt = layerSharedPaths.find(path->GetHash());
+
+			if (sharedPathsIt != layerSharedPaths.end() && search->SharedFinalize(sharedPathsIt->second, path)) {
+				search->SetStatus(SEARCH_STATUS_FINISHED);
+				continue;
+			}
 
-		#ifdef QTPFS_TRACE_PATH_SEARCHES
-		pathTraces[path->GetID()] = search->GetExecutionTrace();
+			// the search we wanted to share with failed, run our own
+		}
 		#endif
-	} else {
-		DeletePath(path->GetID());
+
+		// removes path from temp-paths, adds it to live-paths
+		if (search->Execute(searchStateOffsets[pathType], numTerrainChanges)) {
+			search->Finalize(path);
+			search->SetStatus(SEARCH_STATUS_FINISHED);
+
+			#ifdef QTPFS_SEARCH_SHARED_PATHS
+			layerSharedPaths[path->GetHash()] = path;
+			#endif
+		} else {
+			search->SetStatus(SEARCH_STATUS_FAILED);
+		}
+
+		searchStateOffsets[pathType] += NODE_STATE_OFFSET;
 	}
+}
 
-	DeleteSearch(search, searches, searchesIt);
-	return true;
+void QTPFS::PathManager::FinalizeQueuedSearches(unsigned int pathType) {
+	std::vector<IPathSearch*>& searches = pathSearches[pathType];
+
+	unsigned int numQueuedSearches = 0;
+
+	for (IPathSearch* search: searches) {
+		switch (search->GetStatus()) {
+			case SEARCH_STATUS_QUEUED: {
+				// held back, retry during the next update of this layer
+				searches[numQueuedSearches++] = search;
+				continue;
+			} break;
+			case SEARCH_STATUS_FAILED: {
+				DeletePath(search->GetID());
+			} break;
+			case SEARCH_STATUS_FINISHED: {
+				#ifdef QTPFS_TRACE_PATH_SEARCHES
+				if (search->GetExecutionTrace() != nullptr)
+					pathTraces[search->GetID()] = search->GetExecutionTrace();
+				#endif
+			} break;
+			default: {
+			} break;
+		}
+
+		delete search;
+	}
+
+	searches.resize(numQueuedSearches);
 }
 
 void QTPFS::PathManager::QueueDeadPathSearches(unsigned int pathType) {
@@ -1160,3 +1215,25 @@ int2 QTPFS::PathManager::GetNumQueuedUpdates() const {
 	return data;
 }
 
+IPathManager::LayerUpdateStats QTPFS::PathManager::GetLayerUpdateStats() const {
+	LayerUpdateStats stats;
+
+	if (!IsFinalized())
+		return stats;
+
+	for (const NodeLayer& layer: nodeLayers) {
+		const NodeLayer::UpdateStats& layerStats = layer.GetUpdateStats();
+
+		stats.numQueuedRects += layerStats.numQueuedRects;
+		stats.numMergedRects += layerStats.numMergedRects;
+		stats.numExecutedRects += layerStats.numExecutedRects;
+		stats.numTesselatedRects += layerStats.numTesselatedRects;
+
+		#ifdef QTPFS_STAGGERED_LAYER_UPDATES
+		stats.numPendingRects += layer.NumQueuedUpdates();
+		#endif
+	}
+
+	return stats;
+}
+
@@ -10,6 +10,7 @@
 #include "PathCache.hpp"
 #include "PathSearch.hpp"
 #include "System/UnorderedMap.hpp"
+#include "System/UnorderedSet.hpp"
 
 struct MoveDef;
 struct SRectangle;
@@ -69,6 +70,7 @@ namespace QTPFS {
 		) const override;
 
 		int2 GetNumQueuedUpdates() const override;
+		LayerUpdateStats GetLayerUpdateStats() const override;
 
 
 		const NodeLayer& GetNodeLayer(unsigned int pathType) const { return nodeLayers[pathType]; }
@@ -121,7 +123,9 @@ namespace QTPFS {
 		void ExecQueuedNodeLayerUpdates(unsigned int layerNum, bool flushQueue);
 		#endif
 
+		void PrepareQueuedSearches(unsigned int pathType);
 		void ExecuteQueuedSearches(unsigned int pathType);
+		void FinalizeQueuedSearches(unsigned int pathType);
 		void QueueDeadPathSearches(unsigned int pathType);
 
 		unsigned int QueueSearch(
@@ -134,14 +138,6 @@ namespace QTPFS {
 			const bool synced
 		);
 
-		bool ExecuteSearch(
-			PathSearchVect& searches,
-			PathSearchVectIt& searchesIt,
-			NodeLayer& nodeLayer,
-			PathCache& pathCache,
-			unsigned int pathType
-		);
-
 		bool IsFinalized() const { return (!nodeTrees.empty()); }
 
 
@@ -156,8 +152,10 @@ namespace QTPFS {
 		spring::unordered_map<unsigned int, unsigned int> pathTypes;
 		spring::unordered_map<unsigned int, PathSearchTrace::Execution*> pathTraces;
 
-		// maps "hashes" of executed searches to the found paths
-		spring::unordered_map<std::uint64_t, IPath*> sharedPaths;
+		// maps "hashes" of executed searches to the found paths, per layer
+		std::vector<SharedPathMap> sharedPaths;
+		// hashes of searches scheduled for execution during an update
+		spring::unordered_set<std::uint64_t> searchHashes;
 
 		std::vector<unsigned int> numCurrExecutedSearches;
 		std::vector<unsigned int> numPrevExecutedSearches;
@@ -165,7 +163,9 @@ namespace QTPFS {
 		static unsigned int LAYERS_PER_UPDATE;
 		static unsigned int MAX_TEAM_SEARCHES;
 
-		unsigned int searchStateOffset;
+		// per layer, searches of different layers never visit the same nodes
+		std::vector<unsigned int> searchStateOffsets;
+
 		unsigned int numTerrainChanges;
 		unsigned int numPathRequests;
 		unsigned int maxNumLeafNodes;
@@ -81,6 +81,7 @@ namespace QTPFS {
 			, searchType(pathSearchType)
 			, searchState(0)
 			, searchMagic(0)
+			, searchStatus(SEARCH_STATUS_QUEUED)
 			{}
 		virtual ~IPathSearch() {}
 
@@ -103,8 +104,10 @@ namespace QTPFS {
 
 		void SetID(unsigned int n) { searchID = n; }
 		void SetTeam(unsigned int n) { searchTeam = n; }
+		void SetStatus(unsigned int n) { searchStatus = n; }
 		unsigned int GetID() const { return searchID; }
 		unsigned int GetTeam() const { return searchTeam; }
+		unsigned int GetStatus() const { return searchStatus; }
 
 	protected:
 		unsigned int searchID;     // links us to the temp-path that this search will finalize
@@ -113,6 +116,7 @@ namespace QTPFS {
 		unsigned int searchType;   // indicates if Dijkstra (h==0) or A* (h!=0) search is employed
 		unsigned int searchState;  // offset that identifies nodes as part of current search
 		unsigned int searchMagic;  // used to signal nodes they should update their neighbor-set
+		unsigned int searchStatus; // scheduling state within the current PathManager::Update
 	};
 
 
@@ -120,6 +124,7 @@ namespace QTPFS {
 	public:
 		PathSearch(unsigned int pathSearchType)
 			: IPathSearch(pathSearchType)
+			, openNodes(NULL)
 			, nodeLayer(NULL)
 			, pathCache(NULL)
 			, searchExec(NULL)
@@ -132,7 +137,7 @@ namespace QTPFS {
 			, haveFullPath(false)
 			, havePartPath(false)
 			{}
-		~PathSearch() { openNodes.reset(); }
+		~PathSearch() {}
 
 		void Initialize(
 			NodeLayer* layer,
@@ -151,8 +156,8 @@ namespace QTPFS {
 
 		const std::uint64_t GetHash(std::uint64_t N, std::uint32_t k) const;
 
-		static void InitGlobalQueue(unsigned int n) { openNodes.reserve(n); }
-		static void FreeGlobalQueue() { openNodes.clear(); }
+		static void InitGlobalQueues(unsigned int n);
+		static void FreeGlobalQueues() { openNodeQueues.clear(); }
 
 	private:
 		void ResetState(INode* node);
@@ -165,9 +170,14 @@ namespace QTPFS {
 		void SmoothPath(IPath* path) const;
 		bool SmoothPathIter(IPath* path) const;
 
-		// global queue: allocated once, re-used by all searches without clear()'s
+		// global queues: allocated once, re-used by all searches without clear()'s
 		// this relies on INode::operator< to sort the INode*'s by increasing f-cost
-		static binary_heap<INode*> openNodes;
+		// there is one queue per ThreadPool thread, searches of different layers run
+		// concurrently (all other search-state lives in the layer's own nodes)
+		static std::vector< binary_heap<INode*> > openNodeQueues;
+
+		// queue of the thread executing this search
+		binary_heap<INode*>* openNodes;
 
 		NodeLayer* nodeLayer;
 		PathCache* pathCache;
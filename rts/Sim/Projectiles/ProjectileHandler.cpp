@@ -30,6 +30,7 @@
 #include "System/Log/ILog.h"
 #include "System/SpringMath.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
 
 
 // reserve 5% of maxNanoParticles for important stuff such as capture and reclaim other teams' units
@@ -55,7 +56,9 @@ CR_REG_METADATA(CProjectileHandler, (
 	CR_MEMBER_UN(lastProjectileCounts),
 
 	CR_MEMBER(freeProjectileIDs),
-	CR_MEMBER(projectileMaps)
+	CR_MEMBER(projectileMaps),
+	CR_IGNORED(collisionCandidates),
+	CR_IGNORED(spawnedCollisionCandidates)
 ))
 
 
@@ -248,10 +251,14 @@ void CProjectileHandler::UpdateProjectileContainer(bool synced)
 		MAPPOS_SANITY_CHECK(p->pos);
 
 		p->Update();
-		quadField.MovedProjectile(p);
 
 		MAPPOS_SANITY_CHECK(p->pos);
 	}
+
+	// unsynced projectiles are not tracked by the quadfield
+	// note: also includes projectiles spawned during Update
+	if (synced)
+		quadField.MovedProjectiles(pc);
 }
 
 
@@ -600,10 +607,33 @@ void CProjectileHandler::CheckShieldCollisions(
 
 void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc)
 {
-	static std::vector<CUnit*> tempUnits;
-	static std::vector<CFeature*> tempFeatures;
-	static std::vector<CPlasmaRepulser*> tempRepulsers;
+	const size_t numProjectiles = pc.size();
+
+	if (collisionCandidates.size() < numProjectiles)
+		collisionCandidates.resize(numProjectiles);
+
+	{
+		SCOPED_TIMER("Sim::Projectiles::Collisions::BroadPhase");
+
+		// gather potential colliders for every projectile concurrently;
+		// only reads the quadfield and object positions, and results do
+		// not depend on the number of threads
+		for_mt(0, numProjectiles, [&](const int i) {
+			const CProjectile* p = pc[i];
+			ProjectileCollisionCandidates& cc = collisionCandidates[i];
+
+			cc.Clear();
 
+			if (!p->checkCol) return;
+			if ( p->deleteMe) return;
+
+			quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, cc.units, cc.features, &cc.repulsers);
+		});
+	}
+
+	// resolve hits serially in container order; collisions can change
+	// the checkCol and deleteMe state of later projectiles and spawn new
+	// ones (which are appended and gathered on the spot)
 	for (size_t i = 0; i < pc.size(); ++i) {
 		CProjectile* p = pc[i];
 
@@ -614,11 +644,16 @@ void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc)
 		const float3 ppos1 = p->pos + p->speed;
 		// const float3 ppos1 = p->pos + p->dir * (p->speed.w + p->radius);
 
-		quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, tempUnits, tempFeatures, &tempRepulsers);
+		ProjectileCollisionCandidates& cc = (i < numProjectiles)? collisionCandidates[i]: spawnedCollisionCandidates;
+
+		if (i >= numProjectiles) {
+			cc.Clear();
+			quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, cc.units, cc.features, &cc.repulsers);
+		}
 
-		CheckShieldCollisions(p, tempRepulsers, ppos0, ppos1); tempRepulsers.clear();
-		CheckUnitCollisions(p, tempUnits, ppos0, ppos1); tempUnits.clear();
-		CheckFeatureCollisions(p, tempFeatures, ppos0, ppos1); tempFeatures.clear();
+		CheckShieldCollisions(p, cc.repulsers, ppos0, ppos1);
+		CheckUnitCollisions(p, cc.units, ppos0, ppos1);
+		CheckFeatureCollisions(p, cc.features, ppos0, ppos1);
 	}
 }
 
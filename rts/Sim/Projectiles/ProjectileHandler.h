@@ -27,6 +27,19 @@ typedef std::vector<CGroundFlash*> GroundFlashContainer;
 typedef std::vector<FlyingPiece> FlyingPieceContainer;
 
 
+struct ProjectileCollisionCandidates {
+	void Clear() {
+		units.clear();
+		features.clear();
+		repulsers.clear();
+	}
+
+	std::vector<CUnit*> units;
+	std::vector<CFeature*> features;
+	std::vector<CPlasmaRepulser*> repulsers;
+};
+
+
 class CProjectileHandler
 {
 	CR_DECLARE_STRUCT(CProjectileHandler)
@@ -107,6 +120,12 @@ private:
 	// [0] := ID ==> projectile* map for living unsynced projectiles
 	// [1] := ID ==> projectile* map for living   synced projectiles
 	std::vector<CProjectile*> projectileMaps[2];
+
+	// broad-phase results of CheckUnitFeatureCollisions; [i] belongs
+	// to the i-th projectile of the container being checked, the
+	// spawned set to projectiles created during hit resolution
+	std::vector<ProjectileCollisionCandidates> collisionCandidates;
+	ProjectileCollisionCandidates spawnedCollisionCandidates;
 };
 
 
@@ -16,9 +16,11 @@
 #include "Sim/MoveTypes/MoveType.h"
 #include "Sim/Weapons/Weapon.h"
 #include "System/EventHandler.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/SpringMath.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/Sync/SyncTracer.h"
 #include "System/creg/STL_Deque.h"
 #include "System/creg/STL_Set.h"
@@ -41,11 +43,14 @@ CR_REG_METADATA(CUnitHandler, (
 	CR_MEMBER(maxUnits),
 	CR_MEMBER(maxUnitRadius),
 
-	CR_MEMBER(inUpdateCall)
+	CR_MEMBER(inUpdateCall),
+	CR_IGNORED(mtMoveTypeUpdates)
 ))
 
 
 
+CONFIG(bool, MTMoveTypeUpdates).defaultValue(false).description("Sample the terrain under all moving units on ThreadPool workers before their MoveType updates; sync-neutral.");
+
 UnitMemPool unitMemPool;
 
 CUnitHandler unitHandler;
@@ -113,6 +118,8 @@ void CUnitHandler::Init() {
 		// other team in the respective allyteam
 		maxUnits = CalcMaxUnits();
 		maxUnitRadius = 0.0f;
+
+		mtMoveTypeUpdates = configHandler->GetBool("MTMoveTypeUpdates");
 	}
 	{
 		activeSlowUpdateUnit = 0;
@@ -321,6 +328,21 @@ void CUnitHandler::UpdateUnitMoveTypes()
 {
 	SCOPED_TIMER("Sim::Unit::MoveType");
 
+	if (mtMoveTypeUpdates) {
+		// compute-phase; only produces samples that Update uses if they
+		// are still valid and otherwise recomputes, so results are equal
+		// with or without it and mtMoveTypeUpdates may differ between
+		// clients (which makes comparing sync checksums trivial)
+		SCOPED_TIMER("Sim::Unit::MoveType::PreCollisions");
+
+		for_mt(0, activeUnits.size(), [&](const int i) {
+			activeUnits[i]->moveType->UpdatePreCollisionsMT();
+		});
+	}
+
+	// commit-phase; collisions, position changes and UnitMoved events
+	// affect other units so are always processed serially (in order of
+	// activeUnits which is identical on all clients)
 	for (activeUpdateUnit = 0; activeUpdateUnit < activeUnits.size(); ++activeUpdateUnit) {
 		CUnit* unit = activeUnits[activeUpdateUnit];
 		AMoveType* moveType = unit->moveType;
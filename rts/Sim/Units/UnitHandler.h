@@ -74,6 +74,10 @@ public:
 
 	const spring::unordered_map<unsigned int, CBuilderCAI*>& GetBuilderCAIs() const { return builderCAIs; }
 
+	// sync-neutral, may be toggled at runtime to compare against the serial path
+	bool GetMTMoveTypeUpdates() const { return mtMoveTypeUpdates; }
+	bool SetMTMoveTypeUpdates(bool b) { return (mtMoveTypeUpdates = b); }
+
 private:
 	void InsertActiveUnit(CUnit* unit);
 	bool QueueDeleteUnit(CUnit* unit);
@@ -111,6 +115,9 @@ private:
 	float maxUnitRadius = 0.0f;
 
 	bool inUpdateCall = false;
+
+	///< if true, AMoveType::UpdatePreCollisionsMT is run via for_mt
+	bool mtMoveTypeUpdates = false;
 };
 
 extern CUnitHandler unitHandler;
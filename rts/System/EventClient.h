@@ -39,6 +39,45 @@ class LuaMaterial;
 #endif
 
 
+// plain-data copies of high-frequency events, collected by CEventHandler
+// during a sim-frame and handed to each client of the matching *Batch
+// call-in at once; objects are referenced by ID since they might have
+// been killed by the time the batch is delivered (UnitMoved events of
+// units deleted meanwhile are dropped, their IDs can already be reused)
+struct SUnitMovedEvent {
+	int unitID;
+	int allyTeam;
+
+	float3 pos;
+};
+
+struct SUnitDamagedEvent {
+	int unitID;
+	int unitDefID;
+	int unitTeam;
+	int allyTeam;
+
+	int attackerID; // -1 if none
+	int attackerDefID;
+	int attackerTeam;
+
+	int weaponDefID;
+	int projectileID;
+
+	float damage;
+	bool paralyzer;
+};
+
+struct SProjectileCreatedEvent {
+	int projectileID;
+	int allyTeam; // -1 if the projectile had no owner at creation
+	int ownerID;
+	int weaponDefID; // -1 for piece-projectiles
+
+	bool piece;
+};
+
+
 enum DbgTimingInfoType {
 	TIMING_VIDEO,
 	TIMING_SIM,
@@ -170,6 +209,9 @@ class CEventClient
 		virtual void UnitMoved(const CUnit* unit) {}
 		virtual void UnitMoveFailed(const CUnit* unit) {}
 
+		virtual void UnitMovedBatch(const std::vector<SUnitMovedEvent>& events) {}
+		virtual void UnitDamagedBatch(const std::vector<SUnitDamagedEvent>& events) {}
+
 		virtual void FeatureCreated(const CFeature* feature) {}
 		virtual void FeatureDestroyed(const CFeature* feature) {}
 		virtual void FeatureDamaged(
@@ -186,6 +228,8 @@ class CEventClient
 		virtual void ProjectileCreated(const CProjectile* proj) {}
 		virtual void ProjectileDestroyed(const CProjectile* proj) {}
 
+		virtual void ProjectileCreatedBatch(const std::vector<SProjectileCreatedEvent>& events) {}
+
 		virtual void RenderProjectileCreated(const CProjectile* proj) {}
 		virtual void RenderProjectileDestroyed(const CProjectile* proj) {}
 
@@ -4,6 +4,9 @@
 
 #include "Lua/LuaCallInCheck.h"
 #include "Lua/LuaOpenGL.h"  // FIXME -- should be moved
+#include "Sim/Projectiles/WeaponProjectiles/WeaponProjectile.h"
+#include "Sim/Units/UnitDef.h"
+#include "Sim/Weapons/WeaponDef.h"
 
 #include "System/Config/ConfigHandler.h"
 #include "System/Platform/Threading.h"
@@ -38,6 +41,11 @@ void CEventHandler::ResetState()
 	handles.clear();
 	handles.reserve(16);
 
+	unitMovedEvents.clear();
+	unitDamagedEvents.clear();
+	projectileCreatedEvents.clear();
+	deletedUnitMovedEvents.clear();
+
 	SetupEvents();
 }
 
@@ -555,6 +563,127 @@ void CEventHandler::UnitHarvestStorageFull(const CUnit* unit)
 /******************************************************************************/
 /******************************************************************************/
 
+void CEventHandler::AddUnitDamagedEvent(
+	const CUnit* unit,
+	const CUnit* attacker,
+	float damage,
+	int weaponDefID,
+	int projectileID,
+	bool paralyzer
+) {
+	SUnitDamagedEvent e;
+	e.unitID = unit->id;
+	e.unitDefID = unit->unitDef->id;
+	e.unitTeam = unit->team;
+	e.allyTeam = unit->allyteam;
+	e.attackerID = (attacker != nullptr)? attacker->id: -1;
+	e.attackerDefID = (attacker != nullptr)? attacker->unitDef->id: -1;
+	e.attackerTeam = (attacker != nullptr)? attacker->team: -1;
+	e.weaponDefID = weaponDefID;
+	e.projectileID = projectileID;
+	e.damage = damage;
+	e.paralyzer = paralyzer;
+
+	unitDamagedEvents.push_back(e);
+}
+
+void CEventHandler::AddProjectileCreatedEvent(const CProjectile* proj, int allyTeam)
+{
+	// same as the ProjectileCreated call-in, only these are reported to Lua
+	if (!proj->weapon && !proj->piece)
+		return;
+
+	const CUnit* owner = proj->owner();
+	const WeaponDef* wd = proj->weapon? (static_cast<const CWeaponProjectile*>(proj))->GetWeaponDef(): nullptr;
+
+	SProjectileCreatedEvent e;
+	e.projectileID = proj->id;
+	e.allyTeam = allyTeam;
+	e.ownerID = (owner != nullptr)? owner->id: -1;
+	e.weaponDefID = (wd != nullptr)? wd->id: -1;
+	e.piece = proj->piece;
+
+	projectileCreatedEvents.push_back(e);
+}
+
+
+template<typename E>
+static void DeliverEventBatch(
+	std::vector<CEventClient*>& list,
+	void (CEventClient::*func)(const std::vector<E>&),
+	std::vector<E>& events
+) {
+	if (events.empty())
+		return;
+
+	std::vector<E> batchEvents;
+	std::vector<E> readEvents;
+
+	// events raised by the call-ins go into the next batch
+	batchEvents.swap(events);
+
+	for (size_t i = 0; i < list.size(); ) {
+		CEventClient* ec = list[i];
+
+		if (ec->GetFullRead()) {
+			(ec->*func)(batchEvents);
+		} else {
+			readEvents.clear();
+
+			for (const E& e: batchEvents) {
+				if (e.allyTeam < 0 || ec->CanReadAllyTeam(e.allyTeam))
+					readEvents.push_back(e);
+			}
+
+			if (!readEvents.empty())
+				(ec->*func)(readEvents);
+		}
+
+		// the call-in may remove itself from the list
+		i += (i < list.size() && ec == list[i]);
+	}
+
+	// keep the capacity around if nothing new was queued meanwhile
+	if (!events.empty())
+		return;
+
+	batchEvents.clear();
+	batchEvents.swap(events);
+}
+
+void CEventHandler::DiscardDeletedUnitMovedEvents()
+{
+	if (deletedUnitMovedEvents.empty())
+		return;
+
+	size_t numEvents = 0;
+
+	for (size_t i = 0; i < unitMovedEvents.size(); i++) {
+		const auto iter = deletedUnitMovedEvents.find(unitMovedEvents[i].unitID);
+
+		// queued by a deleted unit whose ID might have been reused since
+		if (iter != deletedUnitMovedEvents.end() && i < iter->second)
+			continue;
+
+		unitMovedEvents[numEvents++] = unitMovedEvents[i];
+	}
+
+	unitMovedEvents.resize(numEvents);
+	deletedUnitMovedEvents.clear();
+}
+
+void CEventHandler::DeliverBatchedEvents()
+{
+	DiscardDeletedUnitMovedEvents();
+
+	DeliverEventBatch(listUnitMovedBatch, &CEventClient::UnitMovedBatch, unitMovedEvents);
+	DeliverEventBatch(listUnitDamagedBatch, &CEventClient::UnitDamagedBatch, unitDamagedEvents);
+	DeliverEventBatch(listProjectileCreatedBatch, &CEventClient::ProjectileCreatedBatch, projectileCreatedEvents);
+}
+
+/******************************************************************************/
+/******************************************************************************/
+
 void CEventHandler::CollectGarbage()
 {
 	ITERATE_EVENTCLIENTLIST_NA(CollectGarbage);
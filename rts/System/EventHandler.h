@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "System/EventClient.h"
+#include "System/UnorderedMap.hpp"
 #include "Sim/Units/Unit.h"
 #include "Sim/Features/Feature.h"
 #include "Sim/Projectiles/Projectile.h"
@@ -290,6 +291,10 @@ class CEventHandler
 		/// percentage when reconnecting to a running game
 		void GameProgress(int gameFrame);
 
+		/// hands the UnitMoved, UnitDamaged and ProjectileCreated events
+		/// collected since the previous call to their *Batch clients
+		void DeliverBatchedEvents();
+
 		void CollectGarbage();
 		void DbgTimingInfo(DbgTimingInfoType type, const spring_time start, const spring_time end);
 		void Pong(uint8_t pingTag, const spring_time pktSendTime, const spring_time pktRecvTime);
@@ -332,6 +337,18 @@ class CEventHandler
 		void ListInsert(EventClientList& ciList, CEventClient* ec);
 		void ListRemove(EventClientList& ciList, CEventClient* ec);
 
+		void AddUnitDamagedEvent(
+			const CUnit* unit,
+			const CUnit* attacker,
+			float damage,
+			int weaponDefID,
+			int projectileID,
+			bool paralyzer);
+		void AddProjectileCreatedEvent(const CProjectile* proj, int allyTeam);
+
+	private:
+		void DiscardDeletedUnitMovedEvents();
+
 	private:
 		CEventClient* mouseOwner;
 
@@ -340,6 +357,14 @@ class CEventHandler
 
 		EventClientList handles;
 
+		// only filled while the matching *Batch list is non-empty
+		std::vector<SUnitMovedEvent> unitMovedEvents;
+		std::vector<SUnitDamagedEvent> unitDamagedEvents;
+		std::vector<SProjectileCreatedEvent> projectileCreatedEvents;
+
+		// unit-ID to number of unitMovedEvents queued before its unit was deleted
+		spring::unordered_map<int, size_t> deletedUnitMovedEvents;
+
 	#define SETUP_EVENT(name, props) EventClientList list ## name;
 	#define SETUP_UNMANAGED_EVENT(name, props)
 		#include "Events.def"
@@ -422,7 +447,25 @@ UNIT_CALLIN_NO_PARAM(UnitEnteredWater)
 UNIT_CALLIN_NO_PARAM(UnitEnteredAir)
 UNIT_CALLIN_NO_PARAM(UnitLeftWater)
 UNIT_CALLIN_NO_PARAM(UnitLeftAir)
-UNIT_CALLIN_NO_PARAM(UnitMoved)
+
+inline void CEventHandler::UnitMoved(const CUnit* unit)
+{
+	const auto unitAllyTeam = unit->allyteam;
+
+	for (size_t i = 0; i < listUnitMoved.size(); ) {
+		CEventClient* ec = listUnitMoved[i];
+
+		if (ec->CanReadAllyTeam(unitAllyTeam))
+			ec->UnitMoved(unit);
+
+		i += (i < listUnitMoved.size() && ec == listUnitMoved[i]);
+	}
+
+	if (listUnitMovedBatch.empty())
+		return;
+
+	unitMovedEvents.push_back({unit->id, unitAllyTeam, unit->pos});
+}
 
 #define UNIT_CALLIN_INT_PARAMS(name)                                              \
 	inline void CEventHandler:: Unit ## name (const CUnit* unit, int p1, int p2)  \
@@ -527,6 +570,11 @@ inline void CEventHandler::UnitDamaged(
 	bool paralyzer)
 {
 	ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitDamaged, unit, attacker, damage, weaponDefID, projectileID, paralyzer)
+
+	if (listUnitDamagedBatch.empty())
+		return;
+
+	AddUnitDamagedEvent(unit, attacker, damage, weaponDefID, projectileID, paralyzer);
 }
 
 inline void CEventHandler::UnitStunned(
@@ -653,6 +701,11 @@ inline void CEventHandler::ProjectileCreated(const CProjectile* proj, int allyTe
 			ec->ProjectileCreated(proj);
 		}
 	}
+
+	if (listProjectileCreatedBatch.empty())
+		return;
+
+	AddProjectileCreatedEvent(proj, allyTeam);
 }
 
 
@@ -726,7 +779,27 @@ inline void CEventHandler::RenderUnitCreated(const CUnit* unit, int cloaked)
 	ITERATE_EVENTCLIENTLIST(RenderUnitCreated, unit, cloaked)
 }
 
-UNIT_CALLIN_NO_PARAM(RenderUnitDestroyed)
+inline void CEventHandler::RenderUnitDestroyed(const CUnit* unit)
+{
+	const auto unitAllyTeam = unit->allyteam;
+
+	for (size_t i = 0; i < listRenderUnitDestroyed.size(); ) {
+		CEventClient* ec = listRenderUnitDestroyed[i];
+
+		if (ec->CanReadAllyTeam(unitAllyTeam))
+			ec->RenderUnitDestroyed(unit);
+
+		i += (i < listRenderUnitDestroyed.size() && ec == listRenderUnitDestroyed[i]);
+	}
+
+	// called right before the unit's ID is freed, a unit created later
+	// in this frame can get the same ID and must not receive the moves
+	// queued so far
+	if (unitMovedEvents.empty())
+		return;
+
+	deletedUnitMovedEvents[unit->id] = unitMovedEvents.size();
+}
 
 inline void CEventHandler::RenderFeatureCreated(const CFeature* feature)
 {
@@ -0,0 +1,87 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MemoryMappedFile.h"
+
+#ifdef _WIN32
+#include "System/Platform/Win/win32.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+bool CMemoryMappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0) {
+		CloseHandle(fileHandle);
+		return false;
+	}
+
+	// the view keeps the file referenced, both handles can be closed
+	HANDLE mapHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(fileHandle);
+
+	if (mapHandle == nullptr)
+		return false;
+
+	void* view = MapViewOfFile(mapHandle, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(mapHandle);
+
+	if (view == nullptr)
+		return false;
+
+	data = reinterpret_cast<std::uint8_t*>(view);
+	size = fileSize.QuadPart;
+#else
+	const int fd = open(filePath.c_str(), O_RDONLY);
+
+	if (fd == -1)
+		return false;
+
+	struct stat fileInfo;
+
+	if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+
+	// the mapping keeps the file referenced, fd can be closed
+	void* addr = mmap(nullptr, fileInfo.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (addr == MAP_FAILED)
+		return false;
+
+	data = reinterpret_cast<std::uint8_t*>(addr);
+	size = fileInfo.st_size;
+#endif
+
+	return true;
+}
+
+void CMemoryMappedFile::Close()
+{
+	if (data == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap(data, size);
+#endif
+
+	data = nullptr;
+	size = 0;
+}
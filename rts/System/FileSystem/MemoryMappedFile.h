@@ -0,0 +1,50 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _MEMORY_MAPPED_FILE_H
+#define _MEMORY_MAPPED_FILE_H
+
+#include <cinttypes>
+#include <string>
+#include <utility>
+
+/**
+ * Maps an entire (raw, non-VFS) file into memory copy-on-write:
+ * pages are only read from disk when first accessed and writes
+ * stay private to the process, the file itself is never changed.
+ */
+class CMemoryMappedFile
+{
+public:
+	CMemoryMappedFile() = default;
+	CMemoryMappedFile(const CMemoryMappedFile& f) = delete;
+	CMemoryMappedFile(CMemoryMappedFile&& f) { *this = std::move(f); }
+	~CMemoryMappedFile() { Close(); }
+
+	CMemoryMappedFile& operator = (const CMemoryMappedFile& f) = delete;
+	CMemoryMappedFile& operator = (CMemoryMappedFile&& f) {
+		Close();
+
+		data = f.data;
+		size = f.size;
+
+		f.data = nullptr;
+		f.size = 0;
+		return *this;
+	}
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const { return (data != nullptr); }
+
+	std::uint8_t* GetData() { return data; }
+	const std::uint8_t* GetData() const { return data; }
+
+	size_t GetSize() const { return size; }
+
+private:
+	std::uint8_t* data = nullptr;
+	size_t size = 0;
+};
+
+#endif // _MEMORY_MAPPED_FILE_H
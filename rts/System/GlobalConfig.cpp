@@ -56,6 +56,7 @@ CONFIG(int, TeamHighlight)
 	.maximumValue(CTeamHighlight::HIGHLIGHT_LAST);
 
 CONFIG(bool, UseNetMessageSmoothingBuffer).defaultValue(true);
+CONFIG(bool, UseNetFrameBatching).defaultValue(false);
 
 CONFIG(bool, LuaWritableConfigFile).defaultValue(true);
 CONFIG(bool, VFSCacheArchiveFiles).defaultValue(true);
@@ -85,6 +86,7 @@ void GlobalConfig::Init()
 		linkIncomingSustainedBandwidth = linkIncomingPeakBandwidth = 1024 * 1024;
 
 	useNetMessageSmoothingBuffer = configHandler->GetBool("UseNetMessageSmoothingBuffer");
+	useNetFrameBatching = configHandler->GetBool("UseNetFrameBatching");
 	luaWritableConfigFile = configHandler->GetBool("LuaWritableConfigFile");
 	vfsCacheArchiveFiles = configHandler->GetBool("VFSCacheArchiveFiles");
 
@@ -92,6 +92,15 @@ public:
 	 */
 	bool useNetMessageSmoothingBuffer = true;
 
+	/**
+	 * @brief useNetFrameBatching
+	 *
+	 * Whether client asks the server to coalesce consecutive frame
+	 * messages into NETMSG_FRAMEBATCH's, saving bandwidth and packets
+	 * especially while catching up or watching at high game speeds
+	 */
+	bool useNetFrameBatching = false;
+
 	/**
 	 * @brief luaWritableConfigFile
 	 *
@@ -17,6 +17,14 @@ public:
 	void LoadGameStartInfo(const std::string& path);
 	void LoadGame();
 
+	/// game-state without the save-file header, used for demo keyframes
+	std::string SaveGameState();
+	/// replaces the running game's state with one returned by SaveGameState
+	void LoadGameState(std::string&& state);
+
+protected:
+	void SaveGameState(std::stringstream& oss);
+
 protected:
 	std::stringstream iss;
 };
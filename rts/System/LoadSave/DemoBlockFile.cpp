@@ -0,0 +1,118 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstring>
+#include <zlib.h>
+
+#include "DemoBlockFile.h"
+#include "System/Log/ILog.h"
+
+
+CDemoBlockFile::CDemoBlockFile(const std::string& fileName): file(fileName, SPRING_VFS_PWD_ALL)
+{
+	memset(&header, 0, sizeof(header));
+
+	if (!file.FileExists())
+		return;
+
+	if (file.Read(&header, sizeof(header)) < int(sizeof(header)))
+		return;
+
+	header.swab();
+
+	if (memcmp(header.magic, DEMOBLOCKFILE_MAGIC, sizeof(header.magic)) != 0 || header.version != DEMOBLOCKFILE_VERSION || header.headerSize != sizeof(header)) {
+		LOG_L(L_ERROR, "[DemoBlockFile::%s] \"%s\" is not a (compatible) block-compressed demo", __func__, fileName.c_str());
+		return;
+	}
+
+	if (header.blockSize <= 0 || header.numBlocks <= 0)
+		return;
+
+	blockIndex.resize(header.numBlocks);
+	file.Seek(header.indexOffset);
+
+	if (file.Read(blockIndex.data(), blockIndex.size() * sizeof(DemoBlockIndexEntry)) < int(blockIndex.size() * sizeof(DemoBlockIndexEntry))) {
+		LOG_L(L_ERROR, "[DemoBlockFile::%s] block index of \"%s\" is truncated", __func__, fileName.c_str());
+		blockIndex.clear();
+		return;
+	}
+
+	for (DemoBlockIndexEntry& entry: blockIndex) {
+		entry.swab();
+	}
+}
+
+
+int CDemoBlockFile::Read(void* buf, int length)
+{
+	int numRead = 0;
+
+	// reads can span blocks (e.g. the stats chunk)
+	while (numRead < length && !Eof()) {
+		const int blockNum = rawPos / header.blockSize;
+		const int blockPos = rawPos % header.blockSize;
+
+		if (!LoadBlock(blockNum))
+			break;
+
+		const int n = std::min(length - numRead, int(blockData.size()) - blockPos);
+
+		if (n <= 0)
+			break;
+
+		memcpy(static_cast<std::uint8_t*>(buf) + numRead, &blockData[blockPos], n);
+
+		numRead += n;
+		rawPos += n;
+	}
+
+	return numRead;
+}
+
+
+int CDemoBlockFile::FindFrameBlock(int frameNum) const
+{
+	// trailing entries without chunks (stats, keyframes) have streamOffset -1
+	const auto pred = [](int f, const DemoBlockIndexEntry& e) { return (e.streamOffset < 0 || f < e.frameNum); };
+	const auto iter = std::upper_bound(blockIndex.begin(), blockIndex.end(), frameNum, pred);
+
+	if (iter == blockIndex.begin())
+		return -1;
+
+	return ((iter - 1) - blockIndex.begin());
+}
+
+
+bool CDemoBlockFile::LoadBlock(int blockNum)
+{
+	if (blockNum == curBlockNum)
+		return true;
+	if (blockNum < 0 || blockNum >= header.numBlocks)
+		return false;
+
+	const DemoBlockIndexEntry& entry = blockIndex[blockNum];
+
+	// last block may be shorter
+	const std::uint64_t rawBlockSize = std::min(std::uint64_t(header.blockSize), header.rawSize - std::uint64_t(blockNum) * header.blockSize);
+
+	compressedData.resize(entry.compressedSize);
+	blockData.resize(rawBlockSize);
+
+	file.Seek(entry.fileOffset);
+
+	if (file.Read(compressedData.data(), compressedData.size()) < int(compressedData.size())) {
+		curBlockNum = -1;
+		return false;
+	}
+
+	uLongf blockDataSize = blockData.size();
+
+	if (uncompress(blockData.data(), &blockDataSize, compressedData.data(), compressedData.size()) != Z_OK || blockDataSize != blockData.size()) {
+		LOG_L(L_ERROR, "[DemoBlockFile::%s] corrupt block %d", __func__, blockNum);
+		curBlockNum = -1;
+		return false;
+	}
+
+	curBlockNum = blockNum;
+	return true;
+}
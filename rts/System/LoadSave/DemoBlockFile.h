@@ -0,0 +1,53 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_BLOCK_FILE_H
+#define DEMO_BLOCK_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "demofile.h"
+#include "System/FileSystem/FileHandler.h"
+
+/**
+ * @brief Random-access reader for block-compressed demofiles
+ *
+ * Presents the uncompressed demo data like a CFileHandler would, but only
+ * inflates the block containing the current read position (see demofile.h).
+ */
+class CDemoBlockFile
+{
+public:
+	CDemoBlockFile(const std::string& fileName);
+
+	bool FileExists() const { return (!blockIndex.empty()); }
+
+	int Read(void* buf, int length);
+	void Seek(int pos) { rawPos = pos; }
+
+	int GetPos() const { return rawPos; }
+	int FileSize() const { return int(header.rawSize); }
+	bool Eof() const { return (rawPos >= FileSize()); }
+
+	/// index of the block whose first chunk is the last one at or before frameNum, or -1
+	int FindFrameBlock(int frameNum) const;
+	const DemoBlockIndexEntry& GetBlockIndexEntry(int blockNum) const { return blockIndex[blockNum]; }
+
+private:
+	bool LoadBlock(int blockNum);
+
+private:
+	CFileHandler file;
+	DemoBlockFileHeader header;
+
+	std::vector<DemoBlockIndexEntry> blockIndex;
+
+	std::vector<std::uint8_t> compressedData;
+	std::vector<std::uint8_t> blockData;
+
+	int curBlockNum = -1;
+	int rawPos = 0;
+};
+
+#endif
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "DemoReader.h"
+#include "DemoBlockFile.h"
 
 #ifndef TOOLS
 #include "System/Config/ConfigHandler.h"
@@ -16,24 +17,47 @@ CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to
 #include <climits>
 #include <stdexcept>
 #include <cassert>
+#include <cstddef>
 #include <cstring>
+#include <vector>
+#include <zlib.h>
 
 
-CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDemo(new CGZFileHandler(filename, SPRING_VFS_PWD_ALL))
+CDemoReader::CDemoReader(const std::string& filename, float curTime)
 {
-	if (FileSystem::GetExtension(filename) != "sdfz")
-		throw content_error("Unknown demo extension: " + FileSystem::GetExtension(filename));
+	const std::string extension = FileSystem::GetExtension(filename);
+
+	if (extension == "sdfb") {
+		playbackBlocks = new CDemoBlockFile(filename);
+	} else if (extension == "sdfz") {
+		playbackDemo = new CGZFileHandler(filename, SPRING_VFS_PWD_ALL);
+	} else {
+		throw content_error("Unknown demo extension: " + extension);
+	}
 
 	// file not found -> exception
-	if (!playbackDemo->FileExists())
+	if ((playbackDemo != nullptr && !playbackDemo->FileExists()) || (playbackBlocks != nullptr && !playbackBlocks->FileExists()))
 		throw user_error("Demofile not found: " + filename);
 
-	playbackDemo->Read((char*)&fileHeader, sizeof(fileHeader));
+	ReadDemo((char*)&fileHeader, sizeof(fileHeader));
 	fileHeader.swab();
 
+	// demos recorded before keyframes were added have a smaller header
+	constexpr int keyFramelessHeaderSize = offsetof(DemoFileHeader, numKeyFrames);
+
+	const bool keyFramelessDemo =
+		(fileHeader.version == DEMOFILE_VERSION_NOKEYFRAMES) &&
+		(fileHeader.headerSize == keyFramelessHeaderSize);
+
+	if (keyFramelessDemo) {
+		fileHeader.numKeyFrames = 0;
+		fileHeader.keyFrameSize = 0;
+		SeekDemo(fileHeader.headerSize);
+	}
+
 	if (memcmp(fileHeader.magic, DEMOFILE_MAGIC, sizeof(fileHeader.magic)) != 0
-		|| fileHeader.version != DEMOFILE_VERSION
-		|| fileHeader.headerSize != sizeof(fileHeader)
+		|| (fileHeader.version != DEMOFILE_VERSION && !keyFramelessDemo)
+		|| (fileHeader.headerSize != sizeof(fileHeader) && !keyFramelessDemo)
 		|| fileHeader.playerStatElemSize != sizeof(PlayerStatistics)
 		|| fileHeader.teamStatElemSize != sizeof(TeamStatistics)
 		// Don't compare spring version in debug mode: we don't want to make
@@ -53,19 +77,24 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 
 	if (fileHeader.scriptSize != 0) {
 		std::vector<char> buf(fileHeader.scriptSize);
-		playbackDemo->Read(buf.data(), buf.size());
+		ReadDemo(buf.data(), buf.size());
 		setupScript = std::string(buf.data(), buf.size());
 	}
 
-	playbackDemo->Read((char*)&chunkHeader, sizeof(chunkHeader));
+	ReadDemo((char*)&chunkHeader, sizeof(chunkHeader));
 	chunkHeader.swab();
 
 	demoTimeOffset = curTime - chunkHeader.modGameTime - 0.1f;
 	nextDemoReadTime = curTime - 0.01f;
 
-	const long curPos = playbackDemo->GetPos();
-	playbackDemo->Seek(0, std::ios::end);
-	playbackDemoSize = playbackDemo->GetPos();
+	const long curPos = GetDemoPos();
+
+	if (playbackDemo != nullptr) {
+		playbackDemo->Seek(0, std::ios::end);
+		playbackDemoSize = playbackDemo->GetPos();
+	} else {
+		playbackDemoSize = playbackBlocks->FileSize();
+	}
 
 	if (fileHeader.demoStreamSize != 0) {
 		bytesRemaining = fileHeader.demoStreamSize;
@@ -76,13 +105,16 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 		// (if this had still used CFileHandler that would have been easier ;-))
 		bytesRemaining = playbackDemoSize - curPos;
 	}
-	playbackDemo->Seek(curPos);
+
+	LoadKeyFrameIndex();
+	SeekDemo(curPos);
 }
 
 
 CDemoReader::~CDemoReader()
 {
 	delete playbackDemo;
+	delete playbackBlocks;
 }
 
 
@@ -96,7 +128,7 @@ netcode::RawPacket* CDemoReader::GetData(const float readTime)
 	// check needed
 	if (readTime >= nextDemoReadTime) {
 		netcode::RawPacket* buf = new netcode::RawPacket(chunkHeader.length);
-		if (playbackDemo->Read((char*)(buf->data), chunkHeader.length) < chunkHeader.length) {
+		if (ReadDemo((char*)(buf->data), chunkHeader.length) < chunkHeader.length) {
 			delete buf;
 			bytesRemaining = 0;
 			return nullptr;
@@ -105,7 +137,7 @@ netcode::RawPacket* CDemoReader::GetData(const float readTime)
 
 		if (!ReachedEnd()) {
 			// read next chunk header
-			if (playbackDemo->Read((char*)&chunkHeader, sizeof(chunkHeader)) < sizeof(chunkHeader)) {
+			if (ReadDemo((char*)&chunkHeader, sizeof(chunkHeader)) < sizeof(chunkHeader)) {
 				delete buf;
 				bytesRemaining = 0;
 				return nullptr;
@@ -126,7 +158,38 @@ netcode::RawPacket* CDemoReader::GetData(const float readTime)
 
 bool CDemoReader::ReachedEnd()
 {
-	return (bytesRemaining <= 0 || playbackDemo->Eof() || (playbackDemo->GetPos() > playbackDemoSize));
+	return (bytesRemaining <= 0 || DemoEof() || (GetDemoPos() > playbackDemoSize));
+}
+
+
+int CDemoReader::SeekToFrame(int frameNum)
+{
+	if (playbackBlocks == nullptr || fileHeader.demoStreamSize == 0)
+		return -1;
+
+	const int blockNum = playbackBlocks->FindFrameBlock(frameNum);
+
+	if (blockNum < 0)
+		return -1;
+
+	const DemoBlockIndexEntry& entry = playbackBlocks->GetBlockIndexEntry(blockNum);
+
+	// never seek backwards, whatever consumes GetData can not rewind
+	if (entry.streamOffset < GetStreamOffset() || entry.streamOffset >= fileHeader.demoStreamSize)
+		return -1;
+
+	SeekDemo(fileHeader.headerSize + fileHeader.scriptSize + entry.streamOffset);
+
+	if (ReadDemo((char*)&chunkHeader, sizeof(chunkHeader)) < sizeof(chunkHeader)) {
+		bytesRemaining = 0;
+		return -1;
+	}
+
+	chunkHeader.swab();
+
+	nextDemoReadTime = chunkHeader.modGameTime + demoTimeOffset;
+	bytesRemaining = fileHeader.demoStreamSize - entry.streamOffset;
+	return entry.frameNum;
 }
 
 
@@ -136,8 +199,8 @@ void CDemoReader::LoadStats()
 	if (fileHeader.demoStreamSize == 0)
 		return;
 
-	const int curPos = playbackDemo->GetPos();
-	playbackDemo->Seek(fileHeader.headerSize + fileHeader.scriptSize + fileHeader.demoStreamSize);
+	const int curPos = GetDemoPos();
+	SeekDemo(fileHeader.headerSize + fileHeader.scriptSize + fileHeader.demoStreamSize);
 
 	winningAllyTeams.clear();
 	playerStats.clear();
@@ -145,13 +208,13 @@ void CDemoReader::LoadStats()
 
 	for (int allyTeamNum = 0; allyTeamNum < fileHeader.winningAllyTeamsSize; ++allyTeamNum) {
 		unsigned char winnerAllyTeam;
-		playbackDemo->Read((char*) &winnerAllyTeam, sizeof(unsigned char));
+		ReadDemo((char*) &winnerAllyTeam, sizeof(unsigned char));
 		winningAllyTeams.push_back(winnerAllyTeam);
 	}
 
 	for (int playerNum = 0; playerNum < fileHeader.numPlayers; ++playerNum) {
 		PlayerStatistics buf;
-		playbackDemo->Read(reinterpret_cast<char*>(&buf), sizeof(PlayerStatistics));
+		ReadDemo(reinterpret_cast<char*>(&buf), sizeof(PlayerStatistics));
 		buf.swab();
 		playerStats.push_back(buf);
 	}
@@ -160,17 +223,133 @@ void CDemoReader::LoadStats()
 		teamStats.resize(fileHeader.numTeams);
 		// Read the array containing the number of team stats for each team.
 		std::vector<int> numStatsPerTeam(fileHeader.numTeams, 0);
-		playbackDemo->Read((char*) (&numStatsPerTeam[0]), numStatsPerTeam.size());
+		ReadDemo((char*) (&numStatsPerTeam[0]), numStatsPerTeam.size());
 
 		for (int teamNum = 0; teamNum < fileHeader.numTeams; ++teamNum) {
 			for (int i = 0; i < numStatsPerTeam[teamNum]; ++i) {
 				TeamStatistics buf;
-				playbackDemo->Read(reinterpret_cast<char*>(&buf), sizeof(TeamStatistics));
+				ReadDemo(reinterpret_cast<char*>(&buf), sizeof(TeamStatistics));
 				buf.swab();
 				teamStats[teamNum].push_back(buf);
 			}
 		}
 	}
 
-	playbackDemo->Seek(curPos);
+	SeekDemo(curPos);
+}
+
+
+void CDemoReader::LoadKeyFrameIndex()
+{
+	// keyframes are written together with the stats, i.e. not if Spring crashed
+	if (fileHeader.demoStreamSize == 0 || fileHeader.numKeyFrames <= 0)
+		return;
+
+	int keyFramePos = fileHeader.headerSize + fileHeader.scriptSize + fileHeader.demoStreamSize;
+	keyFramePos += fileHeader.winningAllyTeamsSize;
+	keyFramePos += fileHeader.playerStatSize;
+	keyFramePos += fileHeader.teamStatSize;
+
+	keyFrames.clear();
+	keyFrames.reserve(fileHeader.numKeyFrames);
+
+	// only index the keyframes, their state is read on demand
+	for (int i = 0; i < fileHeader.numKeyFrames; i++) {
+		DemoKeyFrameHeader keyFrameHeader;
+
+		SeekDemo(keyFramePos);
+
+		if (ReadDemo((char*)&keyFrameHeader, sizeof(keyFrameHeader)) < sizeof(keyFrameHeader))
+			break;
+
+		keyFrameHeader.swab();
+
+		keyFramePos += sizeof(keyFrameHeader);
+
+		if ((keyFramePos + keyFrameHeader.length) > playbackDemoSize)
+			break;
+
+		keyFrames.push_back({keyFrameHeader.frameNum, keyFrameHeader.streamOffset, keyFramePos, int(keyFrameHeader.length), int(keyFrameHeader.rawLength)});
+		keyFramePos += keyFrameHeader.length;
+	}
+
+	LOG("[DemoReader::%s] %u game-state keyframes (%d bytes)", __func__, unsigned(keyFrames.size()), fileHeader.keyFrameSize);
+}
+
+int CDemoReader::FindKeyFrame(int minFrameNum, int maxFrameNum) const
+{
+	int idx = -1;
+
+	// keyframes are stored in order
+	for (size_t i = 0; i < keyFrames.size(); i++) {
+		if (keyFrames[i].frameNum > maxFrameNum)
+			break;
+		if (keyFrames[i].frameNum <= minFrameNum)
+			continue;
+		// the stream must not have been read past the keyframe yet
+		if (keyFrames[i].streamOffset < GetStreamOffset())
+			continue;
+
+		idx = i;
+	}
+
+	return idx;
+}
+
+bool CDemoReader::GetKeyFrameState(int idx, std::string& state)
+{
+	const KeyFrame& keyFrame = keyFrames[idx];
+	const int curPos = GetDemoPos();
+
+	std::vector<std::uint8_t> data(keyFrame.length);
+
+	SeekDemo(keyFrame.fileOffset);
+
+	const bool ret = (ReadDemo(data.data(), keyFrame.length) == keyFrame.length);
+
+	SeekDemo(curPos);
+
+	if (!ret)
+		return false;
+
+	uLongf rawLength = keyFrame.rawLength;
+
+	state.clear();
+	state.resize(keyFrame.rawLength);
+
+	return (uncompress(reinterpret_cast<Bytef*>(&state[0]), &rawLength, data.data(), data.size()) == Z_OK && rawLength == state.size());
+}
+
+
+int CDemoReader::ReadDemo(void* buf, int length)
+{
+	if (playbackBlocks != nullptr)
+		return (playbackBlocks->Read(buf, length));
+
+	return (playbackDemo->Read(buf, length));
+}
+
+void CDemoReader::SeekDemo(int pos)
+{
+	if (playbackBlocks != nullptr) {
+		playbackBlocks->Seek(pos);
+	} else {
+		playbackDemo->Seek(pos);
+	}
+}
+
+int CDemoReader::GetDemoPos()
+{
+	if (playbackBlocks != nullptr)
+		return (playbackBlocks->GetPos());
+
+	return (playbackDemo->GetPos());
+}
+
+bool CDemoReader::DemoEof() const
+{
+	if (playbackBlocks != nullptr)
+		return (playbackBlocks->Eof());
+
+	return (playbackDemo->Eof());
 }
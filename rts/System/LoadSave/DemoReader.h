@@ -13,6 +13,7 @@
 
 namespace netcode { class RawPacket; }
 class CFileHandler;
+class CDemoBlockFile;
 
 /**
  * @brief Utility class for reading demofiles
@@ -39,6 +40,25 @@ public:
 	*/
 	bool ReachedEnd();
 
+	/**
+	@brief find the last keyframe saved after minFrameNum and at or before maxFrameNum
+	@return index of the keyframe, or -1 if there is none
+	*/
+	int FindKeyFrame(int minFrameNum, int maxFrameNum) const;
+	/// read the game-state of keyframe <idx>, which must have been returned by FindKeyFrame
+	bool GetKeyFrameState(int idx, std::string& state);
+
+	int GetKeyFrameNum(int idx) const { return keyFrames[idx].frameNum; }
+	int GetKeyFrameStreamOffset(int idx) const { return keyFrames[idx].streamOffset; }
+	/// offset into the demo stream of the next chunk returned by GetData
+	int GetStreamOffset() const { return (fileHeader.demoStreamSize - bytesRemaining); }
+
+	/**
+	@brief skip ahead to the start of the indexed block containing frameNum (block-compressed demos only)
+	@return number of sim-frames preceding the next chunk returned by GetData, or -1 if unable to seek
+	*/
+	int SeekToFrame(int frameNum);
+
 	float GetModGameTime() const { return chunkHeader.modGameTime; }
 	float GetDemoTimeOffset() const { return demoTimeOffset; }
 	float GetNextDemoReadTime() const { return nextDemoReadTime; }
@@ -56,7 +76,25 @@ public:
 	void LoadStats();
 
 private:
-	CFileHandler* playbackDemo;
+	void LoadKeyFrameIndex();
+
+	int ReadDemo(void* buf, int length);
+	void SeekDemo(int pos);
+	int GetDemoPos();
+	bool DemoEof() const;
+
+private:
+	struct KeyFrame {
+		int frameNum;
+		int streamOffset;
+		int fileOffset; // position of the state data
+		int length;
+		int rawLength;
+	};
+
+	// exactly one of these is non-null, depending on the demo format
+	CFileHandler* playbackDemo = nullptr;
+	CDemoBlockFile* playbackBlocks = nullptr;
 
 	float demoTimeOffset;
 	float nextDemoReadTime;
@@ -70,6 +108,8 @@ private:
 	std::vector<PlayerStatistics> playerStats; // one stat per player
 	std::vector< std::vector<TeamStatistics> > teamStats; // many stats per team
 	std::vector<unsigned char> winningAllyTeams;
+
+	std::vector<KeyFrame> keyFrames;
 };
 
 #endif
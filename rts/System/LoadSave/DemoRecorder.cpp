@@ -3,13 +3,16 @@
 #include <cassert>
 #include <cerrno>
 #include <cstring>
+#include <fstream>
 #include <memory>
 
 #include "DemoRecorder.h"
 #include "Game/GameVersion.h"
+#include "Net/Protocol/BaseNetProtocol.h"
 #include "Sim/Misc/TeamStatistics.h"
 #include "System/TimeUtil.h"
 #include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
@@ -26,12 +29,105 @@
 #endif
 
 
-// server and client memory-streams
-static std::string demoStreams[2];
+CONFIG(bool, DemoBlockCompression).defaultValue(false).description("Write demos as independently compressed blocks (.sdfb) that can be seeked in, instead of a single gzip stream (.sdfz). Not understood by tools that only read .sdfz demos.");
+
+
+// uncompressed size of each block in .sdfb demos
+static constexpr int DEMO_BLOCK_SIZE = 256 * 1024;
+
+// serializes the background writes of finished demos
 static spring::mutex demoMutex;
 
 
-CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo): isServerDemo(serverDemo)
+static void WriteDemoBlockFile(const std::string& fileName, const std::string& data, std::vector<DemoBlockIndexEntry>& blockIndex)
+{
+	DemoBlockFileHeader header;
+
+	memset(&header, 0, sizeof(header));
+	strcpy(header.magic, DEMOBLOCKFILE_MAGIC);
+	header.version = DEMOBLOCKFILE_VERSION;
+	header.headerSize = sizeof(header);
+	header.blockSize = DEMO_BLOCK_SIZE;
+	header.numBlocks = blockIndex.size();
+	header.rawSize = data.size();
+	header.indexOffset = sizeof(header);
+
+	std::ofstream file(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+	std::vector<std::uint8_t> block(compressBound(DEMO_BLOCK_SIZE));
+
+	// rewritten once the index offset is known
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	for (size_t i = 0; i < blockIndex.size() && file.good(); i++) {
+		const size_t rawOffset = i * DEMO_BLOCK_SIZE;
+		const size_t rawSize = std::min(data.size() - rawOffset, size_t(DEMO_BLOCK_SIZE));
+
+		uLongf blockSize = block.size();
+
+		// favor speed, this runs on the server
+		if (compress2(block.data(), &blockSize, reinterpret_cast<const Bytef*>(data.data() + rawOffset), rawSize, Z_BEST_SPEED) != Z_OK) {
+			LOG_L(L_ERROR, "[%s] failed to compress block %u of demo \"%s\"", __func__, unsigned(i), fileName.c_str());
+
+			// do not leave a demo without index behind
+			file.close();
+			FileSystem::Remove(fileName);
+			return;
+		}
+
+		blockIndex[i].fileOffset = header.indexOffset;
+		blockIndex[i].compressedSize = blockSize;
+
+		file.write(reinterpret_cast<const char*>(block.data()), blockSize);
+		header.indexOffset += blockSize;
+	}
+
+	for (DemoBlockIndexEntry& entry: blockIndex) {
+		entry.swab();
+		file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+	}
+
+	header.swab();
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	if (file.good())
+		return;
+
+	LOG_L(L_ERROR, "[%s] failed to write demo \"%s\"", __func__, fileName.c_str());
+
+	file.close();
+	FileSystem::Remove(fileName);
+}
+
+static size_t WriteKeyFrameFile(const std::string& fileName, DemoKeyFrameHeader header, const std::string& state, bool truncate)
+{
+	std::vector<std::uint8_t> data(compressBound(state.size()));
+
+	uLongf dataSize = data.size();
+
+	// keyframes compress well, but favor speed since the recording client is still playing
+	if (compress2(data.data(), &dataSize, reinterpret_cast<const Bytef*>(state.data()), state.size(), Z_BEST_SPEED) != Z_OK)
+		return 0;
+
+	header.length = dataSize;
+	header.rawLength = state.size();
+	header.swab();
+
+	std::ofstream file(fileName, std::ios::out | std::ios::binary | (truncate? std::ios::trunc: std::ios::app));
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(data.data()), dataSize);
+
+	if (!file.good())
+		return 0;
+
+	return (sizeof(header) + dataSize);
+}
+
+
+CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo)
+	: isServerDemo(serverDemo)
+	, blockCompression(configHandler->GetBool("DemoBlockCompression"))
 {
 	std::lock_guard<spring::mutex> lock(demoMutex);
 
@@ -40,7 +136,16 @@ CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modN
 	SetFileHeader();
 	WriteFileHeader(false);
 
-	file = gzopen(demoName.c_str(), "wb9");
+	if (!demoName.empty())
+		keyFrameFileName = demoName + ".keyframes";
+
+	if (!blockCompression) {
+		file = gzopen(demoName.c_str(), "wb9");
+	} else {
+		// claim the name right away like gzopen does, other recorders
+		// (e.g. of concurrently hosted games) must not pick it as well
+		std::ofstream(demoName, std::ios::out | std::ios::binary | std::ios::trunc);
+	}
 }
 
 CDemoRecorder::~CDemoRecorder()
@@ -48,6 +153,7 @@ CDemoRecorder::~CDemoRecorder()
 	WriteWinnerList();
 	WritePlayerStats();
 	WriteTeamStats();
+	WriteKeyFrames();
 	WriteFileHeader(true);
 	WriteDemoFile();
 }
@@ -55,8 +161,8 @@ CDemoRecorder::~CDemoRecorder()
 
 void CDemoRecorder::SetStream()
 {
-	demoStreams[isServerDemo].clear();
-	demoStreams[isServerDemo].reserve(8 * 1024 * 1024);
+	demoStream.clear();
+	demoStream.reserve(8 * 1024 * 1024);
 }
 
 void CDemoRecorder::SetFileHeader()
@@ -71,6 +177,8 @@ void CDemoRecorder::SetFileHeader()
 	fileHeader.teamStatElemSize = sizeof(TeamStatistics);
 	fileHeader.teamStatPeriod = TeamStatistics::statsPeriod;
 	fileHeader.winningAllyTeamsSize = 0;
+	fileHeader.numKeyFrames = 0;
+	fileHeader.keyFrameSize = 0;
 }
 
 void CDemoRecorder::WriteDemoFile()
@@ -80,8 +188,15 @@ void CDemoRecorder::WriteDemoFile()
 	// functions use stdio library routines, and most of zlib's functions use the library memory
 	// allocation routines by default" (so code below should be OK)
 	// gz* should usually be finished before ctor runs again when reloading, but take no chances
-	std::string& data = demoStreams[isServerDemo];
-	std::function<void(gzFile, std::string&)> func = [](gzFile file, std::string& data) {
+	LOG("[%s] writing %s-demo \"%s\" (%u bytes)", __func__, (isServerDemo? "server": "client"), demoName.c_str(), static_cast<unsigned int>(demoStream.size()));
+
+	if (blockCompression) {
+		WriteDemoBlocks();
+		return;
+	}
+
+	// the stream is handed over to the job, this recorder is about to be destroyed
+	std::function<void(gzFile, std::string)> func = [](gzFile file, std::string data) {
 		std::lock_guard<spring::mutex> lock(demoMutex);
 
 		gzwrite(file, data.c_str(), data.size());
@@ -89,14 +204,38 @@ void CDemoRecorder::WriteDemoFile()
 		gzclose(file);
 	};
 
-	LOG("[%s] writing %s-demo \"%s\" (%u bytes)", __func__, (isServerDemo? "server": "client"), demoName.c_str(), static_cast<unsigned int>(data.size()));
-
 	#ifndef WIN32
 	// NOTE: can not use ThreadPool for this directly here, workers are already gone
 	// FIXME: does not currently (august 2017) compile on Windows mingw buildbots
-	ThreadPool::AddExtJob(spring::thread(std::move(func), file, std::ref(data)));
+	ThreadPool::AddExtJob(spring::thread(std::move(func), file, std::move(demoStream)));
 	#else
-	ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::ref(data))));
+	ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(demoStream))));
+	#endif
+}
+
+void CDemoRecorder::WriteDemoBlocks()
+{
+	std::vector<DemoBlockIndexEntry> blockIndex((demoStream.size() + DEMO_BLOCK_SIZE - 1) / DEMO_BLOCK_SIZE);
+
+	// trailing blocks (stats, keyframes) contain no chunk to resume from
+	blockChunks.resize(blockIndex.size(), {-1, numStreamFrames});
+
+	for (size_t i = 0; i < blockIndex.size(); i++) {
+		blockIndex[i].streamOffset = blockChunks[i].streamOffset;
+		blockIndex[i].frameNum = blockChunks[i].frameNum;
+	}
+
+	blockChunks.clear();
+
+	std::function<void(std::string, std::string, std::vector<DemoBlockIndexEntry>)> func = [](std::string fileName, std::string data, std::vector<DemoBlockIndexEntry> blockIndex) {
+		std::lock_guard<spring::mutex> lock(demoMutex);
+		WriteDemoBlockFile(fileName, data, blockIndex);
+	};
+
+	#ifndef WIN32
+	ThreadPool::AddExtJob(spring::thread(std::move(func), demoName, std::move(demoStream), std::move(blockIndex)));
+	#else
+	ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), demoName, std::move(demoStream), std::move(blockIndex))));
 	#endif
 }
 
@@ -108,19 +247,79 @@ void CDemoRecorder::WriteSetupText(const std::string& text)
 	}
 
 	fileHeader.scriptSize = length;
-	demoStreams[isServerDemo].append(text.c_str(), length);
+	demoStream.append(text.c_str(), length);
 }
 
 void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime)
 {
 	DemoStreamChunkHeader chunkHeader;
 
+	// every block without a chunk starting in it so far resumes at this one
+	while (blockChunks.size() <= (demoStream.size() / DEMO_BLOCK_SIZE)) {
+		blockChunks.push_back({fileHeader.demoStreamSize, numStreamFrames});
+	}
+
 	chunkHeader.modGameTime = modGameTime;
 	chunkHeader.length = length;
 	chunkHeader.swab();
-	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&chunkHeader), sizeof(chunkHeader));
-	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(buf), length);
+	demoStream.append(reinterpret_cast<const char*>(&chunkHeader), sizeof(chunkHeader));
+	demoStream.append(reinterpret_cast<const char*>(buf), length);
 	fileHeader.demoStreamSize += (length + sizeof(chunkHeader));
+
+	numStreamFrames += (length > 0 && (buf[0] == NETMSG_NEWFRAME || buf[0] == NETMSG_KEYFRAME));
+}
+
+bool CDemoRecorder::CanSaveKeyFrame()
+{
+	if (keyFrameFileName.empty())
+		return false;
+
+	if (keyFrameJob.valid()) {
+		if (keyFrameJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return false;
+
+		WaitForKeyFrame();
+	}
+
+	return (!keyFrameFileName.empty());
+}
+
+void CDemoRecorder::SaveKeyFrame(int frameNum, std::string&& state)
+{
+	if (state.empty())
+		return;
+	if (!CanSaveKeyFrame())
+		return;
+
+	// offset of the next chunk, readers resume from here after loading the state
+	DemoKeyFrameHeader keyFrameHeader = {frameNum, fileHeader.demoStreamSize, 0, 0};
+
+	// compressing and writing (potentially hundreds of MB) is left to a
+	// background job so neither the keyframe nor the time it takes stay
+	// with the sim-thread
+	keyFrameJob = std::async(std::launch::async, WriteKeyFrameFile, keyFrameFileName, keyFrameHeader, std::move(state), fileHeader.numKeyFrames == 0);
+}
+
+void CDemoRecorder::WaitForKeyFrame()
+{
+	if (!keyFrameJob.valid())
+		return;
+
+	const size_t keyFrameSize = keyFrameJob.get();
+
+	if (keyFrameSize == 0) {
+		LOG_L(L_WARNING, "[DemoRecorder::%s] failed to write keyframe to \"%s\", disabling keyframes", __func__, keyFrameFileName.c_str());
+
+		FileSystem::DeleteFile(keyFrameFileName);
+		keyFrameFileName.clear();
+
+		fileHeader.numKeyFrames = 0;
+		fileHeader.keyFrameSize = 0;
+		return;
+	}
+
+	fileHeader.numKeyFrames += 1;
+	fileHeader.keyFrameSize += keyFrameSize;
 }
 
 void CDemoRecorder::SetName(const std::string& mapName, const std::string& modName)
@@ -143,12 +342,14 @@ void CDemoRecorder::SetName(const std::string& mapName, const std::string& modNa
 	// oss << FileSystem::GetBasename(modName);
 	// oss << "_";
 	oss << SpringVersion::GetSync();
-	buf << oss.str() << ".sdfz";
+	const char* extension = blockCompression? ".sdfb": ".sdfz";
+
+	buf << oss.str() << extension;
 
 	int n = 0;
 	while (FileSystem::FileExists(buf.str()) && (n < 99)) {
 		buf.str(""); // clears content
-		buf << oss.str() << "_" << n++ << ".sdfz";
+		buf << oss.str() << "_" << n++ << extension;
 	}
 
 	demoName = dataDirsAccess.LocateFile(buf.str(), FileQueryFlags::WRITE);
@@ -226,28 +427,28 @@ unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 	// to little endian
 	tmpHeader.swab();
 
-	if (demoStreams[isServerDemo].empty()) {
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader));
+	if (demoStream.empty()) {
+		demoStream.append(reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader));
 	} else {
-		assert(demoStreams[isServerDemo].size() >= sizeof(tmpHeader));
-		memcpy(&demoStreams[isServerDemo][0], reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader)); // no non-const .data() until C++17
+		assert(demoStream.size() >= sizeof(tmpHeader));
+		memcpy(&demoStream[0], reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader)); // no non-const .data() until C++17
 	}
 
-	return (demoStreams[isServerDemo].size());
+	return (demoStream.size());
 }
 
 /** @brief Write the CPlayer::Statistics at the current position in the file. */
 void CDemoRecorder::WritePlayerStats()
 {
-	const size_t pos = demoStreams[isServerDemo].size();
+	const size_t pos = demoStream.size();
 
 	for (PlayerStatistics& stats: playerStats) {
 		stats.swab();
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&stats), sizeof(PlayerStatistics));
+		demoStream.append(reinterpret_cast<const char*>(&stats), sizeof(PlayerStatistics));
 	}
 
 	fileHeader.numPlayers = playerStats.size();
-	fileHeader.playerStatSize = int(demoStreams[isServerDemo].size() - pos);
+	fileHeader.playerStatSize = int(demoStream.size() - pos);
 
 	playerStats.clear();
 }
@@ -260,38 +461,66 @@ void CDemoRecorder::WriteWinnerList()
 	if (fileHeader.numTeams == 0)
 		return;
 
-	const size_t pos = demoStreams[isServerDemo].size();
+	const size_t pos = demoStream.size();
 
 	// Write the array of winningAllyTeams.
 	for (size_t i = 0; i < winningAllyTeams.size(); i++) { // NOLINT{modernize-loop-convert}
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&winningAllyTeams[i]), sizeof(unsigned char));
+		demoStream.append(reinterpret_cast<const char*>(&winningAllyTeams[i]), sizeof(unsigned char));
 	}
 
 	winningAllyTeams.clear();
 
-	fileHeader.winningAllyTeamsSize = int(demoStreams[isServerDemo].size() - pos);
+	fileHeader.winningAllyTeamsSize = int(demoStream.size() - pos);
 }
 
 /** @brief Write the TeamStatistics at the current position in the file. */
 void CDemoRecorder::WriteTeamStats()
 {
-	const size_t pos = demoStreams[isServerDemo].size();
+	const size_t pos = demoStream.size();
 
 	// Write array of dwords indicating number of TeamStatistics per team.
 	for (std::vector<TeamStatistics>& history: teamStats) {
 		unsigned int c = swabDWord(history.size());
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&c), sizeof(unsigned int));
+		demoStream.append(reinterpret_cast<const char*>(&c), sizeof(unsigned int));
 	}
 
 	// Write big array of TeamStatistics.
 	for (std::vector<TeamStatistics>& history: teamStats) {
 		for (TeamStatistics& stats: history) {
 			stats.swab();
-			demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&stats), sizeof(TeamStatistics));
+			demoStream.append(reinterpret_cast<const char*>(&stats), sizeof(TeamStatistics));
 		}
 	}
 
-	fileHeader.teamStatSize = int(demoStreams[isServerDemo].size() - pos);
+	fileHeader.teamStatSize = int(demoStream.size() - pos);
 
 	teamStats.clear();
 }
+
+/** @brief Copy the game-state keyframes written so far to the current position in the file. */
+void CDemoRecorder::WriteKeyFrames()
+{
+	WaitForKeyFrame();
+
+	if (fileHeader.numKeyFrames == 0)
+		return;
+
+	const size_t pos = demoStream.size();
+
+	std::ifstream file(keyFrameFileName, std::ios::in | std::ios::binary);
+
+	demoStream.resize(pos + fileHeader.keyFrameSize);
+	file.read(&demoStream[pos], fileHeader.keyFrameSize);
+
+	if (!file.good()) {
+		LOG_L(L_WARNING, "[DemoRecorder::%s] failed to read keyframes from \"%s\"", __func__, keyFrameFileName.c_str());
+
+		demoStream.resize(pos);
+
+		fileHeader.numKeyFrames = 0;
+		fileHeader.keyFrameSize = 0;
+	}
+
+	file.close();
+	FileSystem::DeleteFile(keyFrameFileName);
+}
@@ -3,6 +3,7 @@
 #ifndef DEMO_RECORDER
 #define DEMO_RECORDER
 
+#include <future>
 #include <vector>
 #include <sstream>
 #include <zlib.h>
@@ -23,6 +24,10 @@ public:
 
 	void WriteSetupText(const std::string& text);
 	void SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime);
+	/// false while the previous keyframe is still being compressed, callers should skip this one
+	bool CanSaveKeyFrame();
+	/// must be called right after frameNum was simulated (as the stream is not yet past it)
+	void SaveKeyFrame(int frameNum, std::string&& state);
 
 	void SetStream();
 	void SetName(const std::string& mapName, const std::string& modName);
@@ -43,16 +48,38 @@ private:
 	void WritePlayerStats();
 	void WriteTeamStats();
 	void WriteWinnerList();
+	void WriteKeyFrames();
+	void WaitForKeyFrame();
 	void WriteDemoFile();
+	void WriteDemoBlocks();
 
 private:
-	gzFile file;
+	// first chunk starting in (or after) a block of the demo, for the block index
+	struct BlockChunk {
+		int streamOffset;
+		int frameNum;
+	};
+
+	gzFile file = nullptr;
+
+	// in-memory demo, written to file by a background job in the dtor
+	std::string demoStream;
 
 	std::vector<PlayerStatistics> playerStats;
 	std::vector< std::vector<TeamStatistics> > teamStats;
 	std::vector<unsigned char> winningAllyTeams;
+	std::vector<BlockChunk> blockChunks;
+
+	// keyframes are compressed and appended to this file by a background
+	// job as they are taken, and copied into the demo when it is written
+	std::string keyFrameFileName;
+	// number of bytes the pending job appended (0 on failure)
+	std::future<size_t> keyFrameJob;
+
+	int numStreamFrames = 0;
 
 	bool isServerDemo;
+	bool blockCompression;
 };
 
 
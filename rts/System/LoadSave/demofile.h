@@ -21,7 +21,19 @@
  * The current demofile version. Only change on major modifications for which
  * appending stuff to DemoFileHeader is not sufficient.
  */
-#define DEMOFILE_VERSION 5
+#define DEMOFILE_VERSION 6
+
+/**
+ * The last demofile version without game-state keyframes, its DemoFileHeader
+ * ends before numKeyFrames. Such demos can still be read.
+ */
+#define DEMOFILE_VERSION_NOKEYFRAMES 5
+
+/** The first 16 bytes of each block-compressed demofile. */
+#define DEMOBLOCKFILE_MAGIC "spring demoblks"
+
+/** The current block-compressed demofile container version. */
+#define DEMOBLOCKFILE_VERSION 1
 
 #pragma pack(push, 1)
 
@@ -40,6 +52,9 @@
  *         CTeam::Statistics for each team.
  *       - Array of all CTeam::Statistics (total number of items is the
  *         sum of the elements in the array of dwords).
+ *     - Game-state keyframes (keyFrameSize), numKeyFrames times:
+ *       - DemoKeyFrameHeader
+ *       - length bytes of zlib-compressed creg-serialized game state
  *
  * The header is designed to be extensible: it contains a version field and a
  * headerSize field to support this. The version field is a major version number
@@ -70,6 +85,8 @@ struct DemoFileHeader
 	int teamStatElemSize;         ///< sizeof(CTeam::Statistics)
 	int teamStatPeriod;           ///< Interval (in seconds) between team stats.
 	int winningAllyTeamsSize;     ///< The size of the vector of the winning ally teams
+	int numKeyFrames;             ///< Number of game-state keyframes. (since version 6)
+	int keyFrameSize;             ///< Size of the entire keyframe chunk. (since version 6)
 
 
 	/// Change structure from host endian to little endian or vice versa.
@@ -89,6 +106,8 @@ struct DemoFileHeader
 		swabDWordInPlace(teamStatElemSize);
 		swabDWordInPlace(teamStatPeriod);
 		swabDWordInPlace(winningAllyTeamsSize);
+		swabDWordInPlace(numKeyFrames);
+		swabDWordInPlace(keyFrameSize);
 	}
 };
 
@@ -115,6 +134,90 @@ struct DemoStreamChunkHeader
 	}
 };
 
+/**
+ * @brief Spring demo game-state keyframe header
+ *
+ * Keyframes are snapshots of the (synced) game state taken by the recording
+ * client right after it simulated frameNum, when the next unprocessed demo
+ * stream chunk started streamOffset bytes into the demo stream. A reader can
+ * load the state and continue from that offset instead of re-simulating all
+ * preceding frames.
+ *
+ * The state format is UNSTABLE, it is only valid for the exact same engine.
+ */
+struct DemoKeyFrameHeader
+{
+	int frameNum;           ///< Sim-frame after which the state was saved.
+	int streamOffset;       ///< Offset into the demo stream of the next chunk.
+	std::uint32_t length;   ///< Length of the (compressed) state data following this header.
+	std::uint32_t rawLength; ///< Length of the state data after inflating it.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(frameNum);
+		swabDWordInPlace(streamOffset);
+		swabDWordInPlace(length);
+		swabDWordInPlace(rawLength);
+	}
+};
+
+/**
+ * @brief Spring block-compressed demo file header
+ *
+ * Block-compressed demofiles (.sdfb) contain exactly the same data as the
+ * gzipped ones (.sdfz), i.e. a DemoFileHeader followed by all its chunks,
+ * but split into blocks of blockSize uncompressed bytes which are deflated
+ * (zlib) independently, so any part of the demo can be read by inflating a
+ * single block. The container layout is:
+ *
+ * - DemoBlockFileHeader
+ * - numBlocks compressed blocks
+ * - numBlocks DemoBlockIndexEntry's (at indexOffset)
+ */
+struct DemoBlockFileHeader
+{
+	char magic[16];               ///< DEMOBLOCKFILE_MAGIC
+	int version;                  ///< DEMOBLOCKFILE_VERSION
+	int headerSize;               ///< Size of the DemoBlockFileHeader.
+	int blockSize;                ///< Uncompressed size of every block but the last.
+	int numBlocks;                ///< Number of blocks (and index entries).
+	std::uint64_t rawSize;        ///< Uncompressed size of all blocks together.
+	std::uint64_t indexOffset;    ///< File offset of the block index.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(version);
+		swabDWordInPlace(headerSize);
+		swabDWordInPlace(blockSize);
+		swabDWordInPlace(numBlocks);
+		swab64InPlace(rawSize);
+		swab64InPlace(indexOffset);
+	}
+};
+
+/**
+ * @brief Spring block-compressed demo file index entry
+ *
+ * Besides locating each block, the index maps sim-frames to blocks: reading
+ * the demo stream can start at streamOffset (the first chunk that begins in
+ * or after this block) as if frameNum NETMSG_NEWFRAME's had been read.
+ */
+struct DemoBlockIndexEntry
+{
+	std::uint64_t fileOffset;     ///< File offset of the compressed block.
+	std::uint32_t compressedSize; ///< Size of the compressed block.
+	int streamOffset;             ///< Demo stream offset of the first chunk starting in this block or later, -1 if none.
+	int frameNum;                 ///< Number of sim-frames in the demo stream before that chunk.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swab64InPlace(fileOffset);
+		swabDWordInPlace(compressedSize);
+		swabDWordInPlace(streamOffset);
+		swabDWordInPlace(frameNum);
+	}
+};
+
 #pragma pack(pop)
 
 #endif // DEMO_FILE_H
@@ -3,10 +3,12 @@
 #ifndef _CONNECTION_H
 #define _CONNECTION_H
 
+#include <algorithm>
 #include <string>
 #include <memory>
 
 #include "RawPacket.h"
+#include "System/Misc/SpringTime.h"
 
 namespace netcode
 {
@@ -25,6 +27,13 @@ public:
 	 * Use this, since it does not need memcpy'ing
 	 */
 	virtual void SendData(std::shared_ptr<const RawPacket> data) = 0;
+	/**
+	 * @brief Send packet relayed on behalf of data received at recvTime
+	 *
+	 * Connections that send over the network record the time from recvTime
+	 * until the packet actually went out, see GetRelayLatency.
+	 */
+	virtual void RelayData(std::shared_ptr<const RawPacket> data, spring_time recvTime) { SendData(data); }
 
 	virtual bool HasIncomingData() const = 0;
 
@@ -62,14 +71,27 @@ public:
 	virtual bool NeedsReconnect() = 0;
 
 	unsigned int GetDataReceived() const { return dataRecv; }
+	unsigned int GetDataSent() const { return dataSent; }
 	unsigned int GetNumQueuedPings() const { return numPings; }
 	virtual unsigned int GetPacketQueueSize() const { return 0; }
 
+	struct RelayLatency {
+		float sumTime = 0.0f; // ms
+		float maxTime = 0.0f;
+
+		unsigned int numSamples = 0;
+	};
+
+	const RelayLatency& GetRelayLatency() const { return relayLatency; }
+	void ResetRelayLatency() { relayLatency = {}; }
+
 	virtual std::string Statistics() const = 0;
 	virtual std::string GetFullAddress() const = 0;
 	virtual void Unmute() = 0;
 	virtual void Close(bool flush = false) = 0;
 	virtual void SetLossFactor(int factor) = 0;
+	/// coalesce outgoing runs of frame-messages into NETMSG_FRAMEBATCH's
+	virtual void SetFrameBatching(bool enable) = 0;
 
 	/**
 	 * @brief update internals
@@ -78,6 +100,15 @@ public:
 	virtual void Update() {}
 
 protected:
+	void AddRelayLatency(float time) {
+		relayLatency.sumTime += time;
+		relayLatency.maxTime = std::max(relayLatency.maxTime, time);
+		relayLatency.numSamples += 1;
+	}
+
+protected:
+	RelayLatency relayLatency;
+
 	unsigned int dataSent = 0;
 	unsigned int dataRecv = 0;
 	unsigned int numPings = 0;
@@ -44,6 +44,7 @@ public:
 	void Unmute() override {}
 	void Close(bool flush) override;
 	void SetLossFactor(int factor) override {}
+	void SetFrameBatching(bool enable) override {}
 
 	unsigned int GetPacketQueueSize() const override;
 
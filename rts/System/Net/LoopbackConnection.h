@@ -29,6 +29,7 @@ public:
 	void Unmute() override {}
 	void Close(bool flush) override {}
 	void SetLossFactor(int factor) override {}
+	void SetFrameBatching(bool enable) override {}
 
 	std::string Statistics() const override { return "Statistics for loopback connection: N/A"; }
 	std::string GetFullAddress() const override { return "Loopback"; }
@@ -41,5 +41,28 @@ PackPacket& PackPacket::operator<<(const std::string& text)
 	return *this;
 }
 
+PackPacket& PackPacket::PackVarInt(uint32_t value)
+{
+	assert((pos + GetVarIntSize(value)) <= length);
+
+	for (; value >= 0x80; value >>= 7) {
+		*this << uint8_t((value & 0x7F) | 0x80);
+	}
+
+	*this << uint8_t(value);
+	return *this;
+}
+
+uint32_t PackPacket::GetVarIntSize(uint32_t value)
+{
+	uint32_t size = 1;
+
+	for (; value >= 0x80; value >>= 7) {
+		size += 1;
+	}
+
+	return size;
+}
+
 }
 
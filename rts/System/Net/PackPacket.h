@@ -38,6 +38,10 @@ public:
 
 	PackPacket& operator<<(const std::string& text);
 
+	/// LEB128, 7 bits per byte with the high bit set on all but the last
+	PackPacket& PackVarInt(uint32_t value);
+	static uint32_t GetVarIntSize(uint32_t value);
+
 	template <typename element>
 	PackPacket& operator<<(const std::vector<element>& vec) {
 		const size_t size = vec.size() * sizeof(element);
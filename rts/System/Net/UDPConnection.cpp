@@ -3,10 +3,12 @@
 #include "UDPConnection.h"
 
 #include <cinttypes>
+#include <cstring>
 
 
 #include "Socket.h"
 #include "ProtocolDef.h"
+#include "UnpackPacket.h"
 #include "Exception.h"
 #include "Net/Protocol/BaseNetProtocol.h"
 #include "System/Config/ConfigHandler.h"
@@ -129,6 +131,10 @@ public:
 		std::copy(_data.begin(), _data.end(), std::back_inserter(data));
 	}
 
+	void Pack(const std::uint8_t* _data, unsigned length) {
+		data.insert(data.end(), _data, _data + length);
+	}
+
 private:
 	std::vector<std::uint8_t>& data;
 };
@@ -143,6 +149,10 @@ void Chunk::UpdateChecksum(CRC& crc) const {
 	if (!data.empty()) {
 		crc.Update(&data[0], data.size());
 	}
+
+	for (const Slice& s: slices) {
+		crc.Update(s.packet->data + s.offset, s.length);
+	}
 }
 
 
@@ -225,6 +235,10 @@ void Packet::Serialize(std::vector<std::uint8_t>& data)
 		buf.Pack((*ci)->chunkNumber);
 		buf.Pack((*ci)->chunkSize);
 		buf.Pack((*ci)->data);
+
+		for (const Chunk::Slice& s: (*ci)->slices) {
+			buf.Pack(s.packet->data + s.offset, s.length);
+		}
 	}
 }
 
@@ -320,6 +334,8 @@ void UDPConnection::Init()
 
 	netLossFactor = globalConfig.networkLossFactor;
 	lastMidChunk = -1;
+	frameBatching = false;
+	expandFrameBatches = false;
 #if	NETWORK_TEST
 	lossCounter = 0;
 #endif
@@ -352,6 +368,12 @@ void UDPConnection::SendData(std::shared_ptr<const RawPacket> pkt)
 	outgoingData.push_back(pkt);
 }
 
+void UDPConnection::RelayData(std::shared_ptr<const RawPacket> pkt, spring_time recvTime)
+{
+	relayedData.emplace_back(pkt.get(), recvTime);
+	SendData(pkt);
+}
+
 std::shared_ptr<const RawPacket> UDPConnection::Peek(unsigned ahead) const
 {
 	if (ahead >= msgQueue.size())
@@ -644,36 +666,28 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 
 			// this returns false for zero/invalid pktLength
 			if (ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength)) {
-				msgQueue.emplace_back(new RawPacket(bufp, pktLength));
-				std::shared_ptr<const RawPacket>& msgPacket = msgQueue.back();
-
-				#ifdef ENABLE_DEBUG_STATS
-				// server sends both of these, clients send only keyframe messages
-				// TODO: would be easy to feed this data into a Q3A-style lagometer
-				//
-				if (msgPacket->data[0] == NETMSG_NEWFRAME || msgPacket->data[0] == NETMSG_KEYFRAME) {
-					const spring_time dt = spring_gettime() - lastFramePacketRecvTime;
-
-					sumDeltaFramePacketRecvTime += dt.toMilliSecsf();
-					minDeltaFramePacketRecvTime = std::min(dt.toMilliSecsf(), minDeltaFramePacketRecvTime);
-					maxDeltaFramePacketRecvTime = std::max(dt.toMilliSecsf(), maxDeltaFramePacketRecvTime);
-
-					numReceivedFramePackets += 1;
-					numEnqueuedFramePackets += 1;
-					lastFramePacketRecvTime = spring_gettime();
-
-					if (logMessages) {
-						LOG_L(L_INFO,
-							"\t[%s] (received=%u enqueued=%u) packets (dt=%fms mindt=%fms maxdt=%fms sumdt=%fms)",
-							__func__, numReceivedFramePackets, numEnqueuedFramePackets, dt.toMilliSecsf(),
-							minDeltaFramePacketRecvTime, maxDeltaFramePacketRecvTime, sumDeltaFramePacketRecvTime
-						);
+				if (*bufp == NETMSG_FRAMEBATCH) {
+					// never expected by a server or a client that did not request it
+					if (expandFrameBatches) {
+						try {
+							ExpandFrameBatch(std::make_shared<RawPacket>(bufp, pktLength), batchFrames, batchKeyFrames);
+						} catch (const netcode::UnpackPacketException& ex) {
+							LOG_L(L_ERROR, "\t[%s] discarding incoming invalid frame-batch (%s)", __func__, ex.what());
+						}
+
+						for (std::shared_ptr<const RawPacket>& framePacket: batchFrames) {
+							EnqueueMessage(std::move(framePacket));
+						}
+
+						batchFrames.clear();
+					} else {
+						LOG_L(L_ERROR, "\t[%s] discarding incoming unrequested frame-batch", __func__);
 					}
+				} else {
+					EnqueueMessage(std::make_shared<RawPacket>(bufp, pktLength));
 				}
-				#endif
 
 				pos += pktLength;
-				numPings += (msgPacket->data[0] == NETMSG_PING); // incoming
 			} else {
 				if (pktLength >= 0) {
 					// partial packet in buffer
@@ -693,6 +707,143 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	UpdateWaitingPackets();
 }
 
+void UDPConnection::EnqueueMessage(std::shared_ptr<const RawPacket> msgPacket)
+{
+	#ifdef ENABLE_DEBUG_STATS
+	// server sends both of these, clients send only keyframe messages
+	// TODO: would be easy to feed this data into a Q3A-style lagometer
+	//
+	if (msgPacket->data[0] == NETMSG_NEWFRAME || msgPacket->data[0] == NETMSG_KEYFRAME) {
+		const spring_time dt = spring_gettime() - lastFramePacketRecvTime;
+
+		sumDeltaFramePacketRecvTime += dt.toMilliSecsf();
+		minDeltaFramePacketRecvTime = std::min(dt.toMilliSecsf(), minDeltaFramePacketRecvTime);
+		maxDeltaFramePacketRecvTime = std::max(dt.toMilliSecsf(), maxDeltaFramePacketRecvTime);
+
+		numReceivedFramePackets += 1;
+		numEnqueuedFramePackets += 1;
+		lastFramePacketRecvTime = spring_gettime();
+
+		if (logMessages) {
+			LOG_L(L_INFO,
+				"\t[%s] (received=%u enqueued=%u) packets (dt=%fms mindt=%fms maxdt=%fms sumdt=%fms)",
+				__func__, numReceivedFramePackets, numEnqueuedFramePackets, dt.toMilliSecsf(),
+				minDeltaFramePacketRecvTime, maxDeltaFramePacketRecvTime, sumDeltaFramePacketRecvTime
+			);
+		}
+	}
+	#endif
+
+	numPings += (msgPacket->data[0] == NETMSG_PING); // incoming
+	msgQueue.emplace_back(std::move(msgPacket));
+}
+
+void UDPConnection::ExpandFrameBatch(
+	std::shared_ptr<const RawPacket> batchPacket,
+	std::vector< std::shared_ptr<const RawPacket> >& packets,
+	std::vector<std::uint32_t>& keyFrameIndices
+) {
+	uint32_t numFrames = 0;
+	uint32_t numKeyFrames = 0;
+	uint32_t firstKeyFrameNum = 0;
+
+	keyFrameIndices.clear();
+
+	netcode::UnpackPacket msg(batchPacket, 2);
+	msg.UnpackVarInt(numFrames);
+	msg.UnpackVarInt(numKeyFrames);
+
+	// a batch always replaces at least two messages; the upper bound
+	// keeps a peer from making us enqueue an arbitrary number of them
+	if (numFrames < 2 || numFrames > MAX_BATCH_FRAMES)
+		throw netcode::UnpackPacketException("Invalid frame count");
+	if (numKeyFrames > numFrames)
+		throw netcode::UnpackPacketException("Invalid keyframe count");
+
+	if (numKeyFrames > 0)
+		msg.UnpackVarInt(firstKeyFrameNum);
+
+	for (uint32_t i = 0, keyFrameIndex = 0; i < numKeyFrames; i++) {
+		uint32_t delta = 0;
+		msg.UnpackVarInt(delta);
+
+		// indices must be ascending and within the batch
+		if ((i > 0 && delta == 0) || (delta >= (numFrames - keyFrameIndex)))
+			throw netcode::UnpackPacketException("Invalid keyframe index");
+
+		keyFrameIndices.push_back(keyFrameIndex += delta);
+	}
+
+	const std::shared_ptr<const RawPacket> newFramePacket = CBaseNetProtocol::Get().SendNewFrame();
+
+	for (uint32_t i = 0, k = 0; i < numFrames; i++) {
+		if (k < keyFrameIndices.size() && keyFrameIndices[k] == i) {
+			packets.emplace_back(CBaseNetProtocol::Get().SendKeyFrame(firstKeyFrameNum + (i - keyFrameIndices[0])));
+			k += 1;
+		} else {
+			packets.emplace_back(newFramePacket);
+		}
+	}
+}
+
+void UDPConnection::CoalesceFrameMessages(
+	std::deque< std::shared_ptr<const RawPacket> >& packets,
+	std::vector<std::uint32_t>& keyFrameIndices
+) {
+	const auto GetFrameMessageType = [&](size_t i) -> int {
+		const RawPacket* p = packets[i].get();
+
+		if (p->data[0] == NETMSG_NEWFRAME && p->length == 1)
+			return NETMSG_NEWFRAME;
+		if (p->data[0] == NETMSG_KEYFRAME && p->length == 5)
+			return NETMSG_KEYFRAME;
+
+		return -1;
+	};
+	const auto GetKeyFrameNum = [&](size_t i) {
+		int32_t keyFrameNum = 0;
+		std::memcpy(&keyFrameNum, packets[i]->data + 1, sizeof(keyFrameNum));
+		return keyFrameNum;
+	};
+
+	size_t numCoalesced = 0;
+
+	// compact in place, a batch always replaces at least two messages
+	for (size_t i = 0, n = packets.size(); i < n; ) {
+		size_t j = i;
+
+		keyFrameIndices.clear();
+
+		for (int type; (j < n) && ((j - i) < MAX_BATCH_FRAMES) && ((type = GetFrameMessageType(j)) != -1); j++) {
+			if (type != NETMSG_KEYFRAME)
+				continue;
+
+			// keyframe numbers are reconstructed from the first, which
+			// requires that the messages in between are exactly one each
+			if (!keyFrameIndices.empty() && (GetKeyFrameNum(j) - GetKeyFrameNum(i + keyFrameIndices[0])) != int32_t(j - i - keyFrameIndices[0]))
+				break;
+
+			keyFrameIndices.push_back(j - i);
+		}
+
+		if ((j - i) < 2) {
+			if (numCoalesced != i)
+				packets[numCoalesced] = std::move(packets[i]);
+
+			numCoalesced += 1;
+			i += 1;
+			continue;
+		}
+
+		const int32_t firstKeyFrameNum = keyFrameIndices.empty()? 0: GetKeyFrameNum(i + keyFrameIndices[0]);
+
+		packets[numCoalesced++] = CBaseNetProtocol::Get().SendFrameBatch(j - i, firstKeyFrameNum, keyFrameIndices);
+		i = j;
+	}
+
+	packets.resize(numCoalesced);
+}
+
 void UDPConnection::Flush(const bool forced)
 {
 	if (muted)
@@ -714,8 +865,14 @@ void UDPConnection::Flush(const bool forced)
 	}
 
 	if (forced || (!waitMore && outgoingLength > requiredLength)) {
-		std::uint8_t buffer[udpMaxPacketSize];
+		if (frameBatching)
+			CoalesceFrameMessages(outgoingData, batchKeyFrames);
+
+		std::vector<Chunk::Slice> slices;
 		unsigned pos = 0;
+		// bytes of the front packet already referenced by a chunk; a packet
+		// is never left partially sent when the loop below terminates
+		unsigned packetOffset = 0;
 
 		// Manually fragment packets to respect configured UDP_MTU.
 		// This is an attempt to fix the bug where players drop out
@@ -723,42 +880,62 @@ void UDPConnection::Flush(const bool forced)
 		bool partialPacket = false;
 		bool sendMore = true;
 
+		spring_time chunkRelayTime = spring_notime;
+
+		// called for each packet leaving outgoingData; relayed ones are
+		// only timed once the chunk completing them is actually sent
+		const auto PopRelayTime = [&](const RawPacket* packet) {
+			if (relayedData.empty() || relayedData.front().first != packet)
+				return;
+
+			if (!spring_istime(chunkRelayTime) || relayedData.front().second < chunkRelayTime)
+				chunkRelayTime = relayedData.front().second;
+
+			relayedData.pop_front();
+		};
+
 		do {
 			sendMore  = (outgoing.GetAverage(true) <= globalConfig.linkOutgoingBandwidth);
 			sendMore |= ((globalConfig.linkOutgoingBandwidth <= 0) || partialPacket || forced);
 
 			if (!outgoingData.empty() && sendMore) {
-				std::shared_ptr<const RawPacket>& packet = *(outgoingData.begin());
+				const std::shared_ptr<const RawPacket>& packet = outgoingData.front();
 
 				if (!partialPacket && !ProtocolDef::GetInstance()->IsValidPacket(packet->data, packet->length)) {
 					LOG_L(L_ERROR,
 						"[UDPConnection::%s] discarding outgoing invalid packet: ID %d, LEN %d",
 						__func__, ((packet->length > 0) ? (int)packet->data[0] : -1), packet->length
 					);
+					PopRelayTime(packet.get());
 					outgoingData.pop_front();
 				} else {
-					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length);
+					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length - packetOffset);
 
 					assert(packet->length > 0);
-					memcpy(buffer + pos, packet->data, numBytes);
+					slices.push_back({packet, packetOffset, numBytes});
 
 					pos += numBytes;
 					sentOverhead += Packet::headerSize;
 
 					outgoing.DataSent(numBytes, true);
 
-					if ((partialPacket = (numBytes != packet->length))) {
-						// partially transfered
-						packet.reset(new RawPacket(packet->data + numBytes, packet->length - numBytes));
+					if ((partialPacket = ((packetOffset += numBytes) != packet->length))) {
+						// partially transfered, remainder goes into the next chunk
 					} else {
-						// full packet copied
+						// full packet referenced
+						PopRelayTime(packet.get());
 						outgoingData.pop_front();
+						packetOffset = 0;
 					}
 				}
 			}
 			if ((pos > 0) && (outgoingData.empty() || (pos == maxChunkSize) || !sendMore)) {
-				CreateChunk(buffer, pos, currentPacketChunkNum++);
+				CreateChunk(std::move(slices), pos, currentPacketChunkNum++);
+				slices.clear();
 				pos = 0;
+
+				newChunks.back()->relayTime = chunkRelayTime;
+				chunkRelayTime = spring_notime;
 			}
 		} while (!outgoingData.empty() && sendMore);
 	}
@@ -832,13 +1009,13 @@ void UDPConnection::SetMTU(unsigned mtu2)
 	}
 }
 
-void UDPConnection::CreateChunk(const unsigned char* data, const unsigned length, const int packetNum)
+void UDPConnection::CreateChunk(std::vector<Chunk::Slice>&& slices, const unsigned length, const int packetNum)
 {
 	assert((length > 0) && (length < 255));
 	ChunkPtr buf(new Chunk);
 	buf->chunkNumber = packetNum;
 	buf->chunkSize = length;
-	std::copy(data, data + length, std::back_inserter(buf->data));
+	buf->slices = std::move(slices);
 	newChunks.push_back(buf);
 	lastChunkCreatedTime = spring_gettime();
 }
@@ -1016,6 +1193,9 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 				sent = true;
 			} else if (!resend && canSendNew) {
+				if (spring_istime(newChunks[0]->relayTime))
+					AddRelayLatency((curTime - newChunks[0]->relayTime).toMilliSecsf());
+
 				buf.chunks.push_back(newChunks[0]);
 				unackedChunks.push_back(newChunks[0]);
 				newChunks.pop_front();
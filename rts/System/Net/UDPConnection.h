@@ -8,6 +8,7 @@
 #include <deque>
 
 #include "Connection.h"
+#include "RawPacket.h"
 #include "System/Misc/SpringTime.h"
 #include "System/UnorderedSet.hpp"
 
@@ -29,13 +30,27 @@ namespace netcode {
 class Chunk
 {
 public:
-	unsigned GetSize() const { return (data.size() + headerSize); }
+	/// byte-range of a queued outgoing packet
+	struct Slice {
+		std::shared_ptr<const RawPacket> packet;
+		std::uint32_t offset;
+		std::uint32_t length;
+	};
+
+	unsigned GetSize() const { return (chunkSize + headerSize); }
 	void UpdateChecksum(CRC& crc) const;
 	static constexpr unsigned maxSize = 254;
 	static constexpr unsigned headerSize = 5;
 	std::int32_t chunkNumber;
 	std::uint8_t chunkSize;
+	/// payload of received chunks
 	std::vector<std::uint8_t> data;
+	/// payload of created chunks; references the packets handed to SendData
+	/// (shared between all connections a packet was broadcast to) so their
+	/// bytes are only copied once, into the datagram buffer by SendPacket
+	std::vector<Slice> slices;
+	/// earliest receive-time of the relayed packets completed by this chunk
+	spring_time relayTime = spring_notime;
 };
 typedef std::shared_ptr<Chunk> ChunkPtr;
 
@@ -91,9 +106,14 @@ public:
 		MAX_LOSS_FACTOR = 2
 	};
 
+	/// at most one byte per frame even if every frame were a keyframe,
+	/// keeps NETMSG_FRAMEBATCH within its uint8_t size
+	static constexpr unsigned int MAX_BATCH_FRAMES = 127;
+
 
 	// START overriding CConnection
 	void SendData(std::shared_ptr<const RawPacket> pkt) override;
+	void RelayData(std::shared_ptr<const RawPacket> pkt, spring_time recvTime) override;
 	bool HasIncomingData() const override { return !msgQueue.empty(); }
 	std::shared_ptr<const RawPacket> Peek(unsigned ahead) const override;
 	std::shared_ptr<const RawPacket> GetData() override;
@@ -123,6 +143,11 @@ public:
 
 	int GetReconnectSecs() const { return reconnectTime; }
 
+	unsigned int GetNumSentPackets() const { return sentPackets; }
+	unsigned int GetNumRecvPackets() const { return recvPackets; }
+	unsigned int GetNumCreatedChunks() const { return currentPacketChunkNum; }
+	unsigned int GetNumResentChunks() const { return resentChunks; }
+
 	/// Are we using this address?
 	bool IsUsingAddress(const asio::ip::udp::endpoint& from) const { return (addr == from); }
 	bool UseMinLossFactor() const { return (netLossFactor == MIN_LOSS_FACTOR); }
@@ -131,6 +156,24 @@ public:
 	void Unmute() override { muted = false; }
 	void Close(bool flush) override;
 	void SetLossFactor(int factor) override;
+	void SetFrameBatching(bool enable) override { frameBatching = enable; }
+	/// only set on the client end of a connection that asked the server for batching
+	void SetFrameBatchExpansion(bool enable) { expandFrameBatches = enable; }
+
+	/// replaces runs of NETMSG_{NEW,KEY}FRAME's in packets by NETMSG_FRAMEBATCH's
+	static void CoalesceFrameMessages(
+		std::deque< std::shared_ptr<const RawPacket> >& packets,
+		std::vector<std::uint32_t>& keyFrameIndices
+	);
+	/**
+	 * @brief append the frame-messages a NETMSG_FRAMEBATCH stands for to packets
+	 * @throw UnpackPacketException if the batch is malformed (packets is unchanged)
+	 */
+	static void ExpandFrameBatch(
+		std::shared_ptr<const RawPacket> batchPacket,
+		std::vector< std::shared_ptr<const RawPacket> >& packets,
+		std::vector<std::uint32_t>& keyFrameIndices
+	);
 
 	const asio::ip::udp::endpoint& GetEndpoint() const { return addr; }
 
@@ -145,7 +188,7 @@ private:
 	void Init();
 
 	/// add header to data and send it
-	void CreateChunk(const unsigned char* data, const unsigned length, const int packetNum);
+	void CreateChunk(std::vector<Chunk::Slice>&& slices, const unsigned length, const int packetNum);
 	void SendIfNecessary(bool flushed);
 	void AckChunks(int lastAck);
 
@@ -155,6 +198,8 @@ private:
 	void UpdateWaitingPackets();
 	void UpdateResendRequests();
 
+	void EnqueueMessage(std::shared_ptr<const RawPacket> msgPacket);
+
 private:
 	spring_time lastChunkCreatedTime;
 	spring_time lastPacketSendTime;
@@ -179,12 +224,16 @@ private:
 	bool resend;
 	bool sharedSocket;
 	bool logMessages;
+	bool frameBatching;
+	bool expandFrameBatches;
 
 	int netLossFactor;
 	int reconnectTime;
 
 	/// outgoing stuff (pure data without header) waiting to be sent
 	std::deque< std::shared_ptr<const RawPacket> > outgoingData;
+	/// receive-times of the relayed packets in outgoingData, same order
+	std::deque< std::pair<const RawPacket*, spring_time> > relayedData;
 	/// packets we have received but not yet read
 	std::vector< std::pair<int, RawPacket> > waitingPackets;
 	spring::unordered_set<int> incomingChunkNums;
@@ -207,6 +256,8 @@ private:
 	std::vector<std::uint8_t> waitBuffer;
 
 	std::vector<int> droppedPackets;
+	std::vector<std::uint32_t> batchKeyFrames;
+	std::vector< std::shared_ptr<const RawPacket> > batchFrames;
 
 	std::int32_t lastMidChunk;
 
@@ -7,11 +7,17 @@
 #endif
 #include "System/Misc/NonCopyable.h"
 
+#include <algorithm>
 #include <memory>
 #include <asio.hpp>
 #include <cinttypes>
 #include <queue>
 
+#ifndef _WIN32
+#include <cerrno>
+#include <poll.h>
+#endif
+
 
 #include "ProtocolDef.h"
 #include "UDPConnection.h"
@@ -186,6 +192,50 @@ void UDPListener::Update() {
 }
 
 
+bool UDPListener::WaitForData(spring_time timeout)
+{
+	if (socket->available() > 0)
+		return true;
+
+	// NOTE:
+	//   waits on the native socket rather than through netservice; that
+	//   io_service is shared with every other socket in the process (e.g.
+	//   the local client's connection to this server) so running it here
+	//   would execute their handlers on the server thread, and it can not
+	//   be run with a timeout by several threads at once
+	#ifdef _WIN32
+	fd_set readSet;
+	timeval tv = {long(timeout.toMicroSecsi() / 1000000), long(timeout.toMicroSecsi() % 1000000)};
+
+	FD_ZERO(&readSet);
+	FD_SET(socket->native_handle(), &readSet);
+
+	return (select(0, &readSet, nullptr, nullptr, &tv) > 0);
+	#else
+	pollfd pfd = {socket->native_handle(), POLLIN, 0};
+
+	// round up, a sub-millisecond timeout must not turn into a busy-wait
+	const int waitTime = std::max(0, int((timeout.toMicroSecsi() + 999) / 1000));
+	int ret = 0;
+
+	// a signal interrupting the wait is not an error, just retry
+	while ((ret = poll(&pfd, 1, waitTime)) < 0 && errno == EINTR);
+
+	return (ret > 0);
+	#endif
+}
+
+void UDPListener::FlushConnections()
+{
+	for (const auto& p: connMap) {
+		if (p.second.expired())
+			continue;
+
+		p.second.lock()->Flush(false);
+	}
+}
+
+
 std::shared_ptr<UDPConnection> UDPListener::SpawnConnection(const std::string& ip, const unsigned port)
 {
 	std::shared_ptr<UDPConnection> newConn(new UDPConnection(socket, ip::udp::endpoint(WrapIP(ip), port)));
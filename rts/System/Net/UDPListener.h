@@ -4,6 +4,7 @@
 #define _UDP_LISTENER_H
 
 #include "System/Misc/NonCopyable.h"
+#include "System/Misc/SpringTime.h"
 #include <memory>
 #include <asio/ip/udp.hpp>
 #include <map>
@@ -55,6 +56,19 @@ public:
 	 */
 	void Update();
 
+	/**
+	 * @brief Block until data can be read from the socket
+	 * @param  timeout maximum time to wait
+	 * @return true if data arrived, false on timeout
+	 */
+	bool WaitForData(spring_time timeout);
+
+	/**
+	 * @brief Send out data queued on the connections since the last Update
+	 * (subject to the usual rate limits)
+	 */
+	void FlushConnections();
+
 	/**
 	 * Set if we are accepting new connections
 	 * or drop all data from unconnected addresses.
@@ -60,6 +60,30 @@ public:
 		pos += text.size() + 1;
 	}
 
+	/// counterpart of PackPacket::PackVarInt
+	void UnpackVarInt(uint32_t& value)
+	{
+		value = 0;
+
+		for (uint32_t shift = 0; shift < 32; shift += 7) {
+			if (pos >= pckt->length) {
+				throw UnpackPacketException("Unpack failure (varint)");
+			}
+
+			const uint8_t byte = pckt->data[pos++];
+
+			value |= (uint32_t(byte & 0x7F) << shift);
+
+			if ((byte & 0x80) == 0)
+				return;
+		}
+
+		throw UnpackPacketException("Unpack failure (varint overflow)");
+	}
+
+	/// number of bytes not yet unpacked, for trailing optional fields
+	size_t GetRemainingSize() const { return (pckt->length - pos); }
+
 private:
 	std::shared_ptr<const RawPacket> pckt;
 	size_t pos;
@@ -36,6 +36,7 @@
 #include "Game/Game.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/PreGame.h"
+#include "Game/ReplayBatch.h"
 #include "Game/UI/KeyBindings.h"
 #include "Game/UI/KeyCodes.h"
 #include "Game/UI/InfoConsole.h"
@@ -134,6 +135,8 @@ DEFINE_string   (map,                                      "",    "Specify the m
 DEFINE_string   (menu,                                     "",    "Specify a lua menu archive to be used by spring");
 DEFINE_string   (name,                                     "",    "Set your player name");
 DEFINE_bool     (oldmenu,                                  false, "Start the old menu");
+DEFINE_string_EX(replay_batch,       "replay-batch",       "",    "Replay all demos listed (one per line) in the given file as fast as possible, then write their team statistics to a CSV file in the write-dir and exit");
+DEFINE_string_EX(replay_worker,      "replay-worker",      "",    "Only replay every N-th demo of --replay-batch starting at the K-th (0-based), given as K/N; lets N processes share one list");
 
 
 
@@ -596,6 +599,14 @@ void SpringApp::Startup()
 
 	luaMenuController = new CLuaMenuController(FLAGS_menu);
 
+	if (!FLAGS_replay_batch.empty()) {
+		if (!replayBatch.Init(FLAGS_replay_batch, FLAGS_replay_worker))
+			throw content_error("no demos to replay in batch-file " + FLAGS_replay_batch);
+
+		LoadDemoFile(replayBatch.GetDemoFile());
+		return;
+	}
+
 	// no argument (either game is given or show selectmenu)
 	if (inputFile.empty()) {
 		clientSetup->isHost = true;
@@ -620,7 +631,7 @@ void SpringApp::Startup()
 		pregame = new CPreGame(clientSetup);
 		return;
 	}
-	if (extension == "sdfz") {
+	if (extension == "sdfz" || extension == "sdfb") {
 		LoadDemoFile(inputFile);
 		return;
 	}
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <climits>
 #include <cstring>
+#include <thread>
 
 #include "System/TimeProfiler.h"
 #include "System/GlobalRNG.h"
@@ -16,6 +17,7 @@
 
 static spring::spinlock profileMutex;
 static spring::spinlock hashToNameMutex;
+static spring::spinlock captureMutex;
 static spring::unordered_map<unsigned, std::string> hashToName;
 static spring::unordered_map<unsigned, int> refCounters;
 
@@ -336,6 +338,9 @@ void CTimeProfiler::AddTime(
 ) {
 	const spring_time t0 = spring_now();
 
+	if (capturing)
+		AddCaptureEvent(nameHash, startTime, deltaTime);
+
 	if (!enabled) {
 		if (!specialTimer)
 			return;
@@ -405,3 +410,142 @@ void CTimeProfiler::PrintProfilingInfo() const
 	}
 }
 
+
+void CTimeProfiler::SetCaptureRange(int firstFrame, int lastFrame, const std::string& fileName)
+{
+	// a capture already in progress is discarded
+	capturing = false;
+
+	std::lock_guard<spring::spinlock> lock(captureMutex);
+
+	captureEvents.clear();
+	captureFrames.clear();
+
+	captureFileName = fileName;
+	captureFirstFrame = firstFrame;
+	captureLastFrame = lastFrame;
+}
+
+void CTimeProfiler::UpdateCapture(int frameNum)
+{
+	if (captureFirstFrame < 0)
+		return;
+
+	if (!capturing) {
+		if (frameNum < captureFirstFrame)
+			return;
+
+		if (frameNum > captureLastFrame) {
+			LOG_L(L_WARNING, "[TimeProfiler::%s] capture-range [%d,%d] has already passed", __func__, captureFirstFrame, captureLastFrame);
+			captureFirstFrame = -1;
+			captureLastFrame = -1;
+			return;
+		}
+
+		{
+			std::lock_guard<spring::spinlock> lock(captureMutex);
+
+			captureEvents.clear();
+			captureEvents.reserve(1 << 16);
+			captureFrames.clear();
+			captureStartTime = spring_gettime();
+			captureThreadId = std::this_thread::get_id();
+		}
+
+		capturing = true;
+
+		LOG("[TimeProfiler::%s] capturing sim-frames %d to %d", __func__, captureFirstFrame, captureLastFrame);
+	}
+
+	if (frameNum <= captureLastFrame) {
+		std::lock_guard<spring::spinlock> lock(captureMutex);
+		captureFrames.emplace_back(frameNum, spring_gettime());
+		return;
+	}
+
+	capturing = false;
+
+	if (WriteCapture()) {
+		LOG("[TimeProfiler::%s] wrote %u timer-events to \"%s\"", __func__, unsigned(captureEvents.size()), captureFileName.c_str());
+	} else {
+		LOG_L(L_WARNING, "[TimeProfiler::%s] could not write \"%s\"", __func__, captureFileName.c_str());
+	}
+
+	SetCaptureRange(-1, -1, "");
+}
+
+void CTimeProfiler::AddCaptureEvent(const unsigned nameHash, const spring_time startTime, const spring_time deltaTime)
+{
+	int threadNum = -1;
+
+	if (std::this_thread::get_id() == captureThreadId) {
+		threadNum = 0;
+	} else {
+		#ifdef THREADPOOL
+		// pool-workers are numbered from 1, all other threads are 0
+		if (ThreadPool::GetThreadNum() > 0)
+			threadNum = ThreadPool::GetThreadNum();
+		#endif
+	}
+
+	std::lock_guard<spring::spinlock> lock(captureMutex);
+
+	// timers that were started before the capture are cut off
+	if (startTime < captureStartTime)
+		return;
+
+	captureEvents.push_back({nameHash, threadNum, startTime, deltaTime});
+}
+
+bool CTimeProfiler::WriteCapture() const
+{
+	FILE* file = fopen(captureFileName.c_str(), "w");
+
+	if (file == nullptr)
+		return false;
+
+	std::lock_guard<spring::spinlock> captureLock(captureMutex);
+	std::lock_guard<spring::spinlock> hashToNameLock(hashToNameMutex);
+
+	const auto GetTimeStamp = [&](const spring_time t) { return ((t - captureStartTime).toNanoSecsi() * 1e-3); };
+
+	std::vector<int> threadNums;
+
+	for (const CaptureEvent& e: captureEvents) {
+		threadNums.push_back(e.threadNum);
+	}
+
+	std::sort(threadNums.begin(), threadNums.end());
+	threadNums.erase(std::unique(threadNums.begin(), threadNums.end()), threadNums.end());
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (const int threadNum: threadNums) {
+		char threadName[32];
+
+		switch (threadNum) {
+			case -1: { snprintf(threadName, sizeof(threadName), "other"); } break;
+			case  0: { snprintf(threadName, sizeof(threadName), "main"); } break;
+			default: { snprintf(threadName, sizeof(threadName), "worker-%d", threadNum); } break;
+		}
+
+		fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", threadNum, threadName);
+		fprintf(file, "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"sort_index\":%d}},\n", threadNum, threadNum);
+	}
+
+	for (const auto& p: captureFrames) {
+		fprintf(file, "{\"name\":\"SimFrame %d\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":%.3f},\n", p.first, GetTimeStamp(p.second));
+	}
+
+	for (const CaptureEvent& e: captureEvents) {
+		const auto iter = hashToName.find(e.nameHash);
+		const char* name = (iter != hashToName.end())? iter->second.c_str(): "???";
+
+		fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f},\n", name, e.threadNum, GetTimeStamp(e.startTime), e.deltaTime.toNanoSecsi() * 1e-3);
+	}
+
+	// trailing entry so the array has no dangling comma
+	fprintf(file, "{\"name\":\"capture_end\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":%.3f}\n]}\n", GetTimeStamp(spring_gettime()));
+
+	return (fclose(file) == 0);
+}
@@ -7,6 +7,7 @@
 #include <cstring> // memset
 #include <string>
 #include <deque>
+#include <thread>
 #include <vector>
 
 #include "System/Misc/SpringTime.h"
@@ -163,6 +164,14 @@ public:
 	void SetEnabled(bool b) { enabled = b; }
 	void PrintProfilingInfo() const;
 
+	// capture-mode; every timer measurement taken (on any thread) while
+	// sim-frames [firstFrame, lastFrame] run is recorded and written to
+	// fileName in Chrome trace-event format (chrome://tracing, Perfetto)
+	void SetCaptureRange(int firstFrame, int lastFrame, const std::string& fileName);
+	// called at the start of every sim-frame
+	void UpdateCapture(int frameNum);
+	bool IsCapturing() const { return capturing; }
+
 	void AddTime(
 		unsigned nameHash,
 		const spring_time startTime,
@@ -179,6 +188,18 @@ public:
 		const bool threadTimer
 	);
 
+private:
+	struct CaptureEvent {
+		unsigned nameHash;
+		int threadNum; // 0 for the main thread, -1 for non-pool threads
+
+		spring_time startTime;
+		spring_time deltaTime;
+	};
+
+	void AddCaptureEvent(unsigned nameHash, const spring_time startTime, const spring_time deltaTime);
+	bool WriteCapture() const;
+
 private:
 	spring::unordered_map<unsigned, TimeRecord> profiles;
 
@@ -193,6 +214,20 @@ private:
 
 	// if false, AddTime is a no-op for (almost) all timers
 	std::atomic<bool> enabled;
+
+	std::vector<CaptureEvent> captureEvents;
+	// start-time of each captured sim-frame
+	std::vector< std::pair<int, spring_time> > captureFrames;
+
+	std::string captureFileName;
+	spring_time captureStartTime;
+	// the (main) thread UpdateCapture is called from
+	std::thread::id captureThreadId;
+
+	int captureFirstFrame = -1;
+	int captureLastFrame = -1;
+
+	std::atomic<bool> capturing = {false};
 };
 
 
@@ -1,6 +1,9 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -54,7 +57,16 @@ extern "C"
 {
 #endif
 
-void ParseCmdLine(int argc, char* argv[], std::string& scriptName)
+struct DedicatedGame {
+	std::string scriptName;
+	std::shared_ptr<CGameSetup> gameSetup;
+	std::unique_ptr<CGameServer> server;
+
+	bool printData = true;
+};
+
+
+void ParseCmdLine(int argc, char* argv[], std::vector<std::string>& scriptNames)
 {
 	#undef  LOG_SECTION_CURRENT
 	#define LOG_SECTION_CURRENT LOG_SECTION_DEFAULT
@@ -71,10 +83,12 @@ void ParseCmdLine(int argc, char* argv[], std::string& scriptName)
 		exit(0);
 	}
 
-	if (argc >= 2)
-		scriptName = argv[1];
+	// every script is hosted as a separate game
+	for (int i = 1; i < argc; i++) {
+		scriptNames.emplace_back(argv[i]);
+	}
 
-	if (scriptName.empty() && !FLAGS_list_config_vars) {
+	if (scriptNames.empty() && !FLAGS_list_config_vars) {
 		gflags::ShowUsageWithFlags(argv[0]);
 		exit(1);
 	}
@@ -105,6 +119,91 @@ void ParseCmdLine(int argc, char* argv[], std::string& scriptName)
 }
 
 
+static void StartGame(DedicatedGame& game, CGlobalUnsyncedRNG& rng)
+{
+	const std::string& scriptName = game.scriptName;
+
+	LOG("loading script from file: %s", scriptName.c_str());
+
+	// server will take ownership of these
+	std::shared_ptr<ClientSetup> dsClientSetup(new ClientSetup());
+	std::shared_ptr<GameData> dsGameData(new GameData());
+	std::shared_ptr<CGameSetup> dsGameSetup(new CGameSetup());
+
+	std::string scriptText;
+	CFileHandler fh(scriptName);
+
+	if (!fh.FileExists())
+		throw content_error("script does not exist in given location: " + scriptName);
+
+	if (!fh.LoadStringData(scriptText))
+		throw content_error("script cannot be read: " + scriptName);
+
+	dsClientSetup->LoadFromStartScript(scriptText);
+
+	if (!dsGameSetup->Init(scriptText)) {
+		// read the script provided by cmdline
+		LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
+		return;
+	}
+
+	dsGameData->SetRandomSeed(rng.NextInt());
+
+	{
+		sha512::raw_digest dsMapChecksum;
+		sha512::raw_digest dsModChecksum;
+		sha512::hex_digest dsMapChecksumHex;
+		sha512::hex_digest dsModChecksumHex;
+
+		std::memcpy(dsMapChecksum.data(), &dsGameSetup->dsMapHash[0], sizeof(dsGameSetup->dsMapHash));
+		std::memcpy(dsModChecksum.data(), &dsGameSetup->dsModHash[0], sizeof(dsGameSetup->dsModHash));
+		sha512::dump_digest(dsMapChecksum, dsMapChecksumHex);
+		sha512::dump_digest(dsModChecksum, dsModChecksumHex);
+
+		LOG("[script-checksums]\n\tmap=%s\n\tmod=%s", dsMapChecksumHex.data(), dsModChecksumHex.data());
+
+		// use script-provided hashes if any byte is non-zero; these
+		// are only used by some client-side (pregame) sanity checks
+		const auto hashPred = [](uint8_t byte) { return (byte != 0); };
+
+		if (std::find_if(dsMapChecksum.begin(), dsMapChecksum.end(), hashPred) != dsMapChecksum.end()) {
+			dsGameData->SetMapChecksum(dsMapChecksum.data());
+			dsGameSetup->LoadStartPositions(false); // reduced mode
+		} else {
+			dsGameData->SetMapChecksum(&archiveScanner->GetArchiveCompleteChecksumBytes(dsGameSetup->mapName)[0]);
+
+			CFileHandler f("maps/" + dsGameSetup->mapName);
+			const bool addMapArchive = !f.FileExists();
+
+			if (addMapArchive)
+				vfsHandler->AddArchiveWithDeps(dsGameSetup->mapName, false);
+
+			dsGameSetup->LoadStartPositions(); // full mode
+
+			// the VFS is shared by all games, keep its maps from clashing
+			if (addMapArchive)
+				vfsHandler->RemoveArchive(dsGameSetup->mapName);
+		}
+
+		if (std::find_if(dsModChecksum.begin(), dsModChecksum.end(), hashPred) != dsModChecksum.end()) {
+			dsGameData->SetModChecksum(dsModChecksum.data());
+		} else {
+			const std::string& modArchive = archiveScanner->ArchiveFromName(dsGameSetup->modName);
+			const sha512::raw_digest& modCheckSum = archiveScanner->GetArchiveCompleteChecksumBytes(modArchive);
+
+			dsGameData->SetModChecksum(&modCheckSum[0]);
+		}
+	}
+
+	LOG("starting server...");
+
+	dsGameData->SetSetupText(dsGameSetup->setupText);
+
+	game.gameSetup = dsGameSetup;
+	game.server.reset(new CGameServer(dsClientSetup, dsGameData, dsGameSetup));
+}
+
+
 
 int main(int argc, char* argv[])
 {
@@ -117,14 +216,13 @@ int main(int argc, char* argv[])
 
 		CLogOutput::LogSystemInfo();
 
-		std::string scriptName;
-		std::string scriptText;
+		std::vector<std::string> scriptNames;
 		std::string binaryName = argv[0];
 
-		gflags::SetUsageMessage("Usage: " + binaryName + " [options] path_to_script.txt");
+		gflags::SetUsageMessage("Usage: " + binaryName + " [options] path_to_script.txt [path_to_script2.txt ...]");
 		gflags::SetVersionString(SpringVersion::GetFull());
 		gflags::ParseCommandLineFlags(&argc, &argv, true);
-		ParseCmdLine(argc, argv, scriptName);
+		ParseCmdLine(argc, argv, scriptNames);
 
 		globalConfig.Init();
 		FileSystemInitializer::InitializeLogOutput();
@@ -134,110 +232,75 @@ int main(int argc, char* argv[])
 		CrashHandler::Install();
 
 		LOG("report any errors to Mantis or the forums.");
-		LOG("loading script from file: %s", scriptName.c_str());
-
-		// server will take ownership of these
-		std::shared_ptr<ClientSetup> dsClientSetup(new ClientSetup());
-		std::shared_ptr<GameData> dsGameData(new GameData());
-		std::shared_ptr<CGameSetup> dsGameSetup(new CGameSetup());
-
-		CFileHandler fh(scriptName);
-
-		if (!fh.FileExists())
-			throw content_error("script does not exist in given location: " + scriptName);
-
-		if (!fh.LoadStringData(scriptText))
-			throw content_error("script cannot be read: " + scriptName);
 
-		dsClientSetup->LoadFromStartScript(scriptText);
+		std::vector<DedicatedGame> games;
+		games.reserve(scriptNames.size());
 
-		if (!dsGameSetup->Init(scriptText)) {
-			// read the script provided by cmdline
-			LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
-			return 1;
-		}
-
-		// create the server, it will run in a separate thread
+		// create the servers, each runs in a separate thread; archive
+		// scanner and VFS are set up once and shared between all games
 		CGlobalUnsyncedRNG rng;
 
 		const uint32_t sleepTime = FLAGS_sleeptime;
 		const uint32_t randSeed = time(nullptr) % ((spring_gettime().toNanoSecsi() + 1) * 9007);
 
 		rng.Seed(randSeed);
-		dsGameData->SetRandomSeed(rng.NextInt());
-
-		{
-			sha512::raw_digest dsMapChecksum;
-			sha512::raw_digest dsModChecksum;
-			sha512::hex_digest dsMapChecksumHex;
-			sha512::hex_digest dsModChecksumHex;
-
-			std::memcpy(dsMapChecksum.data(), &dsGameSetup->dsMapHash[0], sizeof(dsGameSetup->dsMapHash));
-			std::memcpy(dsModChecksum.data(), &dsGameSetup->dsModHash[0], sizeof(dsGameSetup->dsModHash));
-			sha512::dump_digest(dsMapChecksum, dsMapChecksumHex);
-			sha512::dump_digest(dsModChecksum, dsModChecksumHex);
-
-			LOG("[script-checksums]\n\tmap=%s\n\tmod=%s", dsMapChecksumHex.data(), dsModChecksumHex.data());
-
-			// use script-provided hashes if any byte is non-zero; these
-			// are only used by some client-side (pregame) sanity checks
-			const auto hashPred = [](uint8_t byte) { return (byte != 0); };
 
-			if (std::find_if(dsMapChecksum.begin(), dsMapChecksum.end(), hashPred) != dsMapChecksum.end()) {
-				dsGameData->SetMapChecksum(dsMapChecksum.data());
-				dsGameSetup->LoadStartPositions(false); // reduced mode
-			} else {
-				dsGameData->SetMapChecksum(&archiveScanner->GetArchiveCompleteChecksumBytes(dsGameSetup->mapName)[0]);
+		for (const std::string& scriptName: scriptNames) {
+			games.emplace_back();
+			games.back().scriptName = scriptName;
 
-				CFileHandler f("maps/" + dsGameSetup->mapName);
-				if (!f.FileExists())
-					vfsHandler->AddArchiveWithDeps(dsGameSetup->mapName, false);
+			// with more than one game, a broken script only takes out its own
+			try {
+				StartGame(games.back(), rng);
+			} catch (const std::exception& e) {
+				if (scriptNames.size() == 1)
+					throw;
 
-				dsGameSetup->LoadStartPositions(); // full mode
+				LOG_L(L_ERROR, "failed to start game from script %s: %s", scriptName.c_str(), e.what());
 			}
 
-			if (std::find_if(dsModChecksum.begin(), dsModChecksum.end(), hashPred) != dsModChecksum.end()) {
-				dsGameData->SetModChecksum(dsModChecksum.data());
-			} else {
-				const std::string& modArchive = archiveScanner->ArchiveFromName(dsGameSetup->modName);
-				const sha512::raw_digest& modCheckSum = archiveScanner->GetArchiveCompleteChecksumBytes(modArchive);
-
-				dsGameData->SetModChecksum(&modCheckSum[0]);
-			}
+			if (games.back().server == nullptr && scriptNames.size() == 1)
+				return 1;
 		}
 
-		LOG("starting server...");
+		while (std::find_if(games.begin(), games.end(), [](const DedicatedGame& g) { return (g.server != nullptr); }) != games.end()) {
+			for (size_t gameNum = 0; gameNum < games.size(); gameNum++) {
+				DedicatedGame& game = games[gameNum];
+				CGameServer* server = game.server.get();
 
-		{
-			dsGameData->SetSetupText(dsGameSetup->setupText);
-			CGameServer server(dsClientSetup, dsGameData, dsGameSetup);
+				if (server == nullptr)
+					continue;
 
-			while (!server.HasGameID()) {
-				// wait until gameID has been generated or
-				// a timeout occurs (if no clients connect)
-				if (server.HasFinished())
-					break;
+				if (server->HasFinished()) {
+					LOG("game %u (%s) finished", unsigned(gameNum), game.scriptName.c_str());
+					// joins the server thread and writes the demo
+					game.server.reset();
+					continue;
+				}
 
-				spring_sleep(spring_secs(sleepTime));
-			}
+				// wait until gameID has been generated
+				if (!server->HasGameID())
+					continue;
 
-			while (!server.HasFinished()) {
-				static bool printData = (server.GetDemoRecorder() != nullptr);
+				if (!game.printData)
+					continue;
 
-				if (printData) {
-					printData = false;
+				game.printData = false;
 
-					const std::unique_ptr<CDemoRecorder>& demoRec = server.GetDemoRecorder();
-					const std::uint8_t* gameID = (demoRec->GetFileHeader()).gameID;
+				if (server->GetDemoRecorder() == nullptr)
+					continue;
 
-					LOG("recording demo: %s", (demoRec->GetName()).c_str());
-					LOG("using mod: %s", (dsGameSetup->modName).c_str());
-					LOG("using map: %s", (dsGameSetup->mapName).c_str());
-					LOG("GameID: %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x", gameID[0], gameID[1], gameID[2], gameID[3], gameID[4], gameID[5], gameID[6], gameID[7], gameID[8], gameID[9], gameID[10], gameID[11], gameID[12], gameID[13], gameID[14], gameID[15]);
-				}
+				const std::unique_ptr<CDemoRecorder>& demoRec = server->GetDemoRecorder();
+				const std::uint8_t* gameID = (demoRec->GetFileHeader()).gameID;
 
-				spring_secs(sleepTime).sleep(true);
+				LOG("game %u (%s):", unsigned(gameNum), game.scriptName.c_str());
+				LOG("recording demo: %s", (demoRec->GetName()).c_str());
+				LOG("using mod: %s", (game.gameSetup->modName).c_str());
+				LOG("using map: %s", (game.gameSetup->mapName).c_str());
+				LOG("GameID: %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x", gameID[0], gameID[1], gameID[2], gameID[3], gameID[4], gameID[5], gameID[6], gameID[7], gameID[8], gameID[9], gameID[10], gameID[11], gameID[12], gameID[13], gameID[14], gameID[15]);
 			}
+
+			spring_secs(sleepTime).sleep(true);
 		}
 
 		LOG("exiting");
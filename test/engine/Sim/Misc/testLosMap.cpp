@@ -0,0 +1,148 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Game/GlobalUnsynced.h"
+#include "Map/ReadMap.h"
+#include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/LosMap.h"
+
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+// CLosMap only touches these when informing ReadMap of squares entering
+// LOS, which the maps below are not initialized to do
+CGlobalUnsynced* gu = nullptr;
+CReadMap* readMap = nullptr;
+MapDimensions mapDims;
+
+void CReadMap::UpdateLOS(const SRectangle& hmRect) {}
+
+
+static constexpr int LOS_SIZE = 64;
+
+
+class CTestLosMap : public CLosMap
+{
+public:
+	CTestLosMap() { Init(int2(LOS_SIZE, LOS_SIZE), int2(LOS_SIZE, LOS_SIZE), nullptr, nullptr, false); }
+
+	bool operator == (const CTestLosMap& m) const { return (losmap == m.losmap); }
+};
+
+
+// random sorted and non-overlapping RLE's, as produced by PrepareRaycast
+static void RandomSquares(SLosInstance& li, int numRuns, int maxRunLength)
+{
+	li.squares.clear();
+
+	for (int i = 0, idx = rand() % maxRunLength; i < numRuns && idx < (LOS_SIZE * LOS_SIZE); i++) {
+		const unsigned length = std::min(1 + rand() % maxRunLength, (LOS_SIZE * LOS_SIZE) - idx);
+
+		li.squares.push_back({idx, length});
+
+		idx += (length + 1 + rand() % maxRunLength);
+	}
+
+	if (li.squares.empty())
+		li.squares.push_back(SLosInstance::EMPTY_RLE);
+}
+
+static void CheckDiffEqualsRemoveAdd(const SLosInstance& remInstance, const SLosInstance& addInstance)
+{
+	SLosInstance rem = remInstance;
+	SLosInstance add = addInstance;
+	SLosInstance other(2);
+
+	CTestLosMap fullMap;
+	CTestLosMap diffMap;
+
+	// some unrelated coverage, plus the instance about to be removed
+	RandomSquares(other, 32, 64);
+
+	fullMap.AddRaycast(&other, 1);
+	fullMap.AddRaycast(&rem, 1);
+	diffMap.AddRaycast(&other, 1);
+	diffMap.AddRaycast(&rem, 1);
+
+	fullMap.AddRaycast(&rem, -1);
+	fullMap.AddRaycast(&add, 1);
+	diffMap.AddRaycastDiff(&rem, &add);
+
+	CHECK(fullMap == diffMap);
+}
+
+
+
+TEST_CASE("LosMapDiffOverlapping")
+{
+	srand(time(nullptr));
+
+	SLosInstance rem(0);
+	SLosInstance add(1);
+
+	// shifted by one square, as for a unit moving to a neighbouring one
+	rem.squares = {{100, 10}, {164, 12}, {228, 14}};
+	add.squares = {{101, 10}, {165, 12}, {229, 14}};
+	CheckDiffEqualsRemoveAdd(rem, add);
+
+	// one run containing the other, and runs starting or ending together
+	rem.squares = {{100, 40}, {300, 5}, {400, 5}};
+	add.squares = {{110, 10}, {300, 8}, {397, 8}};
+	CheckDiffEqualsRemoveAdd(rem, add);
+	CheckDiffEqualsRemoveAdd(add, rem);
+
+	// identical instances change nothing
+	CheckDiffEqualsRemoveAdd(rem, rem);
+
+	for (int n = 0; n < 1000; n++) {
+		RandomSquares(rem, 20, 16);
+		RandomSquares(add, 20, 16);
+		CheckDiffEqualsRemoveAdd(rem, add);
+	}
+}
+
+TEST_CASE("LosMapDiffDisjoint")
+{
+	SLosInstance rem(0);
+	SLosInstance add(1);
+
+	rem.squares = {{0, 10}, {200, 10}};
+	add.squares = {{10, 10}, {1000, 64}};
+	CheckDiffEqualsRemoveAdd(rem, add);
+	CheckDiffEqualsRemoveAdd(add, rem);
+
+	// interleaved runs
+	rem.squares = {{0, 4}, {8, 4}, {16, 4}};
+	add.squares = {{4, 4}, {12, 4}, {20, 4}};
+	CheckDiffEqualsRemoveAdd(rem, add);
+
+	// up to the last square
+	rem.squares = {{0, 1}};
+	add.squares = {{LOS_SIZE * LOS_SIZE - 5, 5}};
+	CheckDiffEqualsRemoveAdd(rem, add);
+}
+
+TEST_CASE("LosMapDiffEmpty")
+{
+	SLosInstance rem(0);
+	SLosInstance add(1);
+	SLosInstance empty(2);
+
+	empty.squares = {SLosInstance::EMPTY_RLE};
+	rem.squares = {{100, 10}, {300, 20}};
+	add.squares = {{105, 10}};
+
+	CheckDiffEqualsRemoveAdd(empty, add);
+	CheckDiffEqualsRemoveAdd(rem, empty);
+	CheckDiffEqualsRemoveAdd(empty, empty);
+
+	// no squares at all
+	empty.squares.clear();
+
+	CheckDiffEqualsRemoveAdd(empty, add);
+	CheckDiffEqualsRemoveAdd(rem, empty);
+}
@@ -99,3 +99,28 @@ TEST_CASE("QuadField")
 	INFO("Too little quads returned!");
 	CHECK_FALSE(fail);
 }
+
+
+TEST_CASE("QueryVectorCache")
+{
+	QueryVectorCache<int> cache;
+	std::vector<std::vector<int>*> reserved;
+
+	// nesting deeper than the preallocated vectors must not run dry
+	for (int i = 0; i < 8; ++i) {
+		reserved.push_back(cache.ReserveVector());
+		reserved.back()->push_back(i);
+	}
+
+	for (int i = 0; i < 8; ++i) {
+		CHECK(reserved[i]->size() == 1);
+		CHECK(reserved[i]->front() == i);
+		CHECK(std::count(reserved.begin(), reserved.end(), reserved[i]) == 1);
+	}
+
+	// released vectors are handed out again (cleared)
+	cache.ReleaseVector(reserved[5]);
+	std::vector<int>* v = cache.ReserveVector();
+	CHECK(v == reserved[5]);
+	CHECK(v->empty());
+}
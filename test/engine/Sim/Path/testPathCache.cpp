@@ -0,0 +1,184 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Path/Default/PathCache.h"
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+// CPathCache only reads the frame number
+CGlobalSynced gsOBJ;
+CGlobalSynced* gs = &gsOBJ;
+
+
+static constexpr int NUM_BLOCKS = 32;
+static constexpr int MAX_CACHE_SIZE = 200;
+static constexpr int MAX_PATH_LIFETIME = GAME_SPEED * 6;
+
+static const CPathCache::BlocksConnectedFunc ALL_CONNECTED = [](const int2, const int2) { return true; };
+static const CPathCache::BlocksConnectedFunc NONE_CONNECTED = [](const int2, const int2) { return false; };
+
+
+static bool AddPath(CPathCache& cache, int2 strtBlock, int2 goalBlock, float goalRadius = 2.0f, IPath::SearchResult result = IPath::Ok)
+{
+	IPath::Path path;
+	path.pathCost = strtBlock.x * NUM_BLOCKS + strtBlock.y;
+
+	return (cache.AddPath(&path, result, strtBlock, goalBlock, goalRadius, 0));
+}
+
+static bool IsCached(CPathCache& cache, int2 strtBlock, int2 goalBlock, float goalRadius = 2.0f)
+{
+	const CPathCache::CacheItem& ci = cache.GetCachedPath(strtBlock, goalBlock, goalRadius, 0, NONE_CONNECTED);
+	return (ci.strtBlock == strtBlock && ci.result == IPath::Ok);
+}
+
+static IPathManager::PathCacheStats GetStats(const CPathCache& cache)
+{
+	IPathManager::PathCacheStats stats;
+	cache.AddStats(stats);
+	return stats;
+}
+
+
+
+TEST_CASE("PathCacheExactHits")
+{
+	gs->frameNum = 0;
+
+	CPathCache cache(NUM_BLOCKS, NUM_BLOCKS);
+
+	CHECK_FALSE(AddPath(cache, {5, 5}, {20, 20}));
+
+	const CPathCache::CacheItem& ci = cache.GetCachedPath({5, 5}, {20, 20}, 2.0f, 0, NONE_CONNECTED);
+
+	CHECK(ci.result == IPath::Ok);
+	CHECK(ci.strtBlock == int2(5, 5));
+	CHECK(ci.path.pathCost == (5 * NUM_BLOCKS + 5));
+
+	// other goal, path-type or start
+	CHECK(cache.GetCachedPath({5, 5}, {20, 21}, 2.0f, 0, NONE_CONNECTED).result == IPath::Error);
+	CHECK(cache.GetCachedPath({5, 5}, {20, 20}, 2.0f, 1, NONE_CONNECTED).result == IPath::Error);
+	CHECK(cache.GetCachedPath({9, 9}, {20, 20}, 2.0f, 0, NONE_CONNECTED).result == IPath::Error);
+
+	// same hash, only the integer part of the radius is included
+	CHECK(cache.GetCachedPath({5, 5}, {20, 20}, 2.5f, 0, NONE_CONNECTED).result == IPath::Error);
+	CHECK(AddPath(cache, {5, 5}, {20, 20}, 2.5f));
+
+	const IPathManager::PathCacheStats stats = GetStats(cache);
+
+	CHECK(stats.numHits == 1);
+	CHECK(stats.numNearHits == 0);
+	CHECK(stats.numMisses == 4);
+	CHECK(stats.numCachedPaths == 1);
+}
+
+TEST_CASE("PathCacheNearHits")
+{
+	gs->frameNum = 0;
+
+	CPathCache cache(NUM_BLOCKS, NUM_BLOCKS);
+
+	AddPath(cache, {5, 5}, {20, 20});
+	AddPath(cache, {0, 0}, {20, 20}, 2.0f, IPath::CantGetCloser);
+
+	// neighbour is only served if the blocks are connected
+	CHECK(cache.GetCachedPath({6, 5}, {20, 20}, 2.0f, 0, NONE_CONNECTED).result == IPath::Error);
+	CHECK(cache.GetCachedPath({6, 6}, {20, 20}, 2.0f, 0, ALL_CONNECTED).strtBlock == int2(5, 5));
+	CHECK(cache.GetCachedPath({6, 6}, {20, 20}, 2.5f, 0, ALL_CONNECTED).result == IPath::Error);
+
+	int2 testedBlock = {-1, -1};
+
+	const CPathCache::BlocksConnectedFunc blocksConnected = [&](const int2 strtBlock, const int2 nearBlock) {
+		CHECK(strtBlock == int2(4, 5));
+		testedBlock = nearBlock;
+		return true;
+	};
+
+	CHECK(cache.GetCachedPath({4, 5}, {20, 20}, 2.0f, 0, blocksConnected).result == IPath::Ok);
+	CHECK(testedBlock == int2(5, 5));
+
+	// not two blocks away, and never a failed search
+	CHECK(cache.GetCachedPath({7, 5}, {20, 20}, 2.0f, 0, ALL_CONNECTED).result == IPath::Error);
+	CHECK(cache.GetCachedPath({1, 0}, {20, 20}, 2.0f, 0, ALL_CONNECTED).result == IPath::Error);
+	// neighbours outside the map are skipped
+	CHECK(cache.GetCachedPath({0, 1}, {20, 20}, 2.0f, 0, ALL_CONNECTED).result == IPath::Error);
+
+	const IPathManager::PathCacheStats stats = GetStats(cache);
+
+	CHECK(stats.numHits == 2);
+	CHECK(stats.numNearHits == 2);
+	CHECK(stats.numMisses == 5);
+}
+
+TEST_CASE("PathCacheEviction")
+{
+	gs->frameNum = 0;
+
+	CPathCache cache(NUM_BLOCKS, NUM_BLOCKS);
+
+	for (int i = 0; i < MAX_CACHE_SIZE; i++) {
+		AddPath(cache, {i % NUM_BLOCKS, i / NUM_BLOCKS}, {31, 31});
+	}
+
+	CHECK(GetStats(cache).numCachedPaths == MAX_CACHE_SIZE);
+	CHECK(GetStats(cache).numEvictions == 0);
+
+	// a hit makes the oldest path the most recently used one
+	CHECK(IsCached(cache, {0, 0}, {31, 31}));
+
+	AddPath(cache, {0, 0}, {30, 30});
+	AddPath(cache, {1, 0}, {30, 30});
+
+	CHECK(IsCached(cache, {0, 0}, {31, 31}));
+	CHECK_FALSE(IsCached(cache, {1, 0}, {31, 31}));
+	CHECK_FALSE(IsCached(cache, {2, 0}, {31, 31}));
+	CHECK(IsCached(cache, {3, 0}, {31, 31}));
+	CHECK(IsCached(cache, {0, 0}, {30, 30}));
+	CHECK(IsCached(cache, {1, 0}, {30, 30}));
+
+	CHECK(GetStats(cache).numCachedPaths == MAX_CACHE_SIZE);
+	CHECK(GetStats(cache).numEvictions == 2);
+}
+
+TEST_CASE("PathCacheExpiration")
+{
+	gs->frameNum = 0;
+
+	CPathCache cache(NUM_BLOCKS, NUM_BLOCKS);
+
+	AddPath(cache, {1, 1}, {20, 20});
+	AddPath(cache, {2, 2}, {20, 20}, 2.0f, IPath::CantGetCloser);
+
+	gs->frameNum = MAX_PATH_LIFETIME / 2;
+	AddPath(cache, {3, 3}, {20, 20});
+	cache.Update();
+
+	CHECK(GetStats(cache).numCachedPaths == 3);
+
+	// failed searches are kept for half as long
+	gs->frameNum = MAX_PATH_LIFETIME / 2 + 1;
+	cache.Update();
+
+	CHECK(GetStats(cache).numCachedPaths == 2);
+	CHECK(GetStats(cache).numExpirations == 1);
+
+	// hits do not extend the lifetime
+	gs->frameNum = MAX_PATH_LIFETIME;
+	CHECK(IsCached(cache, {1, 1}, {20, 20}));
+	cache.Update();
+
+	gs->frameNum = MAX_PATH_LIFETIME + 1;
+	cache.Update();
+
+	CHECK_FALSE(IsCached(cache, {1, 1}, {20, 20}));
+	CHECK(IsCached(cache, {3, 3}, {20, 20}));
+
+	gs->frameNum = MAX_PATH_LIFETIME * 2;
+	cache.Update();
+
+	CHECK(GetStats(cache).numCachedPaths == 0);
+	CHECK(GetStats(cache).numExpirations == 3);
+}
@@ -0,0 +1,258 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/Net/PackPacket.h"
+#include "System/Net/UnpackPacket.h"
+#include "System/Net/UDPConnection.h"
+
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#define CATCH_CONFIG_MAIN
+#include "lib/catch.hpp"
+
+
+using netcode::RawPacket;
+using netcode::UDPConnection;
+
+typedef std::shared_ptr<const RawPacket> PacketPtr;
+
+
+static PacketPtr MakePacket(const std::vector<uint8_t>& bytes)
+{
+	return std::make_shared<RawPacket>(bytes.data(), bytes.size());
+}
+
+static uint32_t PackUnpackVarInt(uint32_t value)
+{
+	netcode::PackPacket* packet = new netcode::PackPacket(netcode::PackPacket::GetVarIntSize(value));
+	packet->PackVarInt(value);
+
+	CHECK(packet->length == netcode::PackPacket::GetVarIntSize(value));
+
+	const PacketPtr packetPtr(packet);
+	netcode::UnpackPacket msg(packetPtr);
+	uint32_t unpacked = 0;
+	msg.UnpackVarInt(unpacked);
+
+	CHECK(msg.GetRemainingSize() == 0);
+	return unpacked;
+}
+
+static bool SamePackets(const std::deque<PacketPtr>& a, const std::vector<PacketPtr>& b)
+{
+	if (a.size() != b.size())
+		return false;
+
+	for (size_t i = 0; i < a.size(); i++) {
+		if (a[i]->length != b[i]->length)
+			return false;
+		if (memcmp(a[i]->data, b[i]->data, a[i]->length) != 0)
+			return false;
+	}
+
+	return true;
+}
+
+// expands every batch in packets and leaves everything else as-is
+static std::vector<PacketPtr> ExpandAll(const std::deque<PacketPtr>& packets)
+{
+	std::vector<PacketPtr> expanded;
+	std::vector<uint32_t> keyFrameIndices;
+
+	for (const PacketPtr& p: packets) {
+		if (p->data[0] == NETMSG_FRAMEBATCH) {
+			UDPConnection::ExpandFrameBatch(p, expanded, keyFrameIndices);
+		} else {
+			expanded.push_back(p);
+		}
+	}
+
+	return expanded;
+}
+
+static size_t CountBatches(const std::deque<PacketPtr>& packets)
+{
+	size_t n = 0;
+
+	for (const PacketPtr& p: packets) {
+		n += (p->data[0] == NETMSG_FRAMEBATCH);
+	}
+
+	return n;
+}
+
+static void CheckRoundTrip(const std::deque<PacketPtr>& original, size_t numExpectedPackets)
+{
+	std::deque<PacketPtr> coalesced = original;
+	std::vector<uint32_t> keyFrameIndices;
+
+	UDPConnection::CoalesceFrameMessages(coalesced, keyFrameIndices);
+
+	CHECK(coalesced.size() == numExpectedPackets);
+	CHECK(SamePackets(original, ExpandAll(coalesced)));
+}
+
+static void CheckInvalidBatch(const std::vector<uint8_t>& payload)
+{
+	std::vector<uint8_t> bytes = {NETMSG_FRAMEBATCH, uint8_t(2 + payload.size())};
+	bytes.insert(bytes.end(), payload.begin(), payload.end());
+
+	std::vector<PacketPtr> expanded;
+	std::vector<uint32_t> keyFrameIndices;
+
+	CHECK_THROWS_AS(UDPConnection::ExpandFrameBatch(MakePacket(bytes), expanded, keyFrameIndices), netcode::UnpackPacketException);
+	CHECK(expanded.empty());
+}
+
+
+
+TEST_CASE("VarIntRoundTrip")
+{
+	const uint32_t values[] = {0, 1, 127, 128, 300, 16383, 16384, 2097151, 2097152, 0x7FFFFFFF, 0xFFFFFFFF};
+
+	for (const uint32_t value: values) {
+		CHECK(PackUnpackVarInt(value) == value);
+	}
+
+	CHECK(netcode::PackPacket::GetVarIntSize(127) == 1);
+	CHECK(netcode::PackPacket::GetVarIntSize(128) == 2);
+	CHECK(netcode::PackPacket::GetVarIntSize(16383) == 2);
+	CHECK(netcode::PackPacket::GetVarIntSize(16384) == 3);
+	CHECK(netcode::PackPacket::GetVarIntSize(0xFFFFFFFF) == 5);
+
+	uint32_t value = 0;
+
+	// continuation bit set on the last byte
+	netcode::UnpackPacket truncated(MakePacket({0x80, 0x80}));
+	CHECK_THROWS_AS(truncated.UnpackVarInt(value), netcode::UnpackPacketException);
+
+	// more than the five bytes a 32-bit value can need
+	netcode::UnpackPacket overflowed(MakePacket({0x80, 0x80, 0x80, 0x80, 0x80, 0x01}));
+	CHECK_THROWS_AS(overflowed.UnpackVarInt(value), netcode::UnpackPacketException);
+}
+
+TEST_CASE("FrameBatchRoundTrip")
+{
+	CBaseNetProtocol& proto = CBaseNetProtocol::Get();
+
+	std::deque<PacketPtr> packets;
+
+	// a lone frame-message is not worth a batch
+	packets = {proto.SendNewFrame()};
+	CheckRoundTrip(packets, 1);
+
+	packets = {proto.SendNewFrame(), proto.SendNewFrame(), proto.SendNewFrame()};
+	CheckRoundTrip(packets, 1);
+
+	// keyframes every few frames, numbered consecutively
+	packets.clear();
+
+	for (int i = 0; i < 40; i++) {
+		packets.push_back(((i % 16) == 3)? proto.SendKeyFrame(1000 + i): proto.SendNewFrame());
+	}
+
+	CheckRoundTrip(packets, 1);
+
+	// negative keyframe numbers take the full varint width
+	packets = {proto.SendKeyFrame(-5), proto.SendNewFrame(), proto.SendKeyFrame(-3)};
+	CheckRoundTrip(packets, 1);
+
+	// other messages break runs and stay in place
+	packets = {
+		proto.SendNewFrame(),
+		proto.SendKeyFrame(10),
+		proto.SendPause(1, 1),
+		proto.SendNewFrame(),
+		proto.SendQuit("bye"),
+		proto.SendKeyFrame(20),
+		proto.SendNewFrame(),
+		proto.SendKeyFrame(22),
+	};
+	CheckRoundTrip(packets, 5);
+
+	// keyframe numbers that do not advance by one per message start a new batch
+	packets = {
+		proto.SendKeyFrame(10),
+		proto.SendNewFrame(),
+		proto.SendKeyFrame(15),
+		proto.SendNewFrame(),
+	};
+	CheckRoundTrip(packets, 2);
+}
+
+TEST_CASE("FrameBatchMaxFrames")
+{
+	CBaseNetProtocol& proto = CBaseNetProtocol::Get();
+
+	std::deque<PacketPtr> packets;
+	std::deque<PacketPtr> coalesced;
+	std::vector<uint32_t> keyFrameIndices;
+
+	for (unsigned int i = 0; i < (UDPConnection::MAX_BATCH_FRAMES * 2 + 1); i++) {
+		packets.push_back(((i % 32) == 0)? proto.SendKeyFrame(i): proto.SendNewFrame());
+	}
+
+	// two full batches plus a lone trailing frame-message
+	coalesced = packets;
+	UDPConnection::CoalesceFrameMessages(coalesced, keyFrameIndices);
+
+	CHECK(coalesced.size() == 3);
+	CHECK(CountBatches(coalesced) == 2);
+	CHECK(SamePackets(packets, ExpandAll(coalesced)));
+
+	// one frame-message over the limit
+	packets.resize(UDPConnection::MAX_BATCH_FRAMES + 1);
+
+	coalesced = packets;
+	UDPConnection::CoalesceFrameMessages(coalesced, keyFrameIndices);
+
+	CHECK(coalesced.size() == 2);
+	CHECK(CountBatches(coalesced) == 1);
+	CHECK(SamePackets(packets, ExpandAll(coalesced)));
+
+	// a peer claiming more frames than a batch may hold
+	CheckInvalidBatch({0x80, 0x01, 0});
+	CheckInvalidBatch({0xFF, 0x7F, 0});
+}
+
+TEST_CASE("FrameBatchInvalid")
+{
+	std::vector<PacketPtr> expanded;
+	std::vector<uint32_t> keyFrameIndices;
+
+	// sanity check of the hand-built layout: 4 frames, keyframes 7 and 9 at 1 and 3
+	{
+		const std::vector<uint8_t> bytes = {NETMSG_FRAMEBATCH, 7, 4, 2, 7, 1, 2};
+
+		UDPConnection::ExpandFrameBatch(MakePacket(bytes), expanded, keyFrameIndices);
+
+		REQUIRE(expanded.size() == 4);
+		CHECK(expanded[0]->data[0] == NETMSG_NEWFRAME);
+		CHECK(expanded[1]->data[0] == NETMSG_KEYFRAME);
+		CHECK(expanded[2]->data[0] == NETMSG_NEWFRAME);
+		CHECK(expanded[3]->data[0] == NETMSG_KEYFRAME);
+
+		int32_t keyFrameNum = 0;
+		memcpy(&keyFrameNum, expanded[3]->data + 1, sizeof(keyFrameNum));
+		CHECK(keyFrameNum == 9);
+	}
+
+	// too few frames
+	CheckInvalidBatch({0, 0});
+	CheckInvalidBatch({1, 0});
+	// more keyframes than frames
+	CheckInvalidBatch({4, 5, 0, 0, 1, 1, 1, 1});
+	// repeated keyframe index
+	CheckInvalidBatch({4, 2, 7, 1, 0});
+	// keyframe index past the end of the batch
+	CheckInvalidBatch({4, 1, 7, 4});
+	CheckInvalidBatch({4, 2, 7, 1, 3});
+	// truncated before the keyframe indices
+	CheckInvalidBatch({4, 2, 7});
+	CheckInvalidBatch({4, 2});
+	// truncated varint
+	CheckInvalidBatch({0x84});
+}
@@ -26,6 +26,7 @@ no console output (you still could use this.exe > z.tzt though).
 
 	DEFINE_string(demofile,     "",    "Path to demo file");
 	DEFINE_bool  (dump,         false, "Only dump networc traffic saved in demo");
+	DEFINE_int32 (startframe,   0,     "Start dumping near this frame (.sdfb demos only)");
 	DEFINE_bool  (stats,        false, "Print all game, player and team stats");
 	DEFINE_bool  (header,       false, "Print demoheader content");
 	DEFINE_bool  (playerstats,  false, "Print playerstats");
@@ -34,7 +35,7 @@ no console output (you still could use this.exe > z.tzt though).
 	DEFINE_string(teamsstatcsv, "",    "Write teamstats in a csv file");
 
 
-void TrafficDump(CDemoReader& reader, bool trafficStats);
+void TrafficDump(CDemoReader& reader, bool trafficStats, int startFrame);
 void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string& file);
 
 int main (int argc, char* argv[])
@@ -56,7 +57,7 @@ int main (int argc, char* argv[])
 	reader.LoadStats();
 	if (FLAGS_dump)
 	{
-		TrafficDump(reader, true);
+		TrafficDump(reader, true, FLAGS_startframe);
 		return 0;
 	}
 	if (!FLAGS_teamsstatcsv.empty())
@@ -191,11 +192,19 @@ void PrintBinary(const unsigned char* const buf, int len)
 	std::cout << std::dec; //reset to decimal
 }
 
-void TrafficDump(CDemoReader& reader, bool trafficStats)
+void TrafficDump(CDemoReader& reader, bool trafficStats, int startFrame)
 {
 	InitCommandNames();
 	std::vector<unsigned> trafficCounter(NETMSG_LAST, 0);
 	int frame = -1;
+	if (startFrame > 0)
+	{
+		const int numFrames = reader.SeekToFrame(startFrame);
+		if (numFrames >= 0)
+			frame = numFrames - 1;
+		else
+			std::cout << "can not seek in this demo, dumping from the start" << std::endl;
+	}
 	int cmdId = 0;
 	while (!reader.ReachedEnd())
 	{
@@ -0,0 +1,466 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <gflags/gflags.h>
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Units/CommandAI/Command.h"
+#include "System/GlobalConfig.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Net/Socket.h"
+#include "System/Net/UDPConnection.h"
+#include "System/Net/UDPListener.h"
+#include "System/Net/UnpackPacket.h"
+
+/*
+Usage:
+netbench [options]
+
+Runs a server and a number of clients in one process, all talking over
+localhost through UDPConnection's exactly like spring(-dedicated) does:
+the server creates sim-frames at the given game speed and broadcasts them
+together with every command it receives, clients answer frames the way a
+game client does and send commands of their own. Each client can be put
+behind an emulated link that drops and delays datagrams.
+
+Nothing of CGameServer other than its traffic pattern is involved, which
+keeps this independent of game-data and fast enough to soak hundreds of
+clients; results (throughput, resend ratio, server time per client) are
+printed after the run.
+*/
+
+	DEFINE_int32 (clients,       16,    "Number of clients to connect");
+	DEFINE_int32 (duration,      30,    "Length of the measured run in seconds");
+	DEFINE_int32 (port,          18452, "Server port (bound on 127.0.0.1)");
+	DEFINE_double(gamespeed,     1.0,   "Game speed, the server creates 30*gamespeed frames per second");
+	DEFINE_double(commandrate,   2.0,   "Commands sent per client per second (each is relayed to all clients)");
+	DEFINE_int32 (commandparams, 4,     "Number of float parameters per command");
+	DEFINE_int32 (lossfactor,    0,     "UDPConnection loss factor used by server and clients (0-2)");
+	DEFINE_double(packetloss,    0.0,   "Percentage of datagrams dropped by the emulated link (each direction)");
+	DEFINE_int32 (latency,       0,     "One-way delay of the emulated link in milliseconds");
+	DEFINE_int32 (jitter,        0,     "Additional random one-way delay of up to this many milliseconds");
+	DEFINE_bool  (framebatching, false, "Coalesce frame messages into NETMSG_FRAMEBATCH's");
+	DEFINE_bool  (syncresponse,  true,  "Clients answer every frame with a NETMSG_SYNCRESPONSE");
+
+
+static constexpr int keyFrameInterval = 16; // same as CGameServer's
+
+
+// standalone; normally provided by GlobalConfig.cpp and errorhandler.cpp
+GlobalConfig globalConfig;
+
+void ErrorMessageBox(const std::string& msg, const std::string& caption, unsigned int flags, bool)
+{
+	std::fprintf(stderr, "%s: %s\n", caption.c_str(), msg.c_str());
+}
+
+
+
+// forwards datagrams between one client and the server, dropping and
+// delaying them on the way to emulate a bad connection
+class LinkEmulator
+{
+public:
+	LinkEmulator(const asio::ip::udp::endpoint& serverEndpoint, unsigned int seed)
+		: clientSocket(netcode::netservice, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0))
+		, serverSocket(netcode::netservice, asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), 0))
+		, serverAddr(serverEndpoint)
+		, rng(seed)
+	{
+		clientSocket.non_blocking(true);
+		serverSocket.non_blocking(true);
+	}
+
+	unsigned short GetPort() const { return clientSocket.local_endpoint().port(); }
+
+	void Update(spring_time curTime)
+	{
+		Receive(clientSocket, true, curTime);
+		Receive(serverSocket, false, curTime);
+
+		while (!delayed.empty() && delayed.begin()->first <= curTime) {
+			const DelayedPacket& p = delayed.begin()->second;
+			asio::error_code err;
+
+			if (p.toServer) {
+				serverSocket.send_to(asio::buffer(p.data), serverAddr, 0, err);
+			} else {
+				clientSocket.send_to(asio::buffer(p.data), clientAddr, 0, err);
+			}
+
+			delayed.erase(delayed.begin());
+		}
+	}
+
+private:
+	struct DelayedPacket {
+		bool toServer;
+		std::vector<std::uint8_t> data;
+	};
+
+	void Receive(asio::ip::udp::socket& socket, bool toServer, spring_time curTime)
+	{
+		std::uniform_real_distribution<float> lossDist(0.0f, 100.0f);
+		std::uniform_int_distribution<int> jitterDist(0, FLAGS_jitter);
+
+		size_t numBytes = 0;
+
+		while ((numBytes = socket.available()) > 0) {
+			DelayedPacket p = {toServer, std::vector<std::uint8_t>(numBytes)};
+
+			asio::ip::udp::endpoint sender;
+			asio::error_code err;
+
+			p.data.resize(socket.receive_from(asio::buffer(p.data), sender, 0, err));
+
+			if (err)
+				break;
+
+			// the client's address is only known after it sent something
+			if (toServer)
+				clientAddr = sender;
+
+			if (lossDist(rng) < FLAGS_packetloss)
+				continue;
+
+			delayed.emplace(curTime + spring_msecs(FLAGS_latency + jitterDist(rng)), std::move(p));
+		}
+	}
+
+private:
+	asio::ip::udp::socket clientSocket;
+	asio::ip::udp::socket serverSocket;
+
+	asio::ip::udp::endpoint clientAddr;
+	asio::ip::udp::endpoint serverAddr;
+
+	std::multimap<spring_time, DelayedPacket> delayed;
+	std::mt19937 rng;
+};
+
+
+
+struct BenchClient {
+	std::shared_ptr<netcode::UDPConnection> conn;
+	std::unique_ptr<LinkEmulator> link;
+
+	int playerNum = 0;
+	int frameNum = -1; // unknown until the first keyframe
+
+	unsigned int numFrames = 0;
+	unsigned int numFrameErrors = 0;
+	unsigned int numCommands = 0;
+
+	float sumCommandLatency = 0.0f; // ms, send to relayed back
+	float maxCommandLatency = 0.0f;
+
+	spring_time nextCommandTime;
+};
+
+struct BenchServer {
+	BenchServer(): listener(FLAGS_port, "127.0.0.1") {}
+
+	void Broadcast(const std::shared_ptr<const netcode::RawPacket>& packet) {
+		for (const auto& conn: conns) {
+			conn->SendData(packet);
+		}
+	}
+
+	netcode::UDPListener listener;
+	std::vector< std::shared_ptr<netcode::UDPConnection> > conns;
+
+	int frameNum = 0;
+
+	spring_time nextFrameTime;
+	spring_time updateTime; // accumulated over the measured run
+};
+
+struct BenchTotals {
+	unsigned int dataSent = 0;
+	unsigned int dataRecv = 0;
+	unsigned int sentPackets = 0;
+	unsigned int recvPackets = 0;
+	unsigned int createdChunks = 0;
+	unsigned int resentChunks = 0;
+
+	void Add(const netcode::UDPConnection& c) {
+		dataSent += c.GetDataSent();
+		dataRecv += c.GetDataReceived();
+		sentPackets += c.GetNumSentPackets();
+		recvPackets += c.GetNumRecvPackets();
+		createdChunks += c.GetNumCreatedChunks();
+		resentChunks += c.GetNumResentChunks();
+	}
+
+	BenchTotals operator - (const BenchTotals& t) const {
+		BenchTotals r;
+		r.dataSent = dataSent - t.dataSent;
+		r.dataRecv = dataRecv - t.dataRecv;
+		r.sentPackets = sentPackets - t.sentPackets;
+		r.recvPackets = recvPackets - t.recvPackets;
+		r.createdChunks = createdChunks - t.createdChunks;
+		r.resentChunks = resentChunks - t.resentChunks;
+		return r;
+	}
+};
+
+
+
+static void UpdateServer(BenchServer& server, bool createFrames)
+{
+	const spring_time t0 = spring_gettime();
+
+	server.listener.Update();
+
+	while (server.listener.HasIncomingConnections()) {
+		std::shared_ptr<netcode::UDPConnection> conn = server.listener.AcceptConnection();
+
+		conn->Unmute();
+		conn->SetLossFactor(FLAGS_lossfactor);
+		conn->SetFrameBatching(FLAGS_framebatching);
+		conn->SendData(CBaseNetProtocol::Get().SendSetPlayerNum(server.conns.size()));
+
+		server.conns.push_back(conn);
+	}
+
+	// relay commands like CGameServer does, everything else is just consumed
+	for (const auto& conn: server.conns) {
+		std::shared_ptr<const netcode::RawPacket> packet;
+
+		while ((packet = conn->GetData()) != nullptr) {
+			if (packet->data[0] == NETMSG_COMMAND)
+				server.Broadcast(packet);
+		}
+	}
+
+	if (createFrames) {
+		const spring_time frameTime = spring_msecs(1000.0f / (GAME_SPEED * FLAGS_gamespeed));
+
+		for (; server.nextFrameTime <= t0; server.nextFrameTime += frameTime) {
+			if ((++server.frameNum % keyFrameInterval) == 0) {
+				server.Broadcast(CBaseNetProtocol::Get().SendKeyFrame(server.frameNum));
+			} else {
+				server.Broadcast(CBaseNetProtocol::Get().SendNewFrame());
+			}
+		}
+	}
+
+	server.listener.FlushConnections();
+	server.updateTime += (spring_gettime() - t0);
+}
+
+static void UpdateClient(BenchClient& client, spring_time curTime, bool sendCommands)
+{
+	if (client.link != nullptr)
+		client.link->Update(curTime);
+
+	client.conn->Update();
+
+	std::shared_ptr<const netcode::RawPacket> packet;
+
+	while ((packet = client.conn->GetData()) != nullptr) {
+		switch (packet->data[0]) {
+			case NETMSG_SETPLAYERNUM: {
+				client.playerNum = packet->data[1];
+			} break;
+			case NETMSG_KEYFRAME: {
+				const int32_t frameNum = *reinterpret_cast<const int32_t*>(packet->data + 1);
+
+				client.numFrameErrors += (client.frameNum >= 0 && frameNum != (client.frameNum + 1));
+				client.frameNum = frameNum - 1;
+				client.conn->SendData(CBaseNetProtocol::Get().SendKeyFrame(frameNum));
+			} // fall-through
+			case NETMSG_NEWFRAME: {
+				client.numFrames += 1;
+
+				if (client.frameNum < 0)
+					break;
+
+				client.frameNum += 1;
+
+				if (FLAGS_syncresponse)
+					client.conn->SendData(CBaseNetProtocol::Get().SendSyncResponse(client.playerNum, client.frameNum, client.frameNum * 0x9E3779B9u));
+			} break;
+			case NETMSG_COMMAND: {
+				try {
+					netcode::UnpackPacket pckt(packet, 1 + sizeof(uint16_t) + sizeof(uint8_t) + sizeof(int32_t) * 2 + sizeof(uint8_t));
+					uint32_t numParams = 0;
+					float sendTime = 0.0f;
+
+					pckt >> numParams;
+
+					if (numParams == 0)
+						break;
+
+					pckt >> sendTime;
+
+					const float latency = curTime.toMilliSecsf() - sendTime;
+
+					client.sumCommandLatency += latency;
+					client.maxCommandLatency = std::max(client.maxCommandLatency, latency);
+					client.numCommands += 1;
+				} catch (const netcode::UnpackPacketException& ex) {
+					std::fprintf(stderr, "[%s] invalid command: %s\n", __func__, ex.what());
+				}
+			} break;
+			default: {
+			} break;
+		}
+	}
+
+	if (!sendCommands || FLAGS_commandrate <= 0.0)
+		return;
+
+	for (; client.nextCommandTime <= curTime; client.nextCommandTime += spring_msecs(1000.0f / FLAGS_commandrate)) {
+		std::vector<float> params(std::max(FLAGS_commandparams, 1), 0.0f);
+
+		// lets every receiver work out the relay latency
+		params[0] = curTime.toMilliSecsf();
+
+		client.conn->SendData(CBaseNetProtocol::Get().SendCommand(client.playerNum, CMD_MOVE, 0, 0, params.size(), params.data()));
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	gflags::SetUsageMessage(std::string("Usage: ") + argv[0] + " [options]");
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+	spring_clock::PushTickRate();
+	spring_time::setstarttime(spring_time::gettime(true));
+
+	const bool emulateLink = (FLAGS_packetloss > 0.0 || FLAGS_latency > 0 || FLAGS_jitter > 0);
+
+	BenchServer server;
+	std::vector<BenchClient> clients(std::max(FLAGS_clients, 1));
+
+	for (size_t i = 0; i < clients.size(); i++) {
+		BenchClient& c = clients[i];
+		unsigned short port = FLAGS_port;
+
+		if (emulateLink) {
+			c.link.reset(new LinkEmulator(asio::ip::udp::endpoint(asio::ip::address_v4::loopback(), FLAGS_port), i));
+			port = c.link->GetPort();
+		}
+
+		c.conn.reset(new netcode::UDPConnection(0, "127.0.0.1", port));
+		c.conn->Unmute();
+		c.conn->SetLossFactor(FLAGS_lossfactor);
+		c.conn->SetFrameBatchExpansion(FLAGS_framebatching);
+		c.conn->SendData(CBaseNetProtocol::Get().SendAttemptConnect("bench" + std::to_string(i), "", "netbench", "", FLAGS_lossfactor, false, FLAGS_framebatching));
+		c.conn->Flush(true);
+	}
+
+	// wait for every client to be accepted (and to know its player number)
+	for (const spring_time t = spring_gettime(); server.conns.size() < clients.size(); ) {
+		if ((spring_gettime() - t) > spring_secs(10)) {
+			std::fprintf(stderr, "only %u of %u clients connected\n", unsigned(server.conns.size()), unsigned(clients.size()));
+			return 1;
+		}
+
+		UpdateServer(server, false);
+
+		for (BenchClient& c: clients) {
+			UpdateClient(c, spring_gettime(), false);
+		}
+
+		spring_sleep(spring_msecs(1));
+	}
+
+	BenchTotals serverStart;
+	BenchTotals clientStart;
+
+	for (const auto& conn: server.conns) {
+		serverStart.Add(*conn);
+	}
+	for (const BenchClient& c: clients) {
+		clientStart.Add(*c.conn);
+	}
+
+	const spring_time startTime = spring_gettime();
+	const spring_time endTime = startTime + spring_secs(FLAGS_duration);
+
+	server.nextFrameTime = startTime;
+	server.updateTime = spring_notime;
+
+	for (BenchClient& c: clients) {
+		c.nextCommandTime = startTime + spring_msecs((1000.0f / std::max(FLAGS_commandrate, 0.001)) * (&c - &clients[0]) / clients.size());
+	}
+
+	for (spring_time curTime = startTime; curTime < endTime; curTime = spring_gettime()) {
+		UpdateServer(server, true);
+
+		for (BenchClient& c: clients) {
+			UpdateClient(c, curTime, true);
+		}
+
+		spring_sleep(spring_msecs(1));
+	}
+
+	BenchTotals serverTotals;
+	BenchTotals clientTotals;
+
+	for (const auto& conn: server.conns) {
+		serverTotals.Add(*conn);
+	}
+	for (const BenchClient& c: clients) {
+		clientTotals.Add(*c.conn);
+	}
+
+	serverTotals = serverTotals - serverStart;
+	clientTotals = clientTotals - clientStart;
+
+	const float runTime = (spring_gettime() - startTime).toSecsf();
+	const float numClients = clients.size();
+
+	unsigned int numFrames = 0;
+	unsigned int numFrameErrors = 0;
+	unsigned int numCommands = 0;
+
+	float sumCommandLatency = 0.0f;
+	float maxCommandLatency = 0.0f;
+
+	for (const BenchClient& c: clients) {
+		numFrames += c.numFrames;
+		numFrameErrors += c.numFrameErrors;
+		numCommands += c.numCommands;
+		sumCommandLatency += c.sumCommandLatency;
+		maxCommandLatency = std::max(maxCommandLatency, c.maxCommandLatency);
+	}
+
+	std::printf("[netbench] %d clients, %.1fs, gamespeed=%.2f commandrate=%.2f lossfactor=%d framebatching=%d\n", int(numClients), runTime, FLAGS_gamespeed, FLAGS_commandrate, FLAGS_lossfactor, FLAGS_framebatching);
+	std::printf("[netbench] link: packetloss=%.2f%% latency=%dms jitter=%dms\n", FLAGS_packetloss, FLAGS_latency, FLAGS_jitter);
+
+	const auto PrintTotals = [&](const char* name, const BenchTotals& t) {
+		std::printf("\t%-7s sent %9.1f packets/s %11.1f bytes/s | recv %9.1f packets/s %11.1f bytes/s | resent %u of %u chunks (%.2f%%)\n",
+			name,
+			t.sentPackets / runTime, t.dataSent / runTime,
+			t.recvPackets / runTime, t.dataRecv / runTime,
+			t.resentChunks, t.createdChunks, t.resentChunks * 100.0f / std::max(t.createdChunks, 1u)
+		);
+	};
+
+	PrintTotals("server", serverTotals);
+	PrintTotals("clients", clientTotals);
+
+	std::printf("\tserver update time %.3fms/s per client (%.2f%% of one core in total)\n",
+		server.updateTime.toMilliSecsf() / runTime / numClients,
+		server.updateTime.toMilliSecsf() * 0.1f / runTime
+	);
+	std::printf("\tframes: %d created, %.1f received per client, %u out of order\n",
+		server.frameNum, numFrames / numClients, numFrameErrors
+	);
+	std::printf("\tcommands: %.1f relayed per client, latency avg=%.2fms max=%.2fms\n",
+		numCommands / numClients, sumCommandLatency / std::max(numCommands, 1u), maxCommandLatency
+	);
+
+	return (numFrameErrors != 0);
+}